@@ -32,6 +32,9 @@ option(BUILD_USD_IMAGING_PLUGIN "Building the usd imaging plugin." OFF)
 option(BUILD_USD_MAYA_PLUGIN "Building the usd maya plugin." OFF)
 option(BUILD_USD_KATANA_PLUGIN "Building the usd katana plugin." OFF)
 option(BUILD_USD_HOUDINI_PLUGIN "Building the usd houdini plugin." OFF)
+option(BUILD_TRACE "Building usdAi and hdAi with trace markers." OFF)
+option(BUILD_ARNOLD_MOCK "Building the mock Arnold library for tests and benchmarks." OFF)
+option(BUILD_BENCHMARKS "Building the micro-benchmarks, requires Google Benchmark." OFF)
 # --
 
 option(PXR_SYMLINK_HEADER_FILES "Symlink the header files from, ie, pxr/base/lib/tf to CMAKE_DIR/pxr/base/tf, instead of copying; ensures that you may edit the header file in either location, and improves experience in IDEs which find normally the \"copied\" header, ie, CLion; has no effect on windows" OFF)
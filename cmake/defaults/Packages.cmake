@@ -31,7 +31,10 @@ set(build_shared_libs "${BUILD_SHARED_LIBS}")
 # ----------------------------------------------
 
 find_package(USD REQUIRED)
-find_package(Arnold REQUIRED)
+# The mock Arnold library stands in for the SDK.
+if (NOT BUILD_ARNOLD_MOCK)
+    find_package(Arnold REQUIRED)
+endif ()
 
 # USD Arnold HD Renderer Requirement
 # ----------------------------------------------
@@ -28,6 +28,7 @@
 #include <pxr/usd/usdAi/aiNodeAPI.h>
 #include <pxr/usd/usdAi/aiShader.h>
 #include <pxr/usd/usdAi/tokens.h>
+#include <pxr/usd/usdAi/utils.h>
 
 #include <ai.h>
 
@@ -220,28 +221,13 @@ exportNode(const UsdStagePtr& stage, const UsdStagePtr& descStage, const SdfPath
         return &it->second;
     };
 
-    auto isBlacklisted = [](const std::vector<UsdAttribute>& metas) -> bool {
-        for (const auto& meta: metas) {
-            const static TfToken blacklist("houdini.blacklist");
-            auto v = false;
-            if (UsdAiNodeAPI::GetMetadataNameFromAttr(meta) == blacklist
-                && meta.Get(&v) && v) {
-                return true;
-            }
-        }
-        return false;
+    auto isBlacklisted = [](const VtDictionary& metas) -> bool {
+        return VtDictionaryGet<bool>(
+            metas, "houdini.blacklist", VtDefault = false);
     };
 
-    auto isLinkable = [](const std::vector<UsdAttribute>& metas) -> bool {
-        for (const auto& meta: metas) {
-            const static TfToken linkable("linkable");
-            auto v = true;
-            if (UsdAiNodeAPI::GetMetadataNameFromAttr(meta) == linkable
-                && meta.Get(&v)) {
-                return v;
-            }
-        }
-        return true;
+    auto isLinkable = [](const VtDictionary& metas) -> bool {
+        return VtDictionaryGet<bool>(metas, "linkable", VtDefault = true);
     };
 
     static const TfToken positionToken("position");
@@ -305,7 +291,7 @@ exportNode(const UsdStagePtr& stage, const UsdStagePtr& descStage, const SdfPath
         if (parm == nullptr) { continue; }
         auto paramDesc = getParamDesc(parm->getToken());
         if (!paramDesc.IsValid()) { continue; }
-        auto metadatas = descAPI.GetMetadataForAttribute(paramDesc);
+        auto metadatas = descAPI.GetMetadataValuesForAttribute(paramDesc);
         if (isBlacklisted(metadatas)) { continue; }
 
         const auto paramIdx = vop->getInputFromName(parm->getToken());
@@ -385,32 +371,20 @@ findFirstChildrenOfType(OP_Node* op, const char* type) {
     return nullptr;
 }
 
-// We need the description of all the arnold parameters. We want to avoid
-// issues with the arnold universe and multiple threads accessing / creating
-// Arnold universes so we cache the description of the shaders into a simplified
-// USD tree.
+// We need the description of all the arnold parameters. When HtoA has an
+// active Arnold session, the description is authored in-process from it,
+// using the plugins and metadata HtoA loaded, otherwise usdAi runs
+// usdAiShaderInfo to avoid issues with multiple threads accessing / creating
+// Arnold universes, and caches the result on disk.
 UsdStageRefPtr getArnoldShaderDesc() {
     static UsdStageRefPtr shaderDescCache = nullptr;
     if (shaderDescCache == nullptr) {
-        std::stringstream command; command << "usdAiShaderInfo --cout";
+        std::string flags;
         auto* HTOA_PATH = getenv("HTOA_PATH");
         if (HTOA_PATH != nullptr) {
-             command << " --meta " << HTOA_PATH << "/arnold/metadata";
-        }
-        FILE* pipe = popen(command.str().c_str(), "r");
-        if (pipe != nullptr) {
-            // TODO: optimize!
-            std::stringstream result;
-            std::array<char, 128> buffer;
-            while (!feof(pipe)) {
-                if (fgets(buffer.data(), buffer.size(), pipe) != nullptr) {
-                    result << buffer.data();
-                }
-            }
-            pclose(pipe);
-            shaderDescCache = UsdStage::CreateInMemory(".usda");
-            shaderDescCache->GetRootLayer()->ImportFromString(result.str());
+            flags = std::string("--meta ") + HTOA_PATH + "/arnold/metadata";
         }
+        shaderDescCache = UsdAiGetArnoldShaderDesc(flags);
     }
     return shaderDescCache;
 }
@@ -17,6 +17,9 @@
 #include <usdKatana/readPrim.h>
 #include <usdKatana/readXformable.h>
 
+#include <pxr/usd/usdAi/aiMaterialAPI.h>
+#include <pxr/usd/usdShade/materialBindingAPI.h>
+#include <pxr/usd/usdShade/shader.h>
 #include <pxr/usd/usdVol/openVDBAsset.h>
 #include <pxr/usd/usdVol/volume.h>
 
@@ -24,8 +27,95 @@
 
 #include <FnAttribute/FnDataBuilder.h>
 
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
 PXR_NAMESPACE_OPEN_SCOPE
 
+namespace {
+
+struct GridParam {
+    TfToken name;
+    std::string defaultValue;
+};
+
+using GridParams = std::vector<GridParam>;
+
+// Parameters of the built-in volume shaders, naming the grids they sample,
+// with their default values in Arnold.
+const GridParams* getGridParams(const TfToken& shaderId) {
+    static const std::unordered_map<TfToken, GridParams, TfToken::HashFunctor>
+        gridParams{
+            {TfToken("standard_volume"),
+             {{TfToken("density_channel"), "density"},
+              {TfToken("scatter_color_channel"), ""},
+              {TfToken("transparent_channel"), ""},
+              {TfToken("emission_channel"), "heat"},
+              {TfToken("temperature_channel"), "temperature"}}},
+            {TfToken("volume_sample_float"), {{TfToken("channel"), ""}}},
+            {TfToken("volume_sample_rgb"), {{TfToken("channel"), ""}}},
+        };
+    const auto* id = shaderId.GetText();
+    const auto it = gridParams.find(
+        strncmp(id, "ai:", 3) == 0 ? TfToken(id + 3) : shaderId);
+    return it == gridParams.end() ? nullptr : &it->second;
+}
+
+// Collects the grids sampled by the volume shader network bound to the
+// prim. Returns false if the grids can't be determined.
+bool getVolumeGrids(
+    const UsdPrim& prim, std::unordered_set<std::string>& grids) {
+    const auto material =
+        UsdShadeMaterialBindingAPI(prim).ComputeBoundMaterial();
+    if (!material) { return false; }
+    const UsdAiMaterialAPI aiMaterial(material.GetPrim());
+    SdfPathVector targets;
+    aiMaterial.GetVolumeRel().GetTargets(&targets);
+    if (targets.empty()) { aiMaterial.GetSurfaceRel().GetTargets(&targets); }
+    const auto stage = prim.GetStage();
+    std::unordered_set<SdfPath, SdfPath::Hash> visited;
+    auto hasGridParams = false;
+    while (!targets.empty()) {
+        const auto path = targets.back().GetPrimPath();
+        targets.pop_back();
+        if (!visited.insert(path).second) { continue; }
+        const UsdShadeShader shader(stage->GetPrimAtPath(path));
+        if (!shader) { continue; }
+        for (const auto& input : shader.GetInputs()) {
+            SdfPathVector sources;
+            if (input.GetRawConnectedSourcePaths(&sources)) {
+                targets.insert(targets.end(), sources.begin(), sources.end());
+            }
+        }
+        TfToken shaderId;
+        if (!shader.GetIdAttr().Get(&shaderId)) { continue; }
+        const auto* params = getGridParams(shaderId);
+        if (params == nullptr) { continue; }
+        hasGridParams = true;
+        for (const auto& param : *params) {
+            auto grid = param.defaultValue;
+            const auto input = shader.GetInput(param.name);
+            if (input) {
+                // We can't tell which grids a connected parameter samples.
+                if (input.HasConnectedSource()) { return false; }
+                VtValue value;
+                if (input.Get(&value)) {
+                    if (value.IsHolding<std::string>()) {
+                        grid = value.UncheckedGet<std::string>();
+                    } else if (value.IsHolding<TfToken>()) {
+                        grid = value.UncheckedGet<TfToken>().GetString();
+                    }
+                }
+            }
+            if (!grid.empty()) { grids.insert(grid); }
+        }
+    }
+    return hasGridParams;
+}
+
+} // namespace
+
 void readUSDVolVolume(
     FnKat::GeolibCookInterface& interface, FnKat::GroupAttribute opArgs,
     const PxrUsdKatanaUsdInPrivateData& privateData) {
@@ -103,8 +193,20 @@ void readUSDVolVolume(
     getArnoldVDBVolumeOpArgs(prim, argsBuilder);
     argsBuilder.set("filename", FnKat::StringAttribute(*vdbPaths.begin()));
 
-    // TODO: We should not send all the grids to Arnold.
-    // Ideally Ktoa should pick only the grids uses by shaders.
+    // Only sending the grids sampled by the shaders to Arnold, if we can
+    // tell which ones those are.
+    std::unordered_set<std::string> grids;
+    if (getVolumeGrids(prim, grids)) {
+        std::vector<std::string> usedFieldNames;
+        for (const auto& fieldName : vdbFieldNames) {
+            if (grids.find(fieldName) != grids.end()) {
+                usedFieldNames.push_back(fieldName);
+            }
+        }
+        if (!usedFieldNames.empty()) {
+            vdbFieldNames = std::move(usedFieldNames);
+        }
+    }
     argsBuilder.set("grids", FnAttribute::StringAttribute(vdbFieldNames));
 
     FnKat::GroupAttribute xform;
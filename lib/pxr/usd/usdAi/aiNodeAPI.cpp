@@ -157,11 +157,154 @@ PXR_NAMESPACE_CLOSE_SCOPE
 
 #include "pxr/usd/usdAi/aiShaderExport.h"
 #include "pxr/usd/usdAi/tokens.h"
+#include "pxr/usd/usd/notice.h"
+#include "pxr/base/tf/weakBase.h"
 #include <ai.h>
 #include <initializer_list>
+#include <mutex>
+#include <unordered_map>
 
 PXR_NAMESPACE_OPEN_SCOPE
 
+namespace {
+
+// Maps every namespace prefix of the attributes of a prim to the attributes
+// in it, so "a:b:c" is listed under both "a" and "a:b". Metadata and user
+// attributes are looked up by their prefix, instead of scanning every
+// attribute of the prim with string comparisons on each call.
+using _NamespaceIndex =
+    std::unordered_map<TfToken, TfTokenVector, TfToken::HashFunctor>;
+
+class _NamespaceIndexCache : public TfWeakBase {
+public:
+    _NamespaceIndexCache() {
+        TfNotice::Register(
+            TfCreateWeakPtr(this), &_NamespaceIndexCache::_OnObjectsChanged);
+    }
+
+    std::vector<UsdAttribute> GetAttributes(
+        const UsdPrim& prim, const TfToken& prefix) {
+        if (!prim) { return {}; }
+        const auto stage = prim.GetStage();
+        const auto& path = prim.GetPath();
+        TfTokenVector names;
+        size_t generation = 0;
+        auto found = false;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto& stageEntry = _GetStageEntry(stage);
+            generation = stageEntry.generation;
+            const auto it = stageEntry.prims.find(path);
+            if (it != stageEntry.prims.end()) {
+                found = true;
+                names = _Lookup(it->second, prefix);
+            }
+        }
+        if (!found) {
+            // Querying the attributes is slow, so the index is built
+            // without blocking the other threads.
+            auto index = _BuildIndex(prim);
+            names = _Lookup(index, prefix);
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto& stageEntry = _GetStageEntry(stage);
+            // The prim might have been resynced while building the index.
+            if (stageEntry.generation == generation) {
+                stageEntry.prims.emplace(path, std::move(index));
+            }
+        }
+        std::vector<UsdAttribute> result;
+        result.reserve(names.size());
+        for (const auto& name : names) {
+            result.push_back(prim.GetAttribute(name));
+        }
+        return result;
+    }
+
+private:
+    struct _StageEntry {
+        UsdStageWeakPtr stage;
+        std::unordered_map<SdfPath, _NamespaceIndex, SdfPath::Hash> prims;
+        /// Incremented when prims are removed from the cache.
+        size_t generation = 0;
+    };
+
+    static TfTokenVector _Lookup(
+        const _NamespaceIndex& index, const TfToken& prefix) {
+        const auto it = index.find(prefix);
+        return it == index.end() ? TfTokenVector() : it->second;
+    }
+
+    static _NamespaceIndex _BuildIndex(const UsdPrim& prim) {
+        _NamespaceIndex index;
+        for (const auto& attr : prim.GetAttributes()) {
+            const auto& name = attr.GetName();
+            const auto& nameStr = name.GetString();
+            for (auto pos = nameStr.find(':'); pos != std::string::npos;
+                 pos = nameStr.find(':', pos + 1)) {
+                index[TfToken(nameStr.substr(0, pos))].push_back(name);
+            }
+        }
+        return index;
+    }
+
+    // Expects the mutex to be locked.
+    _StageEntry& _GetStageEntry(const UsdStageWeakPtr& stage) {
+        auto it = _stages.find(get_pointer(stage));
+        if (it == _stages.end()) {
+            // Stages are not reporting when they are destroyed, so expired
+            // ones are removed when a new stage is seen.
+            for (auto expired = _stages.begin(); expired != _stages.end();) {
+                if (expired->second.stage) {
+                    ++expired;
+                } else {
+                    expired = _stages.erase(expired);
+                }
+            }
+            it = _stages.emplace(get_pointer(stage), _StageEntry()).first;
+        }
+        auto& stageEntry = it->second;
+        // A new stage might be allocated at the address of an expired one.
+        if (!stageEntry.stage) {
+            stageEntry.stage = stage;
+            stageEntry.prims.clear();
+            ++stageEntry.generation;
+        }
+        return stageEntry;
+    }
+
+    // Only resyncs can add or remove attributes, and they are reported on
+    // the property path or on an ancestor prim.
+    void _OnObjectsChanged(const UsdNotice::ObjectsChanged& notice) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const auto stageIt = _stages.find(get_pointer(notice.GetStage()));
+        if (stageIt == _stages.end()) { return; }
+        auto& prims = stageIt->second.prims;
+        const auto resyncedPaths = notice.GetResyncedPaths();
+        if (resyncedPaths.empty()) { return; }
+        ++stageIt->second.generation;
+        for (const auto& path : resyncedPaths) {
+            const auto primPath = path.GetPrimPath();
+            for (auto it = prims.begin(); it != prims.end();) {
+                if (it->first.HasPrefix(primPath)) {
+                    it = prims.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+    }
+
+    std::mutex _mutex;
+    std::unordered_map<const UsdStage*, _StageEntry> _stages;
+};
+
+_NamespaceIndexCache& _GetNamespaceIndexCache() {
+    static _NamespaceIndexCache cache;
+    return cache;
+}
+
+} // namespace
+
 UsdAttribute
 UsdAiNodeAPI::CreateUserAttribute(const TfToken &name,
                                   const SdfValueTypeName& typeName) const
@@ -181,15 +324,9 @@ UsdAiNodeAPI::GetUserAttribute(const TfToken &name) const
 std::vector<UsdAttribute>
 UsdAiNodeAPI::GetUserAttributes() const
 {
-    std::vector<UsdAttribute> result;
-
-    for (const auto& it: GetPrim().GetAttributes()) {
-        if (TfStringStartsWith(it.GetName().GetString(),
-                               UsdAiTokens->userPrefix)) {
-            result.push_back(it);
-        }
-    }
-    return result;
+    static const auto userNamespace = TfToken(TfStringTrimRight(
+        UsdAiTokens->userPrefix.GetString(), ":"));
+    return _GetNamespaceIndexCache().GetAttributes(GetPrim(), userNamespace);
 }
 
 void
@@ -218,6 +355,36 @@ UsdAiNodeAPI::AddMetadataToAttribute(
     return metaAttr;
 }
 
+void
+UsdAiNodeAPI::SetMetadataOnAttribute(
+    const UsdAttribute& attr,
+    const TfToken& name,
+    const VtValue& value) const {
+    attr.SetCustomDataByKey(
+        TfToken(UsdAiTokens->arnoldMetadata.GetString() + ":" + name.GetString()),
+        value);
+}
+
+VtDictionary
+UsdAiNodeAPI::GetMetadataValuesForAttribute(const UsdAttribute& attr) const {
+    VtDictionary result;
+    const auto prefixLength = attr.GetName().GetString().size() + 1;
+    for (const auto& metaAttr: GetMetadataForAttribute(attr)) {
+        VtValue value;
+        if (!metaAttr.Get(&value)) { continue; }
+        auto name = metaAttr.GetName().GetString().substr(prefixLength);
+        std::replace(name.begin(), name.end(), ':', '.');
+        result[name] = value;
+    }
+    const auto customData = attr.GetCustomDataByKey(UsdAiTokens->arnoldMetadata);
+    if (customData.IsHolding<VtDictionary>()) {
+        for (const auto& it: customData.UncheckedGet<VtDictionary>()) {
+            result[it.first] = it.second;
+        }
+    }
+    return result;
+}
+
 TfToken
 UsdAiNodeAPI::GetMetadataNameFromAttr(const UsdAttribute& attr) {
     auto name = attr.GetName().GetString();
@@ -230,14 +397,7 @@ UsdAiNodeAPI::GetMetadataNameFromAttr(const UsdAttribute& attr) {
 
 std::vector<UsdAttribute>
 UsdAiNodeAPI::GetMetadataForAttribute(const UsdAttribute& attr) const {
-    const auto attrName = attr.GetName();
-    std::vector<UsdAttribute> result;
-    for (const auto& it: GetPrim().GetAttributes()) {
-        if (TfStringStartsWith(it.GetName(), TfToken(attrName.GetString() + ":"))) {
-            result.push_back(it);
-        }
-    }
-    return result;
+    return _GetNamespaceIndexCache().GetAttributes(GetPrim(), attr.GetName());
 }
 
 namespace {
@@ -213,6 +213,18 @@ public:
         const SdfValueTypeName& typeName,
         const VtValue& value) const;
 
+    // Adding metadata to an attribute, stored in its customData instead
+    // of a separate attribute. This is the compact alternative to
+    // AddMetadataToAttribute.
+    void SetMetadataOnAttribute(
+        const UsdAttribute& attr,
+        const TfToken& name,
+        const VtValue& value) const;
+
+    // Return the values of all metadata of an attribute by name, reading
+    // both the customData and the separate attribute encodings.
+    VtDictionary GetMetadataValuesForAttribute(const UsdAttribute& attr) const;
+
     // Getting the metadata name from the parameter name.
     static TfToken GetMetadataNameFromAttr(const UsdAttribute& attr);
 
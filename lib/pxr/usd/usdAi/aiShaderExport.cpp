@@ -19,6 +19,7 @@
 #include "pxr/usd/usd/relationship.h"
 #include "pxr/usd/usdAi/aiMaterialAPI.h"
 #include "pxr/usd/usdAi/aiNodeAPI.h"
+#include "pxr/usd/usdAi/trace.h"
 #include "pxr/usd/usdGeom/scope.h"
 #include "pxr/usd/usdGeom/xform.h"
 #include "pxr/usd/usdShade/connectableAPI.h"
@@ -617,6 +618,7 @@ void AiShaderExport::export_parameter(
 SdfPath AiShaderExport::export_arnold_node(
     const AtNode* arnold_node, const SdfPath& parent_path,
     const std::set<std::string>* exportable_params) {
+    USDAI_TRACE_FUNCTION();
     if (arnold_node == nullptr) {
         TF_WARN("Arnold node is zero.");
         return SdfPath();
@@ -108,3 +108,46 @@ TEST(USDAiNodeAPI, ListAttributes) {
 
     VALIDATE_PARAMETERS();
 }
+
+TEST(USDAiNodeAPI, ListMetadata) {
+    SETUP_API();
+
+    SETUP_PARAMETERS();
+
+    const auto param = something.GetPrim().CreateAttribute(
+        TfToken("param"), SdfValueTypeNames->Float);
+    EXPECT_TRUE(nodeAPI.GetMetadataForAttribute(param).empty());
+
+    nodeAPI.AddMetadataToAttribute(
+        param, TfToken("min"), SdfValueTypeNames->Float, VtValue(0.0f));
+    nodeAPI.AddMetadataToAttribute(
+        param, TfToken("soft.max"), SdfValueTypeNames->Float, VtValue(1.0f));
+    // The lookup is cached, so it has to pick up the new attributes.
+    const auto metadata = nodeAPI.GetMetadataForAttribute(param);
+    ASSERT_EQ(metadata.size(), 2);
+    EXPECT_EQ(UsdAiNodeAPI::GetMetadataNameFromAttr(metadata[0]), "min");
+    EXPECT_EQ(UsdAiNodeAPI::GetMetadataNameFromAttr(metadata[1]), "soft.max");
+    EXPECT_EQ(nodeAPI.GetUserAttributes().size(), 3);
+
+    something.GetPrim().RemoveProperty(metadata[0].GetName());
+    EXPECT_EQ(nodeAPI.GetMetadataForAttribute(param).size(), 1);
+}
+
+TEST(USDAiNodeAPI, MetadataValues) {
+    SETUP_API();
+
+    const auto param = something.GetPrim().CreateAttribute(
+        TfToken("param"), SdfValueTypeNames->Float);
+    EXPECT_TRUE(nodeAPI.GetMetadataValuesForAttribute(param).empty());
+
+    nodeAPI.AddMetadataToAttribute(
+        param, TfToken("soft.max"), SdfValueTypeNames->Float, VtValue(1.0f));
+    nodeAPI.SetMetadataOnAttribute(param, TfToken("linkable"), VtValue(false));
+    // Both encodings are read, without listing the compact metadata as
+    // attributes.
+    const auto values = nodeAPI.GetMetadataValuesForAttribute(param);
+    EXPECT_EQ(values.size(), 2);
+    EXPECT_EQ(VtDictionaryGet<float>(values, "soft.max"), 1.0f);
+    EXPECT_EQ(VtDictionaryGet<bool>(values, "linkable"), false);
+    EXPECT_EQ(nodeAPI.GetMetadataForAttribute(param).size(), 1);
+}
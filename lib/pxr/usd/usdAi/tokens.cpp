@@ -84,6 +84,7 @@ UsdAiTokensType::UsdAiTokensType() :
     aiVisibilityVolume("ai:visibility:volume", TfToken::Immortal),
     aiVolume("ai:volume", TfToken::Immortal),
     aiVolume_padding("ai:volume_padding", TfToken::Immortal),
+    arnoldMetadata("arnoldMetadata", TfToken::Immortal),
     aRRAY("ARRAY", TfToken::Immortal),
     auto_("auto_", TfToken::Immortal),
     bOOL("BOOL", TfToken::Immortal),
@@ -93,6 +94,7 @@ UsdAiTokensType::UsdAiTokensType() :
     driver("driver", TfToken::Immortal),
     edge_length("edge_length", TfToken::Immortal),
     elemType("elemType", TfToken::Immortal),
+    enumValues("enumValues", TfToken::Immortal),
     filename("filename", TfToken::Immortal),
     filepath("filepath", TfToken::Immortal),
     filter("filter", TfToken::Immortal),
@@ -108,6 +110,7 @@ UsdAiTokensType::UsdAiTokensType() :
     nodeType("nodeType", TfToken::Immortal),
     none("none", TfToken::Immortal),
     object("object", TfToken::Immortal),
+    outputType("outputType", TfToken::Immortal),
     paramType("paramType", TfToken::Immortal),
     path("path", TfToken::Immortal),
     pin_borders("pin_borders", TfToken::Immortal),
@@ -184,6 +187,7 @@ UsdAiTokensType::UsdAiTokensType() :
         aiVisibilityVolume,
         aiVolume,
         aiVolume_padding,
+        arnoldMetadata,
         aRRAY,
         auto_,
         bOOL,
@@ -193,6 +197,7 @@ UsdAiTokensType::UsdAiTokensType() :
         driver,
         edge_length,
         elemType,
+        enumValues,
         filename,
         filepath,
         filter,
@@ -208,6 +213,7 @@ UsdAiTokensType::UsdAiTokensType() :
         nodeType,
         none,
         object,
+        outputType,
         paramType,
         path,
         pin_borders,
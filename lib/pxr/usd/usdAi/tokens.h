@@ -294,6 +294,10 @@ struct UsdAiTokensType {
     /// 
     /// UsdAiVolumeAPI
     const TfToken aiVolume_padding;
+    /// \brief "arnoldMetadata"
+    /// 
+    /// Stores the arnold metadata of a node or a parameter in its customData.
+    const TfToken arnoldMetadata;
     /// \brief "ARRAY"
     /// 
     /// Possible value for UsdAiAOV::GetDataTypeAttr()
@@ -330,6 +334,10 @@ struct UsdAiTokensType {
     /// 
     /// Stores the arnold parameter type for an array.
     const TfToken elemType;
+    /// \brief "enumValues"
+    /// 
+    /// Stores the possible values of an enum parameter.
+    const TfToken enumValues;
     /// \brief "filename"
     /// 
     /// Stores the file the plugin was loaded from., UsdAiVolume
@@ -390,6 +398,10 @@ struct UsdAiTokensType {
     /// 
     /// Possible value for UsdAiShapeAPI::GetAiSubdiv_adaptive_spaceAttr()
     const TfToken object;
+    /// \brief "outputType"
+    /// 
+    /// Stores the arnold output type of a node.
+    const TfToken outputType;
     /// \brief "paramType"
     /// 
     /// Stores the arnold parameter type for a parameter.
@@ -0,0 +1,42 @@
+// Copyright 2019 Luma Pictures
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/// @file trace.h
+///
+/// Scoped trace markers for the hot paths of usdAi and hdAi.
+///
+/// The markers record to the global TraceCollector of USD, so they show up
+/// in any trace captured by the host (ie. usdview's trace menu or
+/// PXR_ENABLE_GLOBAL_TRACE), and hdAi writes them to a Chrome trace file when
+/// HDAI_trace_file is set. They are only compiled in when the project is
+/// configured with BUILD_TRACE, otherwise they expand to nothing.
+#ifndef USDAI_TRACE_H
+#define USDAI_TRACE_H
+
+#ifdef USDAI_ENABLE_TRACE
+
+#include <pxr/base/trace/trace.h>
+
+/// Records the time spent in the enclosing function.
+#define USDAI_TRACE_FUNCTION() TRACE_FUNCTION()
+/// Records the time spent in the enclosing scope, under @p name.
+#define USDAI_TRACE_SCOPE(name) TRACE_SCOPE(name)
+
+#else
+
+#define USDAI_TRACE_FUNCTION()
+#define USDAI_TRACE_SCOPE(name)
+
+#endif
+
+#endif // USDAI_TRACE_H
@@ -13,29 +13,485 @@
 // limitations under the License.
 #include "pxr/usd/usdAi/utils.h"
 
+#include "pxr/usd/usdAi/aiNodeAPI.h"
+#include "pxr/usd/usdAi/aiShaderExport.h"
+#include "pxr/usd/usdAi/tokens.h"
+
+#include <pxr/base/arch/fileSystem.h>
+#include <pxr/base/arch/hash.h>
+#include <pxr/base/tf/envSetting.h>
+#include <pxr/base/tf/fileUtils.h>
+#include <pxr/base/tf/getenv.h>
+#include <pxr/base/tf/stringUtils.h>
+#include <pxr/base/work/loops.h>
+#include <pxr/usd/sdf/attributeSpec.h>
+#include <pxr/usd/sdf/changeBlock.h>
+#include <pxr/usd/sdf/primSpec.h>
+#include <pxr/usd/usdShade/tokens.h>
+
+#include <ai.h>
+
+#include <algorithm>
 #include <array>
+#include <cinttypes>
+#include <cstdio>
+#include <sstream>
+
+#include <unistd.h>
 
 PXR_NAMESPACE_OPEN_SCOPE
 
-UsdStageRefPtr UsdAiGetArnoldShaderDesc(const std::string& additionalFlags) {
-    UsdStageRefPtr ret = nullptr;
+TF_DEFINE_ENV_SETTING(
+    USDAI_SHADER_DESC_CACHE, true,
+    "Cache the Arnold shader description on disk.");
+
+TF_DEFINE_ENV_SETTING(
+    USDAI_SHADER_DESC_CACHE_DIR, "",
+    "Directory of the shader description cache, defaults to "
+    "$XDG_CACHE_HOME/usdAi or $HOME/.cache/usdAi.");
+
+namespace {
+
+const std::string cacheKeyName("usdAi:shaderDescCacheKey");
+
+std::string getCacheDir() {
+    const auto dir = TfGetEnvSetting(USDAI_SHADER_DESC_CACHE_DIR);
+    if (!dir.empty()) { return dir; }
+    const auto xdgCacheHome = TfGetenv("XDG_CACHE_HOME");
+    if (!xdgCacheHome.empty()) { return xdgCacheHome + "/usdAi"; }
+    const auto home = TfGetenv("HOME");
+    if (!home.empty()) { return home + "/.cache/usdAi"; }
+    return {};
+}
+
+void appendFileStamp(const std::string& path, std::string& key) {
+    double mtime = 0.0;
+    ArchGetModificationTime(path.c_str(), &mtime);
+    key += path;
+    key += ':';
+    key += TfStringify(mtime);
+    key += ':';
+    key += TfStringify(ArchGetFileLength(path.c_str()));
+    key += '\n';
+}
+
+// Plugin and metadata directories are not searched recursively by Arnold,
+// so the stamps of the directory and its direct children are enough
+// to catch added, removed or rebuilt plugins.
+void appendPathStamp(const std::string& path, std::string& key) {
+    if (TfIsDir(path)) {
+        appendFileStamp(path, key);
+        auto files = TfListDir(path);
+        std::sort(files.begin(), files.end());
+        for (const auto& file : files) {
+            if (TfIsFile(file)) { appendFileStamp(file, key); }
+        }
+    } else if (TfIsFile(path)) {
+        appendFileStamp(path, key);
+    }
+}
+
+// The key holds everything that affects the output of usdAiShaderInfo:
+// the Arnold version, the plugin search path, the extra flags and the
+// stamps of every plugin and metadata file involved.
+std::string getCacheKey(const std::string& additionalFlags) {
+    std::string key = "format:" + TfStringify(UsdAiShaderDescVersion) + "\n";
+    key += "arnold:";
+    key += AiGetVersion(nullptr, nullptr, nullptr, nullptr);
+    key += "\nflags:" + additionalFlags + "\n";
+    const auto pluginPath = TfGetenv("ARNOLD_PLUGIN_PATH");
+    key += "pluginPath:" + pluginPath + "\n";
+    for (const auto& path : TfStringSplit(pluginPath, ARCH_PATH_LIST_SEP)) {
+        appendPathStamp(path, key);
+    }
+    for (const auto& token : TfStringTokenize(additionalFlags)) {
+        if (!TfStringStartsWith(token, "-")) { appendPathStamp(token, key); }
+    }
+    return key;
+}
+
+std::string getCachePath(const std::string& cacheDir, const std::string& key) {
+    // boost::hash and std::hash are not guaranteed to be the same across
+    // builds, which would silently miss the cache.
+    std::array<char, 32> hash = {0};
+    snprintf(
+        hash.data(), hash.size(), "%016" PRIx64,
+        ArchHash64(key.c_str(), key.size()));
+    return cacheDir + "/shaderDesc_" + hash.data() + ".usdc";
+}
+
+UsdStageRefPtr readCache(const std::string& cachePath, const std::string& key) {
+    if (!TfIsFile(cachePath)) { return nullptr; }
+    auto layer = SdfLayer::OpenAsAnonymous(cachePath);
+    if (!layer) { return nullptr; }
+    // The file name only carries a hash of the key, so we compare the full
+    // key to rule out collisions.
+    const auto customData = layer->GetCustomLayerData();
+    const auto it = customData.find(cacheKeyName);
+    if (it == customData.end() || !it->second.IsHolding<std::string>() ||
+        it->second.UncheckedGet<std::string>() != key) {
+        return nullptr;
+    }
+    return UsdStage::Open(layer);
+}
+
+// The layer is exported to a temporary file first and renamed into place,
+// so concurrent processes never see a partially written cache and readers
+// of the previous file keep their mapping.
+void writeCache(
+    const SdfLayerHandle& layer, const std::string& cacheDir,
+    const std::string& cachePath, const std::string& key) {
+    if (!TfIsDir(cacheDir) && !TfMakeDirs(cacheDir)) { return; }
+    auto customData = layer->GetCustomLayerData();
+    customData[cacheKeyName] = VtValue(key);
+    layer->SetCustomLayerData(customData);
+    const auto tmpPath = TfStringGetBeforeSuffix(cachePath) + "." +
+                         TfStringify(getpid()) + ".usdc";
+    if (!layer->Export(tmpPath)) { return; }
+    if (rename(tmpPath.c_str(), cachePath.c_str()) != 0) {
+        TfDeleteFile(tmpPath);
+    }
+}
+
+struct MetadataDesc {
+    std::string name;
+    SdfValueTypeName typeName;
+    VtValue value;
+    TfToken paramType;
+};
+
+// Description of a single attribute, gathered from a node entry before
+// authoring it to the layer.
+struct AttributeDesc {
+    TfToken name;
+    SdfValueTypeName typeName;
+    SdfVariability variability = SdfVariabilityVarying;
+    VtValue value;
+    TfToken paramType;
+    TfToken elemType;
+    VtTokenArray enumValues;
+    std::vector<MetadataDesc> metadata;
+};
+
+struct NodeEntryDesc {
+    TfToken name;
+    TfToken filename;
+    TfToken nodeEntryType;
+    TfToken outputType;
+    // Metadata of the node itself, not attached to any parameter.
+    VtDictionary metadata;
+    std::vector<AttributeDesc> attributes;
+};
+
+std::vector<MetadataDesc> describeMetadata(
+    const AtNodeEntry* nentry, const AtString& paramName) {
+    std::vector<MetadataDesc> metadata;
+    auto* metaIter = AiNodeEntryGetMetaDataIterator(nentry, paramName);
+
+    while (!AiMetaDataIteratorFinished(metaIter)) {
+        const auto* meta = AiMetaDataIteratorGetNext(metaIter);
+        const auto* conversion =
+            AiShaderExport::get_default_value_conversion(meta->type);
+        if (conversion == nullptr) { continue; }
+        MetadataDesc desc;
+        desc.name = meta->name.c_str();
+        desc.typeName = conversion->type;
+        if (conversion->f != nullptr) {
+            desc.value = conversion->f(meta->value, nullptr);
+        }
+        desc.paramType = UsdAiNodeAPI::GetParamTypeTokenFromType(meta->type);
+        metadata.push_back(std::move(desc));
+    }
+
+    AiMetaDataIteratorDestroy(metaIter);
+    return metadata;
+}
+
+VtDictionary describeNodeMetadata(const AtNodeEntry* nentry) {
+    VtDictionary metadata;
+    auto* metaIter = AiNodeEntryGetMetaDataIterator(nentry, nullptr);
+
+    while (!AiMetaDataIteratorFinished(metaIter)) {
+        const auto* meta = AiMetaDataIteratorGetNext(metaIter);
+        const auto* conversion =
+            AiShaderExport::get_default_value_conversion(meta->type);
+        if (conversion == nullptr || conversion->f == nullptr) { continue; }
+        metadata[meta->name.c_str()] = conversion->f(meta->value, nullptr);
+    }
+
+    AiMetaDataIteratorDestroy(metaIter);
+    return metadata;
+}
+
+VtTokenArray describeEnum(const AtParamEntry* pentry) {
+    VtTokenArray values;
+    const auto enumType = AiParamGetEnum(pentry);
+    if (enumType == nullptr) { return values; }
+    for (auto i = 0; enumType[i] != nullptr; ++i) {
+        values.push_back(TfToken(enumType[i]));
+    }
+    return values;
+}
+
+NodeEntryDesc describeNodeEntry(const AtNodeEntry* nentry) {
+    NodeEntryDesc desc;
+    const auto filename = AiNodeEntryGetFilename(nentry);
+    desc.name = TfToken(AiNodeEntryGetName(nentry));
+    desc.filename = TfToken(filename == nullptr ? "<built-in>" : filename);
+    desc.nodeEntryType =
+        UsdAiNodeAPI::GetNodeEntryTokenFromType(AiNodeEntryGetType(nentry));
+    desc.outputType = UsdAiNodeAPI::GetParamTypeTokenFromType(
+        AiNodeEntryGetOutputType(nentry));
+    desc.metadata = describeNodeMetadata(nentry);
+
+    auto paramIter = AiNodeEntryGetParamIterator(nentry);
+
+    while (!AiParamIteratorFinished(paramIter)) {
+        const auto* pentry = AiParamIteratorGetNext(paramIter);
+        const auto paramType = AiParamGetType(pentry);
+        const auto paramName = AiParamGetName(pentry);
+
+        AttributeDesc attr;
+        attr.name = TfToken(paramName.c_str());
+        attr.paramType = UsdAiNodeAPI::GetParamTypeTokenFromType(paramType);
+        if (paramType == AI_TYPE_ARRAY) {
+            const auto* defaultValue = AiParamGetDefault(pentry);
+            if (defaultValue == nullptr) { continue; }
+            const auto* array = defaultValue->ARRAY();
+            if (array == nullptr) { continue; }
+            const auto elemType = AiArrayGetType(array);
+            const auto* conversion =
+                AiShaderExport::get_array_conversion(elemType);
+            if (conversion == nullptr) { continue; }
+            attr.typeName = conversion->type;
+            if (conversion->f != nullptr) { attr.value = conversion->f(array); }
+            attr.elemType = UsdAiNodeAPI::GetParamTypeTokenFromType(elemType);
+        } else {
+            const auto* conversion =
+                AiShaderExport::get_default_value_conversion(paramType);
+            if (conversion == nullptr) { continue; }
+            attr.typeName = conversion->type;
+            if (conversion->f != nullptr) {
+                attr.value = conversion->f(*AiParamGetDefault(pentry), pentry);
+            }
+            if (paramType == AI_TYPE_ENUM) {
+                attr.enumValues = describeEnum(pentry);
+            }
+        }
+        attr.metadata = describeMetadata(nentry, paramName);
+        desc.attributes.push_back(std::move(attr));
+    }
+
+    AiParamIteratorDestroy(paramIter);
+    return desc;
+}
+
+SdfAttributeSpecHandle authorAttribute(
+    const SdfPrimSpecHandle& primSpec, const TfToken& name,
+    const SdfValueTypeName& typeName, SdfVariability variability,
+    const VtValue& value) {
+    if (!SdfPath::IsValidNamespacedIdentifier(name)) {
+        return SdfAttributeSpecHandle();
+    }
+    auto attrSpec =
+        SdfAttributeSpec::New(primSpec, name, typeName, variability, false);
+    if (attrSpec && !value.IsEmpty()) { attrSpec->SetDefaultValue(value); }
+    return attrSpec;
+}
+
+// Matches UsdAiNodeAPI::SetMetadataOnAttribute.
+void authorMetadataAsCustomData(
+    const SdfAttributeSpecHandle& attrSpec,
+    const std::vector<MetadataDesc>& metadata) {
+    VtDictionary values;
+    for (const auto& meta : metadata) {
+        if (!meta.value.IsEmpty()) { values[meta.name] = meta.value; }
+    }
+    if (!values.empty()) {
+        attrSpec->SetCustomData(UsdAiTokens->arnoldMetadata, VtValue(values));
+    }
+}
+
+// Matches UsdAiNodeAPI::AddMetadataToAttribute.
+void authorMetadataAsAttributes(
+    const SdfPrimSpecHandle& primSpec, const TfToken& paramName,
+    const std::vector<MetadataDesc>& metadata) {
+    for (const auto& meta : metadata) {
+        auto metaName = meta.name;
+        std::replace(metaName.begin(), metaName.end(), '.', ':');
+        auto attrSpec = authorAttribute(
+            primSpec, TfToken(paramName.GetString() + ":" + metaName),
+            meta.typeName, SdfVariabilityUniform, meta.value);
+        if (attrSpec) {
+            attrSpec->SetInfo(UsdAiTokens->paramType, VtValue(meta.paramType));
+        }
+    }
+}
+
+// Authors the description with Sdf directly, replacing any existing
+// description of the node entry, which is much cheaper than going through
+// the Usd API for every attribute.
+SdfPrimSpecHandle authorNodeEntry(
+    const SdfLayerHandle& layer, const NodeEntryDesc& desc,
+    bool compactMetadata) {
+    if (!layer || !SdfPath::IsValidIdentifier(desc.name)) {
+        return SdfPrimSpecHandle();
+    }
+    const auto pseudoRoot = layer->GetPseudoRoot();
+    const auto path = SdfPath::AbsoluteRootPath().AppendChild(desc.name);
+    const auto existing = layer->GetPrimAtPath(path);
+    if (existing) { pseudoRoot->RemoveNameChild(existing); }
+    auto primSpec = SdfPrimSpec::New(pseudoRoot, desc.name, SdfSpecifierDef);
+    if (!primSpec) { return primSpec; }
+    primSpec->SetInfo(UsdAiTokens->filename, VtValue(desc.filename));
+    primSpec->SetInfo(UsdAiTokens->outputType, VtValue(desc.outputType));
+    if (!desc.metadata.empty()) {
+        primSpec->SetCustomData(
+            UsdAiTokens->arnoldMetadata, VtValue(desc.metadata));
+    }
+    authorAttribute(
+        primSpec, UsdShadeTokens->infoId, SdfValueTypeNames->Token,
+        SdfVariabilityUniform, VtValue(desc.name));
+    authorAttribute(
+        primSpec, UsdAiTokens->infoNode_entry_type, SdfValueTypeNames->Token,
+        SdfVariabilityUniform, VtValue(desc.nodeEntryType));
+    for (const auto& attr : desc.attributes) {
+        auto attrSpec = authorAttribute(
+            primSpec, attr.name, attr.typeName, attr.variability, attr.value);
+        if (!attrSpec) { continue; }
+        attrSpec->SetInfo(UsdAiTokens->paramType, VtValue(attr.paramType));
+        if (!attr.elemType.IsEmpty()) {
+            attrSpec->SetInfo(UsdAiTokens->elemType, VtValue(attr.elemType));
+        }
+        if (!attr.enumValues.empty()) {
+            attrSpec->SetInfo(
+                UsdAiTokens->enumValues, VtValue(attr.enumValues));
+        }
+        if (compactMetadata) {
+            authorMetadataAsCustomData(attrSpec, attr.metadata);
+        } else {
+            authorMetadataAsAttributes(primSpec, attr.name, attr.metadata);
+        }
+    }
+    return primSpec;
+}
+
+UsdStageRefPtr runShaderInfo(const std::string& additionalFlags) {
     std::stringstream command;
     command << "usdAiShaderInfo --cout";
     if (!additionalFlags.empty()) { command << " " << additionalFlags; }
     FILE* pipe = popen(command.str().c_str(), "r");
-    if (pipe != nullptr) {
-        std::stringstream result;
-        std::array<char, 4096> buffer = {0};
-        while (!feof(pipe)) {
-            if (fgets(buffer.data(), buffer.size(), pipe) != nullptr) {
-                result << buffer.data();
+    if (pipe == nullptr) { return nullptr; }
+    std::string result;
+    std::array<char, 65536> buffer;
+    size_t read = 0;
+    while ((read = fread(buffer.data(), 1, buffer.size(), pipe)) > 0) {
+        result.append(buffer.data(), read);
+    }
+    pclose(pipe);
+    auto ret = UsdStage::CreateInMemory(".usda");
+    ret->GetRootLayer()->ImportFromString(result);
+    return ret;
+}
+
+} // namespace
+
+UsdStageRefPtr UsdAiGetArnoldShaderDesc(const std::string& additionalFlags) {
+    // The description of an active session depends on what the host loaded,
+    // which the cache key can't capture, and it's cheap to author anyway.
+    // The session belongs to the host, so the flags are not applied to it.
+    if (AiUniverseIsActive()) {
+        auto ret = UsdStage::CreateInMemory(".usda");
+        UsdAiDescribeArnoldShaders(ret);
+        return ret;
+    }
+
+    const auto cacheDir = TfGetEnvSetting(USDAI_SHADER_DESC_CACHE)
+                              ? getCacheDir()
+                              : std::string();
+    if (cacheDir.empty()) { return runShaderInfo(additionalFlags); }
+
+    const auto key = getCacheKey(additionalFlags);
+    const auto cachePath = getCachePath(cacheDir, key);
+    auto ret = readCache(cachePath, key);
+    if (ret != nullptr) { return ret; }
+
+    ret = runShaderInfo(additionalFlags);
+    // Don't cache a failed run, otherwise we would keep returning an
+    // empty description until the plugins change.
+    if (ret != nullptr && !ret->GetPseudoRoot().GetChildren().empty()) {
+        writeCache(ret->GetRootLayer(), cacheDir, cachePath, key);
+    }
+    return ret;
+}
+
+std::vector<std::string> UsdAiLoadArnoldMetadata(const std::string& path) {
+    std::vector<std::string> files;
+    if (TfIsDir(path)) {
+        for (const auto& file : TfListDir(path)) {
+            if (TfStringEndsWith(file, ".mtd") && TfIsFile(file)) {
+                files.push_back(file);
             }
         }
-        pclose(pipe);
-        ret = UsdStage::CreateInMemory(".usda");
-        ret->GetRootLayer()->ImportFromString(result.str());
+        std::sort(files.begin(), files.end());
+    } else if (TfIsFile(path)) {
+        files.push_back(path);
     }
-    return ret;
+    // AiMetaDataLoadFile writes to the global metadata store of the
+    // universe, so files are loaded one at a time.
+    for (const auto& file : files) { AiMetaDataLoadFile(file.c_str()); }
+    return files;
+}
+
+UsdPrim UsdAiDescribeArnoldNodeEntry(
+    const UsdStagePtr& stage, const AtNodeEntry* nentry,
+    bool compactMetadata) {
+    if (stage == nullptr || nentry == nullptr) { return UsdPrim(); }
+    const auto desc = describeNodeEntry(nentry);
+    SdfPrimSpecHandle primSpec;
+    {
+        SdfChangeBlock changeBlock;
+        primSpec = authorNodeEntry(
+            stage->GetEditTarget().GetLayer(), desc, compactMetadata);
+    }
+    return primSpec ? stage->GetPrimAtPath(primSpec->GetPath()) : UsdPrim();
+}
+
+void UsdAiDescribeArnoldNodeEntries(
+    const UsdStagePtr& stage, const std::vector<const AtNodeEntry*>& nentries,
+    bool compactMetadata) {
+    if (stage == nullptr) { return; }
+    // Querying node entries is read-only, so the descriptions are gathered
+    // in parallel, then authored serially as Sdf layers are not safe
+    // to write from multiple threads.
+    std::vector<NodeEntryDesc> descs(nentries.size());
+    WorkParallelForN(nentries.size(), [&](size_t begin, size_t end) {
+        for (auto i = begin; i < end; ++i) {
+            if (nentries[i] != nullptr) {
+                descs[i] = describeNodeEntry(nentries[i]);
+            }
+        }
+    });
+    const auto layer = stage->GetEditTarget().GetLayer();
+    SdfChangeBlock changeBlock;
+    for (const auto& desc : descs) {
+        if (!desc.name.IsEmpty()) {
+            authorNodeEntry(layer, desc, compactMetadata);
+        }
+    }
+}
+
+void UsdAiDescribeArnoldShaders(
+    const UsdStagePtr& stage, bool compactMetadata) {
+    std::vector<const AtNodeEntry*> nentries;
+    auto* nentryIter = AiUniverseGetNodeEntryIterator(AI_NODE_SHADER);
+
+    while (!AiNodeEntryIteratorFinished(nentryIter)) {
+        nentries.push_back(AiNodeEntryIteratorGetNext(nentryIter));
+    }
+
+    AiNodeEntryIteratorDestroy(nentryIter);
+    UsdAiDescribeArnoldNodeEntries(stage, nentries, compactMetadata);
 }
 
 PXR_NAMESPACE_CLOSE_SCOPE
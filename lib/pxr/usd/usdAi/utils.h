@@ -20,13 +20,61 @@
 #include "pxr/usd/usd/stage.h"
 
 #include <string>
+#include <vector>
+
+struct AtNodeEntry;
 
 PXR_NAMESPACE_OPEN_SCOPE
 
+/// Version of the layout of the shader descriptions. Bump this when it
+/// changes, so cached and incrementally updated descriptions are rebuilt.
+constexpr int UsdAiShaderDescVersion = 3;
+
+/// Returns a stage describing every Arnold shader node entry.
+///
+/// When an Arnold session is active, the description is authored
+/// in-process from the node entries and metadata already loaded in that
+/// session, and \p additionalFlags are ignored. Hosts owning the session
+/// have to load extra plugins and metadata themselves, for example with
+/// AiLoadPlugins and UsdAiLoadArnoldMetadata. Otherwise the description is
+/// generated by running usdAiShaderInfo with \p additionalFlags and cached
+/// on disk.
 USDAI_API
 UsdStageRefPtr UsdAiGetArnoldShaderDesc(
     const std::string& additionalFlags = std::string());
 
+/// Loads a metadata file, or every .mtd file in a directory, into the active
+/// Arnold session. Returns the paths of the loaded files.
+USDAI_API
+std::vector<std::string> UsdAiLoadArnoldMetadata(const std::string& path);
+
+/// Defines a prim on \p stage describing \p nentry, with an attribute per
+/// parameter holding its default and metadata. Requires an active Arnold
+/// session.
+///
+/// When \p compactMetadata is true, the metadata of each parameter is stored
+/// as a dictionary in the customData of its attribute, otherwise as separate
+/// attributes named <parameter>:<metadata>. Use
+/// UsdAiNodeAPI::GetMetadataValuesForAttribute to read either encoding.
+USDAI_API
+UsdPrim UsdAiDescribeArnoldNodeEntry(
+    const UsdStagePtr& stage, const AtNodeEntry* nentry,
+    bool compactMetadata = true);
+
+/// Describes \p nentries on \p stage in a single batch, authoring to its
+/// current edit target. Existing descriptions of the same node entries are
+/// replaced. Requires an active Arnold session.
+USDAI_API
+void UsdAiDescribeArnoldNodeEntries(
+    const UsdStagePtr& stage, const std::vector<const AtNodeEntry*>& nentries,
+    bool compactMetadata = true);
+
+/// Describes every shader node entry of the active Arnold session on
+/// \p stage, authoring to its current edit target.
+USDAI_API
+void UsdAiDescribeArnoldShaders(
+    const UsdStagePtr& stage, bool compactMetadata = true);
+
 PXR_NAMESPACE_CLOSE_SCOPE
 
 #endif // USDAI_UTILS_H
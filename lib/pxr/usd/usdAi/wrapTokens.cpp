@@ -122,6 +122,7 @@ void wrapUsdAiTokens()
     _AddToken(cls, "aiVisibilityVolume", UsdAiTokens->aiVisibilityVolume);
     _AddToken(cls, "aiVolume", UsdAiTokens->aiVolume);
     _AddToken(cls, "aiVolume_padding", UsdAiTokens->aiVolume_padding);
+    _AddToken(cls, "arnoldMetadata", UsdAiTokens->arnoldMetadata);
     _AddToken(cls, "aRRAY", UsdAiTokens->aRRAY);
     _AddToken(cls, "auto_", UsdAiTokens->auto_);
     _AddToken(cls, "bOOL", UsdAiTokens->bOOL);
@@ -131,6 +132,7 @@ void wrapUsdAiTokens()
     _AddToken(cls, "driver", UsdAiTokens->driver);
     _AddToken(cls, "edge_length", UsdAiTokens->edge_length);
     _AddToken(cls, "elemType", UsdAiTokens->elemType);
+    _AddToken(cls, "enumValues", UsdAiTokens->enumValues);
     _AddToken(cls, "filename", UsdAiTokens->filename);
     _AddToken(cls, "filepath", UsdAiTokens->filepath);
     _AddToken(cls, "filter", UsdAiTokens->filter);
@@ -146,6 +148,7 @@ void wrapUsdAiTokens()
     _AddToken(cls, "nodeType", UsdAiTokens->nodeType);
     _AddToken(cls, "none", UsdAiTokens->none);
     _AddToken(cls, "object", UsdAiTokens->object);
+    _AddToken(cls, "outputType", UsdAiTokens->outputType);
     _AddToken(cls, "paramType", UsdAiTokens->paramType);
     _AddToken(cls, "path", UsdAiTokens->path);
     _AddToken(cls, "pin_borders", UsdAiTokens->pin_borders);
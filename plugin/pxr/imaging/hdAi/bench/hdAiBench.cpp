@@ -0,0 +1,342 @@
+// Copyright 2019 Luma Pictures
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <pxr/base/gf/camera.h>
+#include <pxr/base/gf/frustum.h>
+#include <pxr/base/gf/matrix4d.h>
+#include <pxr/base/gf/range3d.h>
+#include <pxr/base/gf/rotation.h>
+#include <pxr/base/js/json.h>
+#include <pxr/base/tf/stringUtils.h>
+
+#include <pxr/imaging/hd/renderIndex.h>
+#include <pxr/imaging/hd/renderPassState.h>
+#include <pxr/imaging/hd/rprimCollection.h>
+#include <pxr/imaging/hd/task.h>
+#include <pxr/imaging/hd/tokens.h>
+
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdGeom/bboxCache.h>
+#include <pxr/usd/usdGeom/camera.h>
+#include <pxr/usd/usdGeom/metrics.h>
+#include <pxr/usd/usdGeom/tokens.h>
+
+#include <pxr/usdImaging/usdImaging/delegate.h>
+
+#include "pxr/imaging/hdAi/renderDelegate.h"
+#include "pxr/imaging/hdAi/renderPass.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <sys/resource.h>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace {
+
+constexpr auto helpText = R"VOGON(
+usage hdAiBench
+        [-h] --stage FILENAME
+        [--out FILENAME]
+        [--camera PATH]
+        [--frames N] [--start TIME] [--end TIME]
+        [--width N] [--height N]
+        [--timeout SECONDS]
+
+Render a USD stage with hdAi, without a GL context, and print how long
+syncing and rendering each frame took as JSON.
+
+Every frame is rendered until it converges or the timeout is reached. The
+time of the frames is spread evenly between the start and the end time.
+Without a camera, the frames orbit around the bounds of the stage.
+
+optional arguments:
+ --stage    USD file to render.
+ --out      Write the timings to a file instead of the standard output.
+ --camera   Path of the camera to render through.
+ --frames   Number of frames to render, 1 by default.
+ --start    Time of the first frame, the start time code of the stage by
+            default.
+ --end      Time of the last frame, the end time code of the stage by
+            default.
+ --width    Width of the rendered image, 640 by default.
+ --height   Height of the rendered image, 480 by default.
+ --timeout  Seconds to wait for each frame to converge, 60 by default.
+)VOGON";
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(const Clock::time_point& start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/// Syncs and executes a single render pass, like HdxRenderTask does, but
+/// without any of the GL state, so the benchmark runs on headless machines.
+class BenchTask : public HdTask {
+public:
+    BenchTask(
+        const HdRenderPassSharedPtr& renderPass,
+        const HdRenderPassStateSharedPtr& renderPassState)
+        : HdTask(SdfPath::EmptyPath()),
+          _renderPass(renderPass),
+          _renderPassState(renderPassState) {}
+
+    void Sync(
+        HdSceneDelegate* delegate, HdTaskContext* ctx,
+        HdDirtyBits* dirtyBits) override {
+        TF_UNUSED(delegate);
+        TF_UNUSED(ctx);
+        _renderPass->Sync();
+        *dirtyBits = HdChangeTracker::Clean;
+    }
+
+    void Prepare(HdTaskContext* ctx, HdRenderIndex* renderIndex) override {
+        TF_UNUSED(ctx);
+        _renderPassState->Prepare(renderIndex->GetResourceRegistry());
+    }
+
+    void Execute(HdTaskContext* ctx) override {
+        TF_UNUSED(ctx);
+        _renderPass->Execute(_renderPassState, GetRenderTags());
+    }
+
+    const TfTokenVector& GetRenderTags() const override {
+        static const TfTokenVector renderTags{HdTokens->geometry};
+        return renderTags;
+    }
+
+private:
+    HdRenderPassSharedPtr _renderPass;
+    HdRenderPassStateSharedPtr _renderPassState;
+};
+
+/// Returns a camera orbiting around the bounds of the stage.
+GfCamera getOrbitCamera(
+    const UsdStageRefPtr& stage, const UsdTimeCode& time, double angle,
+    double aspectRatio) {
+    UsdGeomBBoxCache bboxCache(
+        time, {UsdGeomTokens->default_, UsdGeomTokens->render});
+    const auto range =
+        bboxCache.ComputeWorldBound(stage->GetPseudoRoot())
+            .ComputeAlignedRange();
+    const auto center = range.IsEmpty() ? GfVec3d(0.0) : range.GetMidpoint();
+    const auto radius =
+        range.IsEmpty() ? 1.0 : std::max(range.GetSize().GetLength(), 1e-3);
+    const auto zUp = UsdGeomGetStageUpAxis(stage) == UsdGeomTokens->z;
+    const auto upAxis = zUp ? GfVec3d::ZAxis() : GfVec3d::YAxis();
+    // The camera looks down -Z, so Z up stages need the camera rotated
+    // first.
+    GfMatrix4d transform = GfMatrix4d(1.0).SetTranslate(GfVec3d(0, 0, radius));
+    if (zUp) {
+        transform *=
+            GfMatrix4d(1.0).SetRotate(GfRotation(GfVec3d::XAxis(), 90.0));
+    }
+    transform *= GfMatrix4d(1.0).SetRotate(GfRotation(upAxis, angle));
+    transform *= GfMatrix4d(1.0).SetTranslate(center);
+    GfCamera camera(transform);
+    camera.SetPerspectiveFromAspectRatioAndFieldOfView(
+        static_cast<float>(aspectRatio), 50.0f, GfCamera::FOVHorizontal);
+    camera.SetClippingRange(GfRange1f(
+        static_cast<float>(radius * 0.01), static_cast<float>(radius * 10.0)));
+    return camera;
+}
+
+/// Returns the peak resident set size of the process in bytes.
+int64_t getPeakRss() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) { return 0; }
+    return static_cast<int64_t>(usage.ru_maxrss) * 1024;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const auto* startArg = argv;
+    const auto* endArg = argv + argc;
+
+    auto findFlag = [&](const std::string& argName) -> bool {
+        return std::find(startArg, endArg, argName) != endArg;
+    };
+
+    auto getFlagValue = [&](const std::string& argName,
+                            const std::string& defaultValue =
+                                "") -> std::string {
+        const auto* flag = std::find(startArg, endArg, argName);
+        if (flag >= (endArg - 1)) { return defaultValue; }
+        return *(++flag);
+    };
+
+    if (findFlag("-h") || findFlag("--help")) {
+        std::cout << helpText;
+        return 0;
+    }
+
+    const auto stagePath = getFlagValue("--stage");
+    if (stagePath.empty()) {
+        std::cerr << "No stage specified." << std::endl << helpText;
+        return 1;
+    }
+    auto stage = UsdStage::Open(stagePath);
+    if (!stage) {
+        std::cerr << "Can't open " << stagePath << "." << std::endl;
+        return 1;
+    }
+
+    int frames = 1;
+    int width = 640;
+    int height = 480;
+    double timeout = 60.0;
+    double startTime = 0.0;
+    double endTime = 0.0;
+    try {
+        frames = std::max(1, std::stoi(getFlagValue("--frames", "1")));
+        width = std::max(1, std::stoi(getFlagValue("--width", "640")));
+        height = std::max(1, std::stoi(getFlagValue("--height", "480")));
+        timeout = std::stod(getFlagValue("--timeout", "60"));
+        startTime = std::stod(getFlagValue(
+            "--start", TfStringify(stage->GetStartTimeCode())));
+        endTime = std::stod(
+            getFlagValue("--end", TfStringify(stage->GetEndTimeCode())));
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid argument: " << e.what() << "." << std::endl
+                  << helpText;
+        return 1;
+    }
+    const auto hasTimeRange =
+        stage->HasAuthoredTimeCodeRange() || findFlag("--start");
+
+    UsdGeomCamera camera;
+    const auto cameraPath = getFlagValue("--camera");
+    if (!cameraPath.empty()) {
+        camera = UsdGeomCamera(stage->GetPrimAtPath(SdfPath(cameraPath)));
+        if (!camera) {
+            std::cerr << "Can't find camera " << cameraPath << "."
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    JsObject results;
+    results["stage"] = JsValue(stagePath);
+    results["width"] = JsValue(width);
+    results["height"] = JsValue(height);
+
+    {
+        HdAiRenderDelegate renderDelegate;
+        std::unique_ptr<HdRenderIndex> renderIndex(
+            HdRenderIndex::New(&renderDelegate));
+
+        const auto populateStart = Clock::now();
+        UsdImagingDelegate sceneDelegate(
+            renderIndex.get(), SdfPath::AbsoluteRootPath());
+        sceneDelegate.Populate(stage->GetPseudoRoot());
+        results["populate"] = JsValue(secondsSince(populateStart));
+
+        const HdRprimCollection collection(
+            HdTokens->geometry, HdReprSelector(HdReprTokens->refined));
+        auto renderPass =
+            renderDelegate.CreateRenderPass(renderIndex.get(), collection);
+        auto* aiRenderPass = static_cast<HdAiRenderPass*>(renderPass.get());
+        aiRenderPass->SetCompositorEnabled(false);
+        HdRenderPassStateSharedPtr renderPassState(new HdRenderPassState());
+        HdTaskSharedPtrVector tasks{
+            HdTaskSharedPtr(new BenchTask(renderPass, renderPassState))};
+        HdTaskContext taskContext;
+
+        auto executeTasks = [&]() {
+            for (auto& task : tasks) {
+                task->Prepare(&taskContext, renderIndex.get());
+            }
+            renderDelegate.CommitResources(&renderIndex->GetChangeTracker());
+            for (auto& task : tasks) { task->Execute(&taskContext); }
+        };
+
+        auto getFrameTime = [&](int frame) -> UsdTimeCode {
+            if (!hasTimeRange) { return UsdTimeCode::Default(); }
+            if (frames == 1) { return UsdTimeCode(startTime); }
+            return UsdTimeCode(
+                startTime + (endTime - startTime) * frame / (frames - 1));
+        };
+
+        JsArray frameResults;
+        for (auto frame = 0; frame < frames; ++frame) {
+            const auto time = getFrameTime(frame);
+            const auto aspectRatio = static_cast<double>(width) / height;
+            const auto frustum =
+                camera ? camera.GetCamera(time).GetFrustum()
+                       : getOrbitCamera(
+                             stage, time, 360.0 * frame / frames, aspectRatio)
+                             .GetFrustum();
+            renderPassState->SetCameraFramingState(
+                frustum.ComputeViewMatrix(), frustum.ComputeProjectionMatrix(),
+                GfVec4d(0, 0, width, height),
+                HdRenderPassState::ClipPlanesVector());
+
+            JsObject frameResult;
+            frameResult["time"] =
+                JsValue(time.IsDefault() ? 0.0 : time.GetValue());
+
+            // Buckets of the previous frame don't count for this one.
+            aiRenderPass->ResetBuckets();
+            const auto syncStart = Clock::now();
+            sceneDelegate.SetTime(time);
+            renderIndex->SyncAll(&tasks, &taskContext);
+            frameResult["sync"] = JsValue(secondsSince(syncStart));
+
+            const auto renderStart = Clock::now();
+            JsValue firstBucket;
+            JsValue converged;
+            for (auto first = true;; first = false) {
+                if (!first) { renderIndex->SyncAll(&tasks, &taskContext); }
+                executeTasks();
+                if (firstBucket.IsNull() && aiRenderPass->HasBuckets()) {
+                    firstBucket = JsValue(secondsSince(renderStart));
+                }
+                if (aiRenderPass->IsConverged()) {
+                    converged = JsValue(secondsSince(renderStart));
+                    break;
+                }
+                if (secondsSince(renderStart) > timeout) { break; }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            frameResult["firstBucket"] = firstBucket;
+            frameResult["converged"] = converged;
+            frameResults.emplace_back(frameResult);
+        }
+        results["firstSync"] = frameResults.front().GetJsObject().at("sync");
+        results["frames"] = JsValue(frameResults);
+    }
+    results["peakRss"] = JsValue(getPeakRss());
+
+    const auto outFile = getFlagValue("--out");
+    if (outFile.empty()) {
+        JsWriteToStream(JsValue(results), std::cout);
+        std::cout << std::endl;
+    } else {
+        std::ofstream out(outFile);
+        if (!out) {
+            std::cerr << "Can't open " << outFile << "." << std::endl;
+            return 1;
+        }
+        JsWriteToStream(JsValue(results), out);
+    }
+
+    return 0;
+}
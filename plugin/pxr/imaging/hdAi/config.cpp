@@ -42,6 +42,18 @@ TF_DEFINE_ENV_SETTING(
 
 TF_DEFINE_ENV_SETTING(HDAI_shutter_end, "0.25f", "Shutter end for the camera.");
 
+TF_DEFINE_ENV_SETTING(
+    HDAI_translate_usd_preview_surface, true,
+    "Translate UsdPreviewSurface networks to built-in Arnold shaders.");
+
+TF_DEFINE_ENV_SETTING(
+    HDAI_dome_texture_cache, "",
+    "Directory to cache pre-filtered, mipmapped dome light textures in.");
+
+TF_DEFINE_ENV_SETTING(
+    HDAI_trace_file, "",
+    "Chrome trace file to write when the render delegate is destroyed.");
+
 HdAiConfig::HdAiConfig() {
     bucket_size = std::max(1, TfGetEnvSetting(HDAI_bucket_size));
     abort_on_error = TfGetEnvSetting(HDAI_abort_on_error);
@@ -53,6 +65,10 @@ HdAiConfig::HdAiConfig() {
         std::atof(TfGetEnvSetting(HDAI_shutter_start).c_str()));
     shutter_end = static_cast<float>(
         std::atof(TfGetEnvSetting(HDAI_shutter_end).c_str()));
+    translate_usd_preview_surface =
+        TfGetEnvSetting(HDAI_translate_usd_preview_surface);
+    dome_texture_cache = TfGetEnvSetting(HDAI_dome_texture_cache);
+    trace_file = TfGetEnvSetting(HDAI_trace_file);
 }
 
 const HdAiConfig& HdAiConfig::GetInstance() {
@@ -20,6 +20,8 @@
 
 #include "pxr/imaging/hdAi/api.h"
 
+#include <string>
+
 PXR_NAMESPACE_OPEN_SCOPE
 
 class HdAiConfig {
@@ -51,6 +53,17 @@ public:
     /// HDAI_shutter_end
     float shutter_end;
 
+    /// HDAI_translate_usd_preview_surface
+    bool translate_usd_preview_surface;
+
+    /// HDAI_dome_texture_cache
+    std::string dome_texture_cache;
+
+    /// HDAI_trace_file
+    ///
+    /// Only used when built with BUILD_TRACE.
+    std::string trace_file;
+
 private:
     HDAI_API
     HdAiConfig();
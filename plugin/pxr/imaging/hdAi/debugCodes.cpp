@@ -23,6 +23,10 @@ TF_REGISTRY_FUNCTION(TfDebug) {
         HDAI_MATERIAL,
         "Print info about material translation for the arnold hydra render "
         "delegate");
+    TF_DEBUG_ENVIRONMENT_SYMBOL(
+        HDAI_RENDER_STATS,
+        "Print the statistics of the arnold hydra render delegate when the "
+        "render converges");
 }
 
 PXR_NAMESPACE_CLOSE_SCOPE
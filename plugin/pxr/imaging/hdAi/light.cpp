@@ -13,13 +13,23 @@
 // limitations under the License.
 #include "pxr/imaging/hdAi/light.h"
 
+#include "pxr/imaging/hdAi/config.h"
 #include "pxr/imaging/hdAi/material.h"
 #include "pxr/imaging/hdAi/utils.h"
 
+#include <pxr/base/arch/fileSystem.h>
+#include <pxr/base/arch/hash.h>
+#include <pxr/base/tf/fileUtils.h>
+#include <pxr/base/tf/pathUtils.h>
+#include <pxr/base/tf/stringUtils.h>
+
 #include <pxr/usd/usdLux/tokens.h>
 
 #include <pxr/usd/sdf/assetPath.h>
 
+#include <cinttypes>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 PXR_NAMESPACE_OPEN_SCOPE
@@ -46,6 +56,51 @@ const AtString imageStr("image");
 const AtString filenameStr("filename");
 const AtString colorStr("color");
 
+std::string getTexturePath(const VtValue& value) {
+    if (!value.IsHolding<SdfAssetPath>()) { return {}; }
+    const auto& assetPath = value.UncheckedGet<SdfAssetPath>();
+    const auto& path = assetPath.GetResolvedPath();
+    return path.empty() ? assetPath.GetAssetPath() : path;
+}
+
+// Converts latlong environment textures to pre-filtered, mipmapped tx
+// files in the cache directory, so they are only processed once, even
+// across sessions. Cache entries are keyed by the path and the
+// modification time of the source texture.
+std::string getCachedEnvironmentTexture(
+    const std::string& path, double mtime) {
+    const auto& cacheDir = HdAiConfig::GetInstance().dome_texture_cache;
+    if (cacheDir.empty() || TfStringEndsWith(path, ".tx")) { return path; }
+    // std::hash is not guaranteed to be the same across runs and builds.
+    const auto key = TfStringPrintf("%s:%f", path.c_str(), mtime);
+    const auto hash = ArchHash64(key.c_str(), key.size());
+    const auto cachedPath = TfStringCatPaths(
+        cacheDir, TfStringPrintf(
+                      "%s_%016" PRIx64 ".tx",
+                      TfStringGetBeforeSuffix(TfGetBaseName(path)).c_str(),
+                      hash));
+    if (TfIsFile(cachedPath)) { return cachedPath; }
+    if (!TfIsDir(cacheDir) && !TfMakeDirs(cacheDir)) { return path; }
+    // Lights are synced in parallel, and any of them can receive the
+    // result of a job, so conversions are serialized.
+    static std::mutex makeTxMutex;
+    std::lock_guard<std::mutex> lock(makeTxMutex);
+    if (TfIsFile(cachedPath)) { return cachedPath; }
+    AiMakeTx(
+        path.c_str(),
+        TfStringPrintf("-o \"%s\" --envlatl", cachedPath.c_str()).c_str());
+    // Wait until this job finishes, ignoring other jobs queued by the
+    // host. Each call blocks until a job finishes or the timeout expires.
+    constexpr unsigned int waitTimeout = 1000;
+    AtMakeTxStatus status;
+    const char* source = nullptr;
+    const char* dest = nullptr;
+    while (AiMakeTxWaitJob(status, source, dest, waitTimeout) != 0) {
+        if (source != nullptr && path == source) { break; }
+    }
+    return TfIsFile(cachedPath) ? cachedPath : path;
+}
+
 struct ParamDesc {
     ParamDesc(const char* aname, const TfToken& hname)
         : arnoldName(aname), hdName(hname) {}
@@ -78,6 +133,82 @@ std::vector<ParamDesc> diskParams = {{"radius", HdLightTokens->radius}};
 
 std::vector<ParamDesc> cylinderParams = {{"radius", HdLightTokens->radius}};
 
+// Light parameters read by the sync functions, instead of being set directly.
+// These are only used to check if anything changed on the light.
+std::vector<TfToken> pointSyncParams = {HdLightTokens->shapingFocus,
+                                        HdLightTokens->shapingConeAngle,
+                                        HdLightTokens->shapingConeSoftness};
+
+std::vector<TfToken> spotSyncParams = {HdLightTokens->shapingConeAngle,
+                                       HdLightTokens->shapingConeSoftness};
+
+std::vector<TfToken> rectSyncParams = {HdLightTokens->width,
+                                       HdLightTokens->height};
+
+std::vector<TfToken> cylinderSyncParams = {UsdLuxTokens->length};
+
+std::vector<TfToken> domeSyncParams = {UsdLuxTokens->textureFormat};
+
+/// Light parameter bound to the parameter entry of a light type. The
+/// parameter entry is nullptr for parameters handled by the sync functions.
+struct BoundParam {
+    BoundParam(const AtParamEntry* pe, const TfToken& hname)
+        : pentry(pe), hdName(hname) {}
+    const AtParamEntry* pentry;
+    TfToken hdName;
+};
+
+using BoundParams = std::vector<BoundParam>;
+
+// Looking up the parameter entries once for each light type, instead of
+// every time the parameters of a light change.
+const BoundParams& getBoundParams(const AtNodeEntry* nentry) {
+    static std::mutex mutex;
+    static std::unordered_map<const AtNodeEntry*, BoundParams> boundParams;
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = boundParams.find(nentry);
+    if (it != boundParams.end()) { return it->second; }
+
+    struct TypeParams {
+        const std::vector<ParamDesc>* params;
+        const std::vector<TfToken>* syncParams;
+    };
+    static const std::unordered_map<AtString, TypeParams, AtStringHash>
+        typeParams{
+            {pointLightType, {&pointParams, &pointSyncParams}},
+            {spotLightType, {&spotParams, &spotSyncParams}},
+            {distantLightType, {&distantParams, nullptr}},
+            {diskLightType, {&diskParams, nullptr}},
+            {rectLightType, {nullptr, &rectSyncParams}},
+            {cylinderLightType, {&cylinderParams, &cylinderSyncParams}},
+            {domeLightType, {nullptr, &domeSyncParams}},
+        };
+    auto& params = boundParams[nentry];
+    auto bindParams = [&](const std::vector<ParamDesc>& descs) {
+        for (const auto& desc : descs) {
+            const auto* pentry =
+                AiNodeEntryLookUpParameter(nentry, desc.arnoldName);
+            if (pentry != nullptr) { params.emplace_back(pentry, desc.hdName); }
+        }
+    };
+    bindParams(genericParams);
+    // Light linking is registered with the render delegate.
+    params.emplace_back(nullptr, HdLightTokens->lightLink);
+    params.emplace_back(nullptr, HdLightTokens->shadowLink);
+    const auto typeIt = typeParams.find(AiNodeEntryGetNameAtString(nentry));
+    if (typeIt != typeParams.end()) {
+        if (typeIt->second.params != nullptr) {
+            bindParams(*typeIt->second.params);
+        }
+        if (typeIt->second.syncParams != nullptr) {
+            for (const auto& hdName : *typeIt->second.syncParams) {
+                params.emplace_back(nullptr, hdName);
+            }
+        }
+    }
+    return params;
+}
+
 bool hasSpotLightParams(HdSceneDelegate* delegate, const SdfPath& id) {
     auto isDefault = [&delegate, &id](
                          const TfToken& paramName, float defaultVal) -> bool {
@@ -101,29 +232,24 @@ bool hasSpotLightParams(HdSceneDelegate* delegate, const SdfPath& id) {
     return false;
 }
 
-void iterateParams(
-    AtNode* light, const AtNodeEntry* nentry, const SdfPath& id,
-    HdSceneDelegate* delegate, const std::vector<ParamDesc>& params) {
-    for (const auto& param : params) {
-        const auto* pentry =
-            AiNodeEntryLookUpParameter(nentry, param.arnoldName);
-        if (pentry == nullptr) { continue; }
+void setBoundParams(
+    AtNode* light, const SdfPath& id, HdSceneDelegate* delegate) {
+    for (const auto& param : getBoundParams(AiNodeGetNodeEntry(light))) {
+        if (param.pentry == nullptr) { continue; }
         HdAiSetParameter(
-            light, pentry, delegate->GetLightParamValue(id, param.hdName));
+            light, param.pentry,
+            delegate->GetLightParamValue(id, param.hdName));
     }
 }
 
-auto pointLightSync = [](HdAiLight& aiLight, AtNode* light,
+// For lights where all the parameters are bound to the light type.
+auto boundLightSync = [](HdAiLight& aiLight, AtNode* light,
                          const AtNodeEntry* nentry, const SdfPath& id,
-                         HdSceneDelegate* delegate) {
-    iterateParams(light, nentry, id, delegate, pointParams);
-};
+                         HdSceneDelegate* delegate) {};
 
 auto spotLightSync = [](HdAiLight& aiLight, AtNode* light,
                         const AtNodeEntry* nentry, const SdfPath& id,
                         HdSceneDelegate* delegate) {
-    iterateParams(light, nentry, id, delegate, spotParams);
-
     float hdAngle =
         delegate->GetLightParamValue(id, HdLightTokens->shapingConeAngle)
             .GetWithDefault(180.0f);
@@ -136,18 +262,6 @@ auto spotLightSync = [](HdAiLight& aiLight, AtNode* light,
     AiNodeSetFlt(light, penumbraAngleStr, penumbra);
 };
 
-auto distantLightSync = [](HdAiLight& aiLight, AtNode* light,
-                           const AtNodeEntry* nentry, const SdfPath& id,
-                           HdSceneDelegate* delegate) {
-    iterateParams(light, nentry, id, delegate, distantParams);
-};
-
-auto diskLightSync = [](HdAiLight& aiLight, AtNode* light,
-                        const AtNodeEntry* nentry, const SdfPath& id,
-                        HdSceneDelegate* delegate) {
-    iterateParams(light, nentry, id, delegate, diskParams);
-};
-
 auto rectLightSync = [](HdAiLight& aiLight, AtNode* light,
                         const AtNodeEntry* nentry, const SdfPath& id,
                         HdSceneDelegate* delegate) {
@@ -178,7 +292,6 @@ auto rectLightSync = [](HdAiLight& aiLight, AtNode* light,
 auto cylinderLightSync = [](HdAiLight& aiLight, AtNode* light,
                             const AtNodeEntry* nentry, const SdfPath& id,
                             HdSceneDelegate* delegate) {
-    iterateParams(light, nentry, id, delegate, cylinderParams);
     float length = 1.0f;
     const auto& lengthValue =
         delegate->GetLightParamValue(id, UsdLuxTokens->length);
@@ -251,10 +364,10 @@ void HdAiLight::SpotOrPointLightSync(
 
         // 5. Re-sync
         nentry = AiNodeGetNodeEntry(light);
-        iterateParams(light, nentry, id, sceneDelegate, genericParams);
+        setBoundParams(light, id, sceneDelegate);
         return spotLightSync(*this, light, nentry, id, sceneDelegate);
     }
-    return pointLightSync(*this, light, nentry, id, sceneDelegate);
+    return boundLightSync(*this, light, nentry, id, sceneDelegate);
 }
 
 HdAiLight* HdAiLight::CreatePointSpotLight(
@@ -270,12 +383,12 @@ HdAiLight* HdAiLight::CreatePointSpotLight(
 
 HdAiLight* HdAiLight::CreateDistantLight(
     HdAiRenderDelegate* delegate, const SdfPath& id) {
-    return new HdAiLight(delegate, id, distantLightType, distantLightSync);
+    return new HdAiLight(delegate, id, distantLightType, boundLightSync);
 }
 
 HdAiLight* HdAiLight::CreateDiskLight(
     HdAiRenderDelegate* delegate, const SdfPath& id) {
-    return new HdAiLight(delegate, id, diskLightType, diskLightSync);
+    return new HdAiLight(delegate, id, diskLightType, boundLightSync);
 }
 
 HdAiLight* HdAiLight::CreateRectLight(
@@ -297,28 +410,78 @@ void HdAiLight::Sync(
     HdSceneDelegate* sceneDelegate, HdRenderParam* renderParam,
     HdDirtyBits* dirtyBits) {
     auto* param = reinterpret_cast<HdAiRenderParam*>(renderParam);
+    HdAiRenderStats::SyncTimer syncTimer(
+        param->GetStats(), HdAiRenderStats::Light);
     TF_UNUSED(sceneDelegate);
     TF_UNUSED(dirtyBits);
     if (*dirtyBits & HdLight::DirtyParams) {
-        param->End();
         const auto id = GetId();
         const auto* nentry = AiNodeGetNodeEntry(_light);
-        iterateParams(_light, nentry, id, sceneDelegate, genericParams);
-        _syncParams(*this, _light, nentry, id, sceneDelegate);
-        if (_supportsTexture) {
-            SetupTexture(sceneDelegate->GetLightParamValue(
-                id, HdLightTokens->textureFile));
+        const auto& params = getBoundParams(nentry);
+        std::vector<VtValue> values;
+        values.reserve(params.size());
+        for (const auto& p : params) {
+            values.push_back(sceneDelegate->GetLightParamValue(id, p.hdName));
+        }
+        // Keeping the texture while the file doesn't change on disk, so
+        // Arnold doesn't have to rebuild the importance tables of the
+        // light.
+        const auto texturePath =
+            _supportsTexture ? getTexturePath(sceneDelegate->GetLightParamValue(
+                                   id, HdLightTokens->textureFile))
+                             : std::string();
+        double textureMtime = 0.0;
+        if (!texturePath.empty()) {
+            ArchGetModificationTime(texturePath.c_str(), &textureMtime);
+        }
+        const auto textureChanged =
+            texturePath != _texturePath || textureMtime != _textureMtime;
+        // Only touching the light if any of its parameters changed, and
+        // skipping the parameters that still have the same value.
+        if (values != _paramValues || textureChanged) {
+            param->End();
+            const auto hasPreviousValues = _paramValues.size() == values.size();
+            for (size_t i = 0; i < params.size(); ++i) {
+                if (params[i].pentry == nullptr ||
+                    (hasPreviousValues && values[i] == _paramValues[i])) {
+                    continue;
+                }
+                HdAiSetParameter(_light, params[i].pentry, values[i]);
+            }
+            _syncParams(*this, _light, nentry, id, sceneDelegate);
+            if (textureChanged) {
+                // The file changed on disk, so the cached texture is stale.
+                if (texturePath == _texturePath && !texturePath.empty()) {
+                    AiTextureInvalidate(texturePath.c_str());
+                }
+                _texturePath = texturePath;
+                _textureMtime = textureMtime;
+                SetupTexture();
+            }
+            _delegate->RegisterLightLinking(
+                this,
+                sceneDelegate->GetLightParamValue(id, HdLightTokens->lightLink)
+                    .GetWithDefault<TfToken>(TfToken()),
+                sceneDelegate
+                    ->GetLightParamValue(id, HdLightTokens->shadowLink)
+                    .GetWithDefault<TfToken>(TfToken()));
+            // The sync function can replace the light with a different type,
+            // which has its own parameters.
+            if (AiNodeGetNodeEntry(_light) == nentry) {
+                _paramValues = std::move(values);
+            } else {
+                _paramValues.clear();
+            }
         }
     }
 
     if (*dirtyBits & HdLight::DirtyTransform) {
-        param->End();
-        HdAiSetTransform(_light, sceneDelegate, GetId());
+        HdAiSetTransform(_light, sceneDelegate, GetId(), param);
     }
     *dirtyBits = HdLight::Clean;
 }
 
-void HdAiLight::SetupTexture(const VtValue& value) {
+void HdAiLight::SetupTexture() {
     const auto* nentry = AiNodeGetNodeEntry(_light);
     const auto hasShader =
         AiNodeEntryLookUpParameter(nentry, shaderStr) != nullptr;
@@ -331,12 +494,12 @@ void HdAiLight::SetupTexture(const VtValue& value) {
         AiNodeDestroy(_texture);
         _texture = nullptr;
     }
-    if (!value.IsHolding<SdfAssetPath>()) { return; }
-    const auto& assetPath = value.UncheckedGet<SdfAssetPath>();
-    auto path = assetPath.GetResolvedPath();
-    if (path.empty()) { path = assetPath.GetAssetPath(); }
-
-    if (path.empty()) { return; }
+    if (_texturePath.empty()) { return; }
+    const auto path =
+        AiNodeIs(_light, domeLightType) &&
+                AiNodeGetStr(_light, formatStr) == latlongStr
+            ? getCachedEnvironmentTexture(_texturePath, _textureMtime)
+            : _texturePath;
     _texture = AiNode(_delegate->GetUniverse(), imageStr);
     AiNodeSetStr(_texture, filenameStr, path.c_str());
     if (hasShader) {
@@ -346,6 +509,8 @@ void HdAiLight::SetupTexture(const VtValue& value) {
     }
 }
 
+AtNode* HdAiLight::GetLightNode() const { return _light; }
+
 HdDirtyBits HdAiLight::GetInitialDirtyBitsMask() const {
     return HdLight::DirtyParams | HdLight::DirtyTransform;
 }
@@ -366,6 +531,7 @@ HdAiLight::HdAiLight(
 }
 
 HdAiLight::~HdAiLight() {
+    _delegate->DeregisterLightLinking(this);
     AiNodeDestroy(_light);
     if (_texture != nullptr) { AiNodeDestroy(_texture); }
 }
@@ -22,6 +22,8 @@
 #include "pxr/imaging/hdAi/renderDelegate.h"
 
 #include <functional>
+#include <string>
+#include <vector>
 
 PXR_NAMESPACE_OPEN_SCOPE
 
@@ -58,6 +60,10 @@ public:
 
     HdDirtyBits GetInitialDirtyBitsMask() const override;
 
+    /// Returns the Arnold light node, which can change during Sync.
+    HDAI_API
+    AtNode* GetLightNode() const;
+
 protected:
     using SyncParams = std::function<void(
         HdAiLight&, AtNode*, const AtNodeEntry*, const SdfPath&,
@@ -72,10 +78,18 @@ protected:
     HDAI_API
     ~HdAiLight() override;
 
+    /// Creates the texture node for the current texture path.
     HDAI_API
-    void SetupTexture(const VtValue& value);
+    void SetupTexture();
 
     SyncParams _syncParams;
+    /// Light parameter values from the last sync, in the order of the
+    /// parameters bound to the light type.
+    std::vector<VtValue> _paramValues;
+    /// Resolved path of the texture file from the last sync.
+    std::string _texturePath;
+    /// Modification time of the texture file from the last sync.
+    double _textureMtime = 0.0;
     HdAiRenderDelegate* _delegate;
     AtNode* _light;
     AtNode* _texture = nullptr;
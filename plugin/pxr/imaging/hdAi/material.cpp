@@ -13,45 +13,496 @@
 // limitations under the License.
 #include "pxr/imaging/hdAi/material.h"
 
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/gf/vec4f.h>
+
+#include <pxr/imaging/hd/changeTracker.h>
+#include <pxr/imaging/hd/renderIndex.h>
+#include <pxr/imaging/hd/sceneDelegate.h>
+
 #include <pxr/usdImaging/usdImaging/tokens.h>
 
+#include "pxr/imaging/hdAi/config.h"
 #include "pxr/imaging/hdAi/debugCodes.h"
 #include "pxr/imaging/hdAi/utils.h"
+#include "pxr/imaging/hdAi/volume.h"
+
+#include "pxr/usd/usdAi/trace.h"
+
+#include <algorithm>
+#include <unordered_set>
 
 PXR_NAMESPACE_OPEN_SCOPE
 
+// clang-format off
+TF_DEFINE_PRIVATE_TOKENS(_tokens,
+    (displacement)
+    (volume)
+    // UsdPreviewSurface nodes and parameters.
+    (UsdPreviewSurface)
+    (UsdUVTexture)
+    (UsdPrimvarReader_float)
+    (UsdPrimvarReader_float2)
+    (UsdPrimvarReader_float3)
+    (UsdPrimvarReader_float4)
+    (UsdPrimvarReader_int)
+    (UsdPrimvarReader_normal)
+    (UsdPrimvarReader_point)
+    (UsdPrimvarReader_vector)
+    (UsdPrimvarReader_string)
+    (diffuseColor)
+    (emissiveColor)
+    (useSpecularWorkflow)
+    (specularColor)
+    (metallic)
+    (roughness)
+    (clearcoat)
+    (clearcoatRoughness)
+    (opacity)
+    (ior)
+    (normal)
+    (file)
+    (st)
+    (uv)
+    (wrapS)
+    (wrapT)
+    (fallback)
+    (scale)
+    (bias)
+    (varname)
+    (black)
+    (clamp)
+    (repeat)
+    (mirror)
+    // Arnold nodes and parameters.
+    (standard_surface)
+    (image)
+    (normal_map)
+    (user_data_float)
+    (user_data_int)
+    (user_data_rgb)
+    (user_data_rgba)
+    (user_data_string)
+    (base)
+    (base_color)
+    (emission)
+    (emission_color)
+    (specular_color)
+    (metalness)
+    (specular_roughness)
+    (coat)
+    (coat_roughness)
+    (specular_IOR)
+    (filename)
+    (uvset)
+    (swrap)
+    (twrap)
+    (periodic)
+    (missing_texture_color)
+    (multiply)
+    (offset)
+    (attribute)
+    (input)
+    (color_to_signed)
+    ((defaultStr, "default"))
+);
+// clang-format on
+
 namespace {
 const AtString nameStr("name");
+
+// Returns true if both networks are made of the same nodes, in which case
+// we can update the existing Arnold nodes in place.
+bool _HasSameNodes(const HdMaterialNetwork& a, const HdMaterialNetwork& b) {
+    if (a.nodes.size() != b.nodes.size()) { return false; }
+    const auto numNodes = a.nodes.size();
+    for (auto i = decltype(numNodes){0}; i < numNodes; ++i) {
+        if (a.nodes[i].path != b.nodes[i].path ||
+            a.nodes[i].identifier != b.nodes[i].identifier) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool _HasRelationship(
+    const std::vector<HdMaterialRelationship>& relationships,
+    const HdMaterialRelationship& relationship) {
+    return std::find_if(
+               relationships.begin(), relationships.end(),
+               [&relationship](const HdMaterialRelationship& r) -> bool {
+                   return r.inputId == relationship.inputId &&
+                          r.inputName == relationship.inputName &&
+                          r.outputId == relationship.outputId &&
+                          r.outputName == relationship.outputName;
+               }) != relationships.end();
+}
+
+// Translation of UsdPreviewSurface networks to built-in Arnold shaders.
+using ValueConversion = VtValue (*)(const VtValue&);
+
+struct ParamRemap {
+    TfToken from;
+    TfToken to;
+    ValueConversion convert;
+};
+
+struct NodeRemap {
+    TfToken to;
+    std::vector<ParamRemap> params;
+    std::vector<std::pair<TfToken, VtValue>> defaults;
+};
+
+VtValue _FloatToRGB(const VtValue& value) {
+    if (value.IsHolding<float>()) {
+        return VtValue(GfVec3f(value.UncheckedGet<float>()));
+    }
+    return value;
+}
+
+VtValue _Vec4ToRGB(const VtValue& value) {
+    if (value.IsHolding<GfVec4f>()) {
+        const auto& v = value.UncheckedGet<GfVec4f>();
+        return VtValue(GfVec3f(v[0], v[1], v[2]));
+    }
+    return value;
+}
+
+VtValue _WrapMode(const VtValue& value) {
+    if (!value.IsHolding<TfToken>()) { return VtValue(_tokens->file); }
+    const auto& mode = value.UncheckedGet<TfToken>();
+    if (mode == _tokens->black || mode == _tokens->clamp ||
+        mode == _tokens->mirror) {
+        return value;
+    }
+    return VtValue(
+        mode == _tokens->repeat ? _tokens->periodic : _tokens->file);
+}
+
+NodeRemap _UserDataRemap(const TfToken& to) {
+    return {to,
+            {{_tokens->varname, _tokens->attribute, nullptr},
+             {_tokens->fallback, _tokens->defaultStr, nullptr}},
+            {}};
+}
+
+const NodeRemap* _FindNodeRemap(const TfToken& identifier) {
+    static const std::unordered_map<TfToken, NodeRemap, TfToken::HashFunctor>
+        remaps{
+            {_tokens->UsdPreviewSurface,
+             {_tokens->standard_surface,
+              {{_tokens->diffuseColor, _tokens->base_color, nullptr},
+               {_tokens->emissiveColor, _tokens->emission_color, nullptr},
+               {_tokens->specularColor, _tokens->specular_color, nullptr},
+               {_tokens->metallic, _tokens->metalness, nullptr},
+               {_tokens->roughness, _tokens->specular_roughness, nullptr},
+               {_tokens->clearcoat, _tokens->coat, nullptr},
+               {_tokens->clearcoatRoughness, _tokens->coat_roughness,
+                nullptr},
+               {_tokens->opacity, _tokens->opacity, _FloatToRGB},
+               {_tokens->ior, _tokens->specular_IOR, nullptr}},
+              // Matching the UsdPreviewSurface defaults.
+              {{_tokens->base, VtValue(1.0f)},
+               {_tokens->base_color, VtValue(GfVec3f(0.18f))},
+               {_tokens->emission, VtValue(1.0f)},
+               {_tokens->emission_color, VtValue(GfVec3f(0.0f))},
+               {_tokens->specular_roughness, VtValue(0.5f)},
+               {_tokens->coat_roughness, VtValue(0.01f)},
+               {_tokens->specular_IOR, VtValue(1.5f)}}}},
+            {_tokens->UsdUVTexture,
+             {_tokens->image,
+              {{_tokens->file, _tokens->filename, nullptr},
+               {_tokens->wrapS, _tokens->swrap, _WrapMode},
+               {_tokens->wrapT, _tokens->twrap, _WrapMode},
+               {_tokens->fallback, _tokens->missing_texture_color, nullptr},
+               {_tokens->scale, _tokens->multiply, _Vec4ToRGB},
+               {_tokens->bias, _tokens->offset, _Vec4ToRGB}},
+              {{_tokens->swrap, VtValue(_tokens->file)},
+               {_tokens->twrap, VtValue(_tokens->file)}}}},
+            {_tokens->UsdPrimvarReader_float,
+             _UserDataRemap(_tokens->user_data_float)},
+            {_tokens->UsdPrimvarReader_float3,
+             _UserDataRemap(_tokens->user_data_rgb)},
+            {_tokens->UsdPrimvarReader_normal,
+             _UserDataRemap(_tokens->user_data_rgb)},
+            {_tokens->UsdPrimvarReader_point,
+             _UserDataRemap(_tokens->user_data_rgb)},
+            {_tokens->UsdPrimvarReader_vector,
+             _UserDataRemap(_tokens->user_data_rgb)},
+            {_tokens->UsdPrimvarReader_float4,
+             _UserDataRemap(_tokens->user_data_rgba)},
+            {_tokens->UsdPrimvarReader_int,
+             _UserDataRemap(_tokens->user_data_int)},
+            {_tokens->UsdPrimvarReader_string,
+             _UserDataRemap(_tokens->user_data_string)},
+        };
+    const auto it = remaps.find(identifier);
+    return it == remaps.end() ? nullptr : &it->second;
+}
+
+TfToken _GetTokenParam(const HdMaterialNode& node, const TfToken& name) {
+    const auto it = node.parameters.find(name);
+    if (it == node.parameters.end()) { return TfToken(); }
+    if (it->second.IsHolding<TfToken>()) {
+        return it->second.UncheckedGet<TfToken>();
+    }
+    if (it->second.IsHolding<std::string>()) {
+        return TfToken(it->second.UncheckedGet<std::string>());
+    }
+    return TfToken();
+}
+
+// The metallic and the specular workflows of UsdPreviewSurface are
+// mutually exclusive, parameters of the unused workflow are ignored.
+bool _IsIgnoredParam(const HdMaterialNode& node, const TfToken& param) {
+    if (node.identifier != _tokens->UsdPreviewSurface) { return false; }
+    const auto it = node.parameters.find(_tokens->useSpecularWorkflow);
+    const auto useSpecularWorkflow = it != node.parameters.end() &&
+                                     it->second.IsHolding<int>() &&
+                                     it->second.UncheckedGet<int>() != 0;
+    return param ==
+           (useSpecularWorkflow ? _tokens->metallic : _tokens->specularColor);
+}
+
+// Rewrites the UsdPreviewSurface and UsdUVTexture nodes to standard_surface
+// and image nodes, and the UsdPrimvarReader nodes to user_data nodes. Nodes
+// we can't translate are left untouched and use the shaders from the
+// usdArnold library, this includes the float2 readers that are not folded
+// into the uvset of a texture, as there is no two component user_data node.
+void _TranslateUsdPreviewNodes(HdMaterialNetwork& network) {
+    using PathSet = std::unordered_set<SdfPath, SdfPath::Hash>;
+    std::unordered_map<SdfPath, const HdMaterialNode*, SdfPath::Hash> nodes;
+    for (const auto& node : network.nodes) { nodes.emplace(node.path, &node); }
+    auto findNode = [&nodes](const SdfPath& path) -> const HdMaterialNode* {
+        const auto it = nodes.find(path);
+        return it == nodes.end() ? nullptr : it->second;
+    };
+
+    // Float2 primvar readers feeding the st of a texture become the uvset of
+    // the image, st and uv are the default uv set on the meshes.
+    std::unordered_map<SdfPath, TfToken, SdfPath::Hash> uvsets;
+    PathSet foldedReaders;
+    std::vector<HdMaterialRelationship> relationships;
+    relationships.reserve(network.relationships.size());
+    for (const auto& relationship : network.relationships) {
+        const auto* inputNode = findNode(relationship.inputId);
+        const auto* outputNode = findNode(relationship.outputId);
+        if (inputNode != nullptr && outputNode != nullptr &&
+            inputNode->identifier == _tokens->UsdPrimvarReader_float2 &&
+            outputNode->identifier == _tokens->UsdUVTexture &&
+            relationship.outputName == _tokens->st) {
+            const auto varname = _GetTokenParam(*inputNode, _tokens->varname);
+            uvsets[outputNode->path] =
+                varname == _tokens->st || varname == _tokens->uv ? TfToken()
+                                                                 : varname;
+            foldedReaders.insert(inputNode->path);
+        } else {
+            relationships.push_back(relationship);
+        }
+    }
+    for (const auto& relationship : relationships) {
+        foldedReaders.erase(relationship.inputId);
+    }
+
+    std::vector<HdMaterialNode> addedNodes;
+    for (auto& relationship : relationships) {
+        const auto* outputNode = findNode(relationship.outputId);
+        if (outputNode == nullptr) { continue; }
+        const auto* remap = _FindNodeRemap(outputNode->identifier);
+        if (remap == nullptr) { continue; }
+        // Tangent space normals go through a normal_map node.
+        if (outputNode->identifier == _tokens->UsdPreviewSurface &&
+            relationship.outputName == _tokens->normal) {
+            HdMaterialNode normalMap;
+            normalMap.path =
+                outputNode->path.AppendChild(_tokens->normal_map);
+            normalMap.identifier = _tokens->normal_map;
+            // UsdUVTexture already remaps the normals via scale and bias.
+            normalMap.parameters[_tokens->color_to_signed] = VtValue(false);
+            addedNodes.push_back(normalMap);
+            relationship.outputId = normalMap.path;
+            relationship.outputName = _tokens->input;
+            continue;
+        }
+        const auto paramIt = std::find_if(
+            remap->params.begin(), remap->params.end(),
+            [&relationship](const ParamRemap& param) -> bool {
+                return param.from == relationship.outputName;
+            });
+        if (paramIt == remap->params.end() ||
+            _IsIgnoredParam(*outputNode, relationship.outputName)) {
+            relationship.outputId = SdfPath();
+        } else {
+            relationship.outputName = paramIt->to;
+        }
+    }
+    for (const auto& node : addedNodes) {
+        HdMaterialRelationship relationship;
+        relationship.inputId = node.path;
+        relationship.outputId = node.path.GetParentPath();
+        relationship.outputName = _tokens->normal;
+        relationships.push_back(relationship);
+    }
+    relationships.erase(
+        std::remove_if(
+            relationships.begin(), relationships.end(),
+            [](const HdMaterialRelationship& relationship) -> bool {
+                return relationship.outputId.IsEmpty();
+            }),
+        relationships.end());
+    network.relationships = std::move(relationships);
+
+    network.nodes.erase(
+        std::remove_if(
+            network.nodes.begin(), network.nodes.end(),
+            [&foldedReaders](const HdMaterialNode& node) -> bool {
+                return foldedReaders.find(node.path) != foldedReaders.end();
+            }),
+        network.nodes.end());
+    for (auto& node : network.nodes) {
+        const auto* remap = _FindNodeRemap(node.identifier);
+        if (remap == nullptr) { continue; }
+        std::map<TfToken, VtValue> parameters;
+        for (const auto& value : remap->defaults) {
+            parameters[value.first] = value.second;
+        }
+        for (const auto& param : remap->params) {
+            const auto it = node.parameters.find(param.from);
+            if (it == node.parameters.end() ||
+                _IsIgnoredParam(node, param.from)) {
+                continue;
+            }
+            parameters[param.to] = param.convert == nullptr
+                                       ? it->second
+                                       : param.convert(it->second);
+        }
+        if (node.identifier == _tokens->UsdPreviewSurface &&
+            _IsIgnoredParam(node, _tokens->metallic)) {
+            // Black is the default specularColor for UsdPreviewSurface.
+            parameters.emplace(_tokens->specular_color, VtValue(GfVec3f(0.0f)));
+        } else if (node.identifier == _tokens->UsdUVTexture) {
+            const auto uvsetIt = uvsets.find(node.path);
+            if (uvsetIt != uvsets.end()) {
+                parameters[_tokens->uvset] = VtValue(uvsetIt->second);
+            }
+        }
+        TF_DEBUG(HDAI_MATERIAL)
+            .Msg(
+                "HdAiMaterial - translating %s from %s to %s\n",
+                node.path.GetText(), node.identifier.GetText(),
+                remap->to.GetText());
+        node.identifier = remap->to;
+        node.parameters = std::move(parameters);
+    }
+    network.nodes.insert(
+        network.nodes.end(), addedNodes.begin(), addedNodes.end());
+}
+
+using AtStringVector = std::vector<AtString>;
+
+// Parameters of the built-in volume shaders, naming the grids they sample.
+const AtStringVector* _GetGridParams(const AtNode* node) {
+    static const std::unordered_map<AtString, AtStringVector, AtStringHash>
+        gridParams{
+            {AtString("standard_volume"),
+             {AtString("density_channel"), AtString("scatter_color_channel"),
+              AtString("transparent_channel"), AtString("emission_channel"),
+              AtString("temperature_channel")}},
+            {AtString("volume_sample_float"), {AtString("channel")}},
+            {AtString("volume_sample_rgb"), {AtString("channel")}},
+        };
+    const auto it = gridParams.find(
+        AiNodeEntryGetNameAtString(AiNodeGetNodeEntry(node)));
+    return it == gridParams.end() ? nullptr : &it->second;
 }
 
+} // namespace
+
 HdAiMaterial::HdAiMaterial(HdAiRenderDelegate* delegate, const SdfPath& id)
     : HdMaterial(id), _delegate(delegate) {
     _surface = _delegate->GetFallbackShader();
 }
 
 HdAiMaterial::~HdAiMaterial() {
-    for (auto& node : _nodes) { AiNodeDestroy(node.second); }
+    for (auto& node : _nodes) { AiNodeDestroy(node.second.node); }
 }
 
 void HdAiMaterial::Sync(
     HdSceneDelegate* sceneDelegate, HdRenderParam* renderParam,
     HdDirtyBits* dirtyBits) {
     auto* param = reinterpret_cast<HdAiRenderParam*>(renderParam);
+    HdAiRenderStats::SyncTimer syncTimer(
+        param->GetStats(), HdAiRenderStats::Material);
     const auto id = GetId();
+    auto* previousSurface = _surface;
+    auto* previousDisplacement = _displacement;
+    auto* previousVolume = _volume;
+    std::unordered_set<std::string> previousGrids;
+    const auto previousHasGrids = GetVolumeGrids(previousGrids);
     if ((*dirtyBits & HdMaterial::DirtyResource) && !id.IsEmpty()) {
-        param->End();
         auto value = sceneDelegate->GetMaterialResource(GetId());
         if (value.IsHolding<HdMaterialNetworkMap>()) {
             const auto& map = value.UncheckedGet<HdMaterialNetworkMap>();
-            const auto* network =
-                TfMapLookupPtr(map.map, UsdImagingTokens->bxdf);
-            if (network != nullptr) {
-                auto* entry = ReadMaterialNetwork(*network);
-                _surface =
-                    entry == nullptr ? _delegate->GetFallbackShader() : entry;
+            const auto& config = HdAiConfig::GetInstance();
+            auto getNetwork = [&map, &config](const TfToken& terminal)
+                -> HdMaterialNetwork {
+                const auto* network = TfMapLookupPtr(map.map, terminal);
+                if (network == nullptr) { return {}; }
+                auto ret = *network;
+                if (config.translate_usd_preview_surface) {
+                    _TranslateUsdPreviewNodes(ret);
+                }
+                return ret;
+            };
+            auto surfaceNetwork = getNetwork(UsdImagingTokens->bxdf);
+            auto displacementNetwork = getNetwork(_tokens->displacement);
+            auto volumeNetwork = getNetwork(_tokens->volume);
+            // Parameter and connection changes are applied while the
+            // render is interrupted, only adding, removing or retyping
+            // nodes requires ending the render.
+            if (_HasSameNodes(_surfaceNetwork, surfaceNetwork) &&
+                _HasSameNodes(_displacementNetwork, displacementNetwork) &&
+                _HasSameNodes(_volumeNetwork, volumeNetwork)) {
+                UpdateMaterialNetwork(_surfaceNetwork, surfaceNetwork, param);
+                UpdateMaterialNetwork(
+                    _displacementNetwork, displacementNetwork, param);
+                UpdateMaterialNetwork(_volumeNetwork, volumeNetwork, param);
+                // Reconnecting nodes can change which one is the terminal.
+                auto* surface = FindNetworkTerminal(surfaceNetwork);
+                _surface = surface == nullptr ? _delegate->GetFallbackShader()
+                                              : surface;
+                _displacement = FindNetworkTerminal(displacementNetwork);
+                _volume = FindNetworkTerminal(volumeNetwork);
+            } else {
+                param->End();
+                SetNodesUnused();
+                auto* surface = ReadMaterialNetwork(surfaceNetwork);
+                _surface = surface == nullptr ? _delegate->GetFallbackShader()
+                                              : surface;
+                _displacement = ReadMaterialNetwork(displacementNetwork);
+                _volume = ReadMaterialNetwork(volumeNetwork);
+                ClearUnusedNodes();
             }
+            _surfaceNetwork = std::move(surfaceNetwork);
+            _displacementNetwork = std::move(displacementNetwork);
+            _volumeNetwork = std::move(volumeNetwork);
         }
     }
+    // Rprims only query the shaders when their material binding is dirty,
+    // and volumes only reload their grids when their fields are dirty.
+    HdDirtyBits boundDirtyBits = HdChangeTracker::Clean;
+    if (_surface != previousSurface || _displacement != previousDisplacement ||
+        _volume != previousVolume) {
+        boundDirtyBits |= HdChangeTracker::DirtyMaterialId;
+    }
+    std::unordered_set<std::string> grids;
+    const auto hasGrids = GetVolumeGrids(grids);
+    if (hasGrids != previousHasGrids || grids != previousGrids) {
+        boundDirtyBits |= HdAiVolume::DirtyFields;
+    }
+    if (boundDirtyBits != HdChangeTracker::Clean) {
+        MarkBoundPrimitivesDirty(sceneDelegate, boundDirtyBits);
+    }
     *dirtyBits = HdMaterial::Clean;
 }
 
@@ -65,62 +516,194 @@ AtNode* HdAiMaterial::GetSurfaceShader() const { return _surface; }
 
 AtNode* HdAiMaterial::GetDisplacementShader() const { return _displacement; }
 
+AtNode* HdAiMaterial::GetVolumeShader() const { return _volume; }
+
+void HdAiMaterial::TrackBoundPrimitive(const SdfPath& id) const {
+    std::lock_guard<std::mutex> lock(_boundPrimitivesMutex);
+    _boundPrimitives.insert(id);
+}
+
+bool HdAiMaterial::GetVolumeGrids(
+    std::unordered_set<std::string>& grids) const {
+    // Volumes use the surface shader if there is no volume shader.
+    const auto& network =
+        _volume == nullptr ? _surfaceNetwork : _volumeNetwork;
+    auto hasGridParams = false;
+    for (const auto& node : network.nodes) {
+        const auto* aiNode = FindMaterial(node.path);
+        if (aiNode == nullptr) { continue; }
+        const auto* params = _GetGridParams(aiNode);
+        if (params == nullptr) { continue; }
+        hasGridParams = true;
+        for (const auto& param : *params) {
+            // We can't tell which grids a connected parameter samples.
+            if (AiNodeIsLinked(aiNode, param)) { return false; }
+            const auto grid = AiNodeGetStr(aiNode, param);
+            if (!grid.empty()) { grids.insert(grid.c_str()); }
+        }
+    }
+    return hasGridParams;
+}
+
 AtNode* HdAiMaterial::ReadMaterialNetwork(const HdMaterialNetwork& network) {
+    USDAI_TRACE_FUNCTION();
     TF_DEBUG(HDAI_MATERIAL)
         .Msg(
             "HdAiMaterial::ReadMaterialNetwork - %s - num nodes: %lu\n",
             GetId().GetText(), network.nodes.size());
     if (network.nodes.empty()) { return nullptr; }
 
-    std::vector<AtNode*> nodes;
-    nodes.reserve(network.nodes.size());
+    for (const auto& node : network.nodes) { ReadMaterial(node); }
+
+    for (const auto& relationship : network.relationships) {
+        LinkMaterial(relationship);
+    }
+
+    return FindNetworkTerminal(network);
+}
+
+AtNode* HdAiMaterial::FindNetworkTerminal(
+    const HdMaterialNetwork& network) const {
     for (const auto& node : network.nodes) {
-        auto* n = ReadMaterial(node);
-        if (n != nullptr) { nodes.push_back(n); }
+        if (std::any_of(
+                network.relationships.begin(), network.relationships.end(),
+                [&node](const HdMaterialRelationship& relationship) -> bool {
+                    return relationship.inputId == node.path;
+                })) {
+            continue;
+        }
+        auto* n = FindMaterial(node.path);
+        if (n != nullptr) { return n; }
     }
+    return nullptr;
+}
 
-    for (const auto& relationship : network.relationships) {
-        auto* inputNode = FindMaterial(relationship.inputId);
-        if (inputNode == nullptr) { continue; }
-        std::remove(nodes.begin(), nodes.end(), inputNode);
-        auto* outputNode = FindMaterial(relationship.outputId);
-        if (outputNode == nullptr) { continue; }
+void HdAiMaterial::MarkBoundPrimitivesDirty(
+    HdSceneDelegate* sceneDelegate, HdDirtyBits dirtyBits) {
+    auto& renderIndex = sceneDelegate->GetRenderIndex();
+    auto& changeTracker = renderIndex.GetChangeTracker();
+    for (auto it = _boundPrimitives.begin(); it != _boundPrimitives.end();) {
+        // Rprims are not untracked when they are removed.
+        if (renderIndex.HasRprim(*it)) {
+            changeTracker.MarkRprimDirty(*it, dirtyBits);
+            ++it;
+        } else {
+            it = _boundPrimitives.erase(it);
+        }
+    }
+}
 
-        // See if the inputName is a single channel we recognize
-        bool usedInputName = false;
-        if (relationship.inputName.size() == 1) {
-            const char* inputName = relationship.inputName.GetText();
-            if (inputName[0] == 'r' || inputName[0] == 'g' ||
-                inputName[0] == 'b' || inputName[0] == 'a' ||
-                inputName[0] == 'x' || inputName[0] == 'y' ||
-                inputName[0] == 'z' || inputName[0] == 'w') {
-                usedInputName = true;
-                TF_DEBUG(HDAI_MATERIAL)
-                    .Msg(
-                        "HdAiMaterial::ReadMaterialNetwork - Linking %s.%s => "
-                        "%s.%s\n",
-                        relationship.inputId.GetText(),
-                        relationship.inputName.GetText(),
-                        relationship.outputId.GetText(),
-                        relationship.outputName.GetText());
-                AiNodeLinkOutput(
-                    inputNode, inputName, outputNode,
-                    relationship.outputName.GetText());
+void HdAiMaterial::UpdateMaterialNetwork(
+    const HdMaterialNetwork& previousNetwork, const HdMaterialNetwork& network,
+    HdAiRenderParam* param) {
+    auto interrupted = false;
+    auto interrupt = [&interrupted, param]() {
+        if (!interrupted) {
+            param->Restart();
+            interrupted = true;
+        }
+    };
+
+    const auto numNodes = network.nodes.size();
+    for (auto i = decltype(numNodes){0}; i < numNodes; ++i) {
+        const auto& previousNode = previousNetwork.nodes[i];
+        const auto& node = network.nodes[i];
+        if (previousNode.parameters == node.parameters) { continue; }
+        auto* n = FindMaterial(node.path);
+        if (n == nullptr) { continue; }
+        const auto* nentry = AiNodeGetNodeEntry(n);
+        for (const auto& parameter : node.parameters) {
+            const auto previousIt =
+                previousNode.parameters.find(parameter.first);
+            if (previousIt != previousNode.parameters.end() &&
+                previousIt->second == parameter.second) {
+                continue;
             }
+            const auto* pentry = AiNodeEntryLookUpParameter(
+                nentry, AtString(parameter.first.GetText()));
+            if (pentry == nullptr) { continue; }
+            TF_DEBUG(HDAI_MATERIAL)
+                .Msg(
+                    "HdAiMaterial::UpdateMaterialNetwork - Updating %s.%s\n",
+                    node.path.GetText(), parameter.first.GetText());
+            interrupt();
+            HdAiSetParameter(n, pentry, parameter.second);
+        }
+        // Parameters that are no longer authored go back to their defaults.
+        for (const auto& parameter : previousNode.parameters) {
+            if (node.parameters.find(parameter.first) !=
+                    node.parameters.end() ||
+                AiNodeEntryLookUpParameter(
+                    nentry, AtString(parameter.first.GetText())) == nullptr) {
+                continue;
+            }
+            interrupt();
+            AiNodeResetParameter(n, parameter.first.GetText());
+        }
+    }
+
+    for (const auto& relationship : previousNetwork.relationships) {
+        if (!_HasRelationship(network.relationships, relationship)) {
+            interrupt();
+            UnlinkMaterial(relationship);
         }
-        if (!usedInputName) {
+    }
+    for (const auto& relationship : network.relationships) {
+        if (!_HasRelationship(previousNetwork.relationships, relationship)) {
+            interrupt();
+            LinkMaterial(relationship);
+        }
+    }
+}
+
+void HdAiMaterial::LinkMaterial(const HdMaterialRelationship& relationship) {
+    auto* inputNode = FindMaterial(relationship.inputId);
+    if (inputNode == nullptr) { return; }
+    auto* outputNode = FindMaterial(relationship.outputId);
+    if (outputNode == nullptr) { return; }
+
+    // See if the inputName is a single channel we recognize
+    bool usedInputName = false;
+    if (relationship.inputName.size() == 1) {
+        const char* inputName = relationship.inputName.GetText();
+        if (inputName[0] == 'r' || inputName[0] == 'g' ||
+            inputName[0] == 'b' || inputName[0] == 'a' ||
+            inputName[0] == 'x' || inputName[0] == 'y' ||
+            inputName[0] == 'z' || inputName[0] == 'w') {
+            usedInputName = true;
             TF_DEBUG(HDAI_MATERIAL)
                 .Msg(
-                    "HdAiMaterial::ReadMaterialNetwork - Linking %s => %s.%s\n",
+                    "HdAiMaterial::LinkMaterial - Linking %s.%s => "
+                    "%s.%s\n",
                     relationship.inputId.GetText(),
+                    relationship.inputName.GetText(),
                     relationship.outputId.GetText(),
                     relationship.outputName.GetText());
-            AiNodeLink(
-                inputNode, relationship.outputName.GetText(), outputNode);
+            AiNodeLinkOutput(
+                inputNode, inputName, outputNode,
+                relationship.outputName.GetText());
         }
     }
+    if (!usedInputName) {
+        TF_DEBUG(HDAI_MATERIAL)
+            .Msg(
+                "HdAiMaterial::LinkMaterial - Linking %s => %s.%s\n",
+                relationship.inputId.GetText(),
+                relationship.outputId.GetText(),
+                relationship.outputName.GetText());
+        AiNodeLink(inputNode, relationship.outputName.GetText(), outputNode);
+    }
+}
 
-    return nodes.empty() ? nullptr : nodes.front();
+void HdAiMaterial::UnlinkMaterial(const HdMaterialRelationship& relationship) {
+    auto* outputNode = FindMaterial(relationship.outputId);
+    if (outputNode == nullptr) { return; }
+    TF_DEBUG(HDAI_MATERIAL)
+        .Msg(
+            "HdAiMaterial::UnlinkMaterial - Unlinking %s.%s\n",
+            relationship.outputId.GetText(),
+            relationship.outputName.GetText());
+    AiNodeUnlink(outputNode, relationship.outputName.GetText());
 }
 
 AtNode* HdAiMaterial::ReadMaterial(const HdMaterialNode& material) {
@@ -136,17 +719,18 @@ AtNode* HdAiMaterial::ReadMaterial(const HdMaterialNode& material) {
     AtNode* ret = nullptr;
     const auto nodeIt = _nodes.find(nodeName);
     if (nodeIt != _nodes.end()) {
-        if (AiNodeEntryGetNameAtString(AiNodeGetNodeEntry(nodeIt->second)) !=
-            nodeType) {
+        if (AiNodeEntryGetNameAtString(
+                AiNodeGetNodeEntry(nodeIt->second.node)) != nodeType) {
             TF_DEBUG(HDAI_MATERIAL)
                 .Msg(
                     "  existing node found, but type mismatch - deleting old "
                     "node\n");
-            AiNodeDestroy(nodeIt->second);
+            AiNodeDestroy(nodeIt->second.node);
             _nodes.erase(nodeIt);
         } else {
             TF_DEBUG(HDAI_MATERIAL).Msg("  existing node found - using it\n");
-            ret = nodeIt->second;
+            ret = nodeIt->second.node;
+            nodeIt->second.used = true;
         }
     }
     if (ret == nullptr) {
@@ -161,7 +745,7 @@ AtNode* HdAiMaterial::ReadMaterial(const HdMaterialNode& material) {
         TF_DEBUG(HDAI_MATERIAL)
             .Msg("  created node of type %s\n", nodeType.c_str());
         AiNodeSetStr(ret, nameStr, nodeName);
-        _nodes.emplace(nodeName, ret);
+        _nodes.emplace(nodeName, MaterialData(ret, true));
     }
 
     const auto* nentry = AiNodeGetNodeEntry(ret);
@@ -177,7 +761,7 @@ AtNode* HdAiMaterial::ReadMaterial(const HdMaterialNode& material) {
 
 AtNode* HdAiMaterial::FindMaterial(const SdfPath& path) const {
     const auto nodeIt = _nodes.find(GetLocalNodeName(path));
-    return nodeIt == _nodes.end() ? nullptr : nodeIt->second;
+    return nodeIt == _nodes.end() ? nullptr : nodeIt->second.node;
 }
 
 AtString HdAiMaterial::GetLocalNodeName(const SdfPath& path) const {
@@ -187,4 +771,26 @@ AtString HdAiMaterial::GetLocalNodeName(const SdfPath& path) const {
     return AtString(p.GetText());
 }
 
+void HdAiMaterial::SetNodesUnused() {
+    for (auto& it : _nodes) { it.second.used = false; }
+}
+
+void HdAiMaterial::ClearUnusedNodes() {
+    size_t numDestroyed = 0;
+    for (auto it = _nodes.begin(); it != _nodes.end();) {
+        if (it->second.used) {
+            ++it;
+        } else {
+            AiNodeDestroy(it->second.node);
+            it = _nodes.erase(it);
+            ++numDestroyed;
+        }
+    }
+    TF_DEBUG(HDAI_MATERIAL)
+        .Msg(
+            "HdAiMaterial::ClearUnusedNodes - %s - live shader nodes: %lu, "
+            "destroyed: %lu\n",
+            GetId().GetText(), _nodes.size(), numDestroyed);
+}
+
 PXR_NAMESPACE_CLOSE_SCOPE
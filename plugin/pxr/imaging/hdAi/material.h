@@ -23,7 +23,10 @@
 
 #include <ai.h>
 
+#include <mutex>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 PXR_NAMESPACE_OPEN_SCOPE
 
@@ -47,24 +50,83 @@ public:
     AtNode* GetSurfaceShader() const;
     HDAI_API
     AtNode* GetDisplacementShader() const;
+    HDAI_API
+    AtNode* GetVolumeShader() const;
+
+    /// Records an rprim using this material, so it can be dirtied when the
+    /// terminal shaders change. This is called from multiple threads.
+    HDAI_API
+    void TrackBoundPrimitive(const SdfPath& id) const;
+
+    /// Collects the grids sampled by the volume shader network. Returns
+    /// false if the grids can't be determined, and all of them have to be
+    /// loaded.
+    HDAI_API
+    bool GetVolumeGrids(std::unordered_set<std::string>& grids) const;
 
 protected:
     HDAI_API
     AtNode* ReadMaterialNetwork(const HdMaterialNetwork& network);
 
+    /// Applies the changed parameter values and connections between two
+    /// networks sharing the same nodes. The render is only interrupted
+    /// if there is anything to update.
+    HDAI_API
+    void UpdateMaterialNetwork(
+        const HdMaterialNetwork& previousNetwork,
+        const HdMaterialNetwork& network, HdAiRenderParam* param);
+
     HDAI_API
     AtNode* ReadMaterial(const HdMaterialNode& node);
 
+    /// Returns the node that is not connected to any other node in the
+    /// network, which is the shader assigned to the terminal.
+    HDAI_API
+    AtNode* FindNetworkTerminal(const HdMaterialNetwork& network) const;
+
+    /// Marks the rprims bound to this material dirty.
+    HDAI_API
+    void MarkBoundPrimitivesDirty(
+        HdSceneDelegate* sceneDelegate, HdDirtyBits dirtyBits);
+
     HDAI_API
     AtNode* FindMaterial(const SdfPath& id) const;
 
+    HDAI_API
+    void LinkMaterial(const HdMaterialRelationship& relationship);
+
+    HDAI_API
+    void UnlinkMaterial(const HdMaterialRelationship& relationship);
+
     HDAI_API
     AtString GetLocalNodeName(const SdfPath& path) const;
 
-    std::unordered_map<AtString, AtNode*, AtStringHash> _nodes;
+    /// Marks every node as unused before reading a material network.
+    HDAI_API
+    void SetNodesUnused();
+
+    /// Destroys the nodes that were not used by the last read networks.
+    HDAI_API
+    void ClearUnusedNodes();
+
+    struct MaterialData {
+        MaterialData(AtNode* _node, bool _used) : node(_node), used(_used) {}
+        AtNode* node = nullptr;
+        bool used = false;
+    };
+
+    std::unordered_map<AtString, MaterialData, AtStringHash> _nodes;
+    HdMaterialNetwork _surfaceNetwork;
+    HdMaterialNetwork _displacementNetwork;
+    HdMaterialNetwork _volumeNetwork;
     HdAiRenderDelegate* _delegate;
     AtNode* _surface = nullptr;
     AtNode* _displacement = nullptr;
+    AtNode* _volume = nullptr;
+    // Rprims are synced on multiple threads after the sprims, so only
+    // adding to the list needs the mutex.
+    mutable std::mutex _boundPrimitivesMutex;
+    mutable std::unordered_set<SdfPath, SdfPath::Hash> _boundPrimitives;
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
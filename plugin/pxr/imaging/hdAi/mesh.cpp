@@ -20,9 +20,13 @@
 
 #include <pxr/imaging/pxOsd/tokens.h>
 
+#include "pxr/usd/usdAi/trace.h"
+
 PXR_NAMESPACE_OPEN_SCOPE
 
-TF_DEFINE_PRIVATE_TOKENS(_tokens, (st)(uv));
+TF_DEFINE_PRIVATE_TOKENS(
+    _tokens, (st)(uv)((dispPadding, "ai:disp_padding"))(
+                 (dispHeight, "ai:disp_height")));
 
 namespace {
 namespace Str {
@@ -36,6 +40,8 @@ const AtString uvlist("uvlist");
 const AtString uvidxs("uvidxs");
 const AtString shader("shader");
 const AtString disp_map("disp_map");
+const AtString disp_padding("disp_padding");
+const AtString disp_height("disp_height");
 const AtString opaque("opaque");
 const AtString subdiv_type("subdiv_type");
 const AtString catclark("catclark");
@@ -46,6 +52,25 @@ const AtString crease_sharpness("crease_sharpness");
 
 } // namespace Str
 
+// Displacement is only evaluated for rays hitting the padded bounds of the
+// mesh, so we take the padding and the height from the AiShapeAPI
+// attributes to keep the BVH tight.
+void _SetDisplacementParams(
+    AtNode* mesh, HdSceneDelegate* delegate, const SdfPath& id) {
+    auto getFloat = [&delegate, &id](
+                        const TfToken& name, float defaultValue) -> float {
+        const auto value = delegate->Get(id, name);
+        if (value.IsHolding<float>()) { return value.UncheckedGet<float>(); }
+        if (value.IsHolding<double>()) {
+            return static_cast<float>(value.UncheckedGet<double>());
+        }
+        return defaultValue;
+    };
+    AiNodeSetFlt(
+        mesh, Str::disp_padding, getFloat(_tokens->dispPadding, 0.0f));
+    AiNodeSetFlt(mesh, Str::disp_height, getFloat(_tokens->dispHeight, 1.0f));
+}
+
 } // namespace
 
 HdAiMesh::HdAiMesh(
@@ -62,7 +87,10 @@ HdAiMesh::~HdAiMesh() { AiNodeDestroy(_mesh); }
 void HdAiMesh::Sync(
     HdSceneDelegate* delegate, HdRenderParam* renderParam,
     HdDirtyBits* dirtyBits, const TfToken& reprToken) {
+    USDAI_TRACE_FUNCTION();
     auto* param = reinterpret_cast<HdAiRenderParam*>(renderParam);
+    HdAiRenderStats::SyncTimer syncTimer(
+        param->GetStats(), HdAiRenderStats::Mesh);
     const auto& id = GetId();
 
     if (HdChangeTracker::IsPrimvarDirty(*dirtyBits, id, HdTokens->points)) {
@@ -135,8 +163,7 @@ void HdAiMesh::Sync(
     }
 
     if (HdChangeTracker::IsTransformDirty(*dirtyBits, id)) {
-        param->End();
-        HdAiSetTransform(_mesh, delegate, GetId());
+        HdAiSetTransform(_mesh, delegate, GetId(), param);
     }
 
     if (HdChangeTracker::IsSubdivTagsDirty(*dirtyBits, id)) {
@@ -192,9 +219,13 @@ void HdAiMesh::Sync(
             delegate->GetRenderIndex().GetSprim(
                 HdPrimTypeTokens->material, delegate->GetMaterialId(id)));
         if (material != nullptr) {
+            material->TrackBoundPrimitive(id);
             AiNodeSetPtr(_mesh, Str::shader, material->GetSurfaceShader());
-            AiNodeSetPtr(
-                _mesh, Str::disp_map, material->GetDisplacementShader());
+            auto* displacement = material->GetDisplacementShader();
+            AiNodeSetPtr(_mesh, Str::disp_map, displacement);
+            if (displacement != nullptr) {
+                _SetDisplacementParams(_mesh, delegate, id);
+            }
             // TODO: We need a way to detect this.
             AiNodeSetBool(_mesh, Str::opaque, false);
         } else {
@@ -203,9 +234,17 @@ void HdAiMesh::Sync(
         }
     }
 
+    if (*dirtyBits & HdChangeTracker::DirtyCategories) {
+        param->End();
+        _delegate->ApplyLightLinking(_mesh, delegate, id);
+    }
+
     // TODO: Implement all the primvars.
     if (*dirtyBits & HdChangeTracker::DirtyPrimvar) {
         param->End();
+        if (AiNodeGetPtr(_mesh, Str::disp_map) != nullptr) {
+            _SetDisplacementParams(_mesh, delegate, id);
+        }
         for (const auto& primvar : delegate->GetPrimvarDescriptors(
                  id, HdInterpolation::HdInterpolationConstant)) {
             HdAiSetConstantPrimvar(_mesh, id, delegate, primvar);
@@ -269,7 +308,8 @@ HdDirtyBits HdAiMesh::GetInitialDirtyBitsMask() const {
     return HdChangeTracker::Clean | HdChangeTracker::InitRepr |
            HdChangeTracker::DirtyPoints | HdChangeTracker::DirtyTopology |
            HdChangeTracker::DirtyTransform | HdChangeTracker::DirtyMaterialId |
-           HdChangeTracker::DirtyPrimvar | HdChangeTracker::DirtyVisibility;
+           HdChangeTracker::DirtyPrimvar | HdChangeTracker::DirtyVisibility |
+           HdChangeTracker::DirtyCategories;
 }
 
 HdDirtyBits HdAiMesh::_PropagateDirtyBits(HdDirtyBits bits) const {
@@ -20,6 +20,8 @@
 #include "pxr/imaging/hdAi/nodes/nodes.h"
 #include "pxr/imaging/hdAi/utils.h"
 
+#include "pxr/usd/usdAi/trace.h"
+
 PXR_NAMESPACE_USING_DIRECTIVE
 
 AI_DRIVER_NODE_EXPORT_METHODS(HdAiDriverMtd);
@@ -42,6 +44,7 @@ struct DriverData {
 tbb::concurrent_queue<HdAiBucketData*> bucketQueue;
 
 void hdAiEmptyBucketQueue(const std::function<void(const HdAiBucketData*)>& f) {
+    USDAI_TRACE_FUNCTION();
     HdAiBucketData* data = nullptr;
     while (bucketQueue.try_pop(data)) {
         if (data) {
@@ -52,6 +55,31 @@ void hdAiEmptyBucketQueue(const std::function<void(const HdAiBucketData*)>& f) {
     }
 }
 
+void hdAiQuantizeBucket(
+    const AtRGBA* in, int xo, int yo, int sizeX, int sizeY, AtRGBA8* out) {
+    const auto bucketSize = sizeX * sizeY;
+    for (auto i = decltype(bucketSize){0}; i < bucketSize; ++i) {
+        const auto& pixel = in[i];
+        const auto x = xo + i % sizeX;
+        const auto y = yo + i / sizeX;
+        auto& o = out[i];
+        o.r = AiQuantize8bit(x, y, 0, pixel.r, true);
+        o.g = AiQuantize8bit(x, y, 1, pixel.g, true);
+        o.b = AiQuantize8bit(x, y, 2, pixel.b, true);
+        o.a = AiQuantize8bit(x, y, 3, pixel.a, true);
+    }
+}
+
+void hdAiProjectDepthBucket(
+    const GfVec3f* in, const GfMatrix4f& viewMtx, const GfMatrix4f& projMtx,
+    int count, float* out) {
+    for (auto i = decltype(count){0}; i < count; ++i) {
+        // Rays hitting the background will return a (0,0,0) vector.
+        const auto p = projMtx.Transform(viewMtx.Transform(in[i]));
+        out[i] = std::max(-1.0f, std::min(1.0f, p[2]));
+    }
+}
+
 node_parameters {
     AiParameterMtx(HdAiDriver::projMtx, AiM4Identity());
     AiParameterMtx(HdAiDriver::viewMtx, AiM4Identity());
@@ -87,6 +115,7 @@ driver_needs_bucket { return true; }
 driver_prepare_bucket {}
 
 driver_process_bucket {
+    USDAI_TRACE_SCOPE("driver_process_bucket");
     const auto* driverData =
         reinterpret_cast<const DriverData*>(AiNodeGetLocalData(node));
     const char* outputName = nullptr;
@@ -102,30 +131,17 @@ driver_process_bucket {
         iterator, &outputName, &pixelType, &bucketData)) {
         if (pixelType == AI_TYPE_RGBA && strcmp(outputName, "RGBA") == 0) {
             data->beauty.resize(bucketSize);
-            const auto* inRGBA = reinterpret_cast<const AtRGBA*>(bucketData);
-            for (auto i = decltype(bucketSize){0}; i < bucketSize; ++i) {
-                const auto in = inRGBA[i];
-                const auto x = bucket_xo + i % bucket_size_x;
-                const auto y = bucket_yo + i / bucket_size_x;
-                AtRGBA8 out;
-                out.r = AiQuantize8bit(x, y, 0, in.r, true);
-                out.g = AiQuantize8bit(x, y, 1, in.g, true);
-                out.b = AiQuantize8bit(x, y, 2, in.b, true);
-                out.a = AiQuantize8bit(x, y, 3, in.a, true);
-                data->beauty[i] = out;
-            }
+            hdAiQuantizeBucket(
+                reinterpret_cast<const AtRGBA*>(bucketData), bucket_xo,
+                bucket_yo, bucket_size_x, bucket_size_y, data->beauty.data());
 
         } else if (
             pixelType == AI_TYPE_VECTOR && strcmp(outputName, "P") == 0) {
             data->depth.resize(bucketSize, 1.0f);
-            const auto* pp = reinterpret_cast<const GfVec3f*>(bucketData);
-            auto* pz = data->depth.data();
-            for (auto i = decltype(bucketSize){0}; i < bucketSize; ++i) {
-                // Rays hitting the background will return a (0,0,0) vector.
-                const auto p = driverData->projMtx.Transform(
-                    driverData->viewMtx.Transform(pp[i]));
-                pz[i] = std::max(-1.0f, std::min(1.0f, p[2]));
-            }
+            hdAiProjectDepthBucket(
+                reinterpret_cast<const GfVec3f*>(bucketData),
+                driverData->viewMtx, driverData->projMtx, bucketSize,
+                data->depth.data());
         }
     }
     if (data->beauty.empty() || data->depth.empty()) {
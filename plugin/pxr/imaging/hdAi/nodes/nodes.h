@@ -14,6 +14,11 @@
 #ifndef HDAI_NODES_H
 #define HDAI_NODES_H
 
+#include <pxr/pxr.h>
+
+#include <pxr/base/gf/matrix4f.h>
+#include <pxr/base/gf/vec3f.h>
+
 #include <ai.h>
 
 #include <functional>
@@ -54,4 +59,13 @@ struct HdAiBucketData {
 
 void hdAiEmptyBucketQueue(const std::function<void(const HdAiBucketData*)>& f);
 
+/// Quantizes the beauty output of a bucket to 8 bits per channel.
+void hdAiQuantizeBucket(
+    const AtRGBA* in, int xo, int yo, int sizeX, int sizeY, AtRGBA8* out);
+
+/// Projects the P output of a bucket to normalized device depth.
+void hdAiProjectDepthBucket(
+    const PXR_NS::GfVec3f* in, const PXR_NS::GfMatrix4f& viewMtx,
+    const PXR_NS::GfMatrix4f& projMtx, int count, float* out);
+
 #endif
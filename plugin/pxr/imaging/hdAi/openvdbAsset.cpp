@@ -16,8 +16,14 @@
 #include <pxr/imaging/hd/renderIndex.h>
 #include <pxr/imaging/hd/sceneDelegate.h>
 
+#include <pxr/usd/sdf/assetPath.h>
+
+#include "pxr/imaging/hdAi/volume.h"
+
 PXR_NAMESPACE_OPEN_SCOPE
 
+TF_DEFINE_PRIVATE_TOKENS(_tokens, (filePath)(fieldName));
+
 HdAiOpenvdbAsset::HdAiOpenvdbAsset(
     HdAiRenderDelegate* delegate, const SdfPath& id)
     : HdField(id) {
@@ -29,13 +35,21 @@ void HdAiOpenvdbAsset::Sync(
     HdDirtyBits* dirtyBits) {
     TF_UNUSED(renderParam);
     if (*dirtyBits & HdField::DirtyParams) {
-        auto& changeTracker =
-            sceneDelegate->GetRenderIndex().GetChangeTracker();
-        // But accessing this list happens on a single thread,
-        // as bprims are synced before rprims.
-        for (const auto& volume : _volumeList) {
-            changeTracker.MarkRprimDirty(
-                volume, HdChangeTracker::DirtyTopology);
+        const auto& id = GetId();
+        const auto filePath = sceneDelegate->Get(id, _tokens->filePath);
+        const auto fieldName = sceneDelegate->Get(id, _tokens->fieldName);
+        // Only the volumes using this field are updated, and only if the
+        // file or the grid changed.
+        if (filePath != _filePath || fieldName != _fieldName) {
+            _filePath = filePath;
+            _fieldName = fieldName;
+            auto& changeTracker =
+                sceneDelegate->GetRenderIndex().GetChangeTracker();
+            // But accessing this list happens on a single thread,
+            // as bprims are synced before rprims.
+            for (const auto& volume : _volumeList) {
+                changeTracker.MarkRprimDirty(volume, HdAiVolume::DirtyFields);
+            }
         }
     }
     *dirtyBits = HdField::Clean;
@@ -50,6 +50,9 @@ private:
     // to store the affected volume prims.
     std::mutex _volumeListMutex;
     std::unordered_set<SdfPath, SdfPath::Hash> _volumeList;
+    /// File path and field name from the last sync.
+    VtValue _filePath;
+    VtValue _fieldName;
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
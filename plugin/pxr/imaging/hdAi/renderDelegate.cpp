@@ -15,6 +15,11 @@
 
 #include <pxr/base/tf/getenv.h>
 
+#ifdef USDAI_ENABLE_TRACE
+#include <pxr/base/trace/collector.h>
+#include <pxr/base/trace/reporter.h>
+#endif
+
 #include <pxr/imaging/glf/glew.h>
 #include <pxr/imaging/hd/bprim.h>
 #include <pxr/imaging/hd/camera.h>
@@ -33,14 +38,27 @@
 #include "pxr/imaging/hdAi/renderPass.h"
 #include "pxr/imaging/hdAi/volume.h"
 
+#include <algorithm>
+#include <fstream>
 #include <unordered_map>
 #include <unordered_set>
 
 PXR_NAMESPACE_OPEN_SCOPE
 
-TF_DEFINE_PRIVATE_TOKENS(_tokens, (openvdbAsset));
+TF_DEFINE_PRIVATE_TOKENS(_tokens,
+    (openvdbAsset)
+    ((useLightGroup, "ai:use_light_group"))
+    ((useShadowGroup, "ai:use_shadow_group"))
+);
 
 namespace {
+namespace Str {
+const AtString use_light_group("use_light_group");
+const AtString light_group("light_group");
+const AtString use_shadow_group("use_shadow_group");
+const AtString shadow_group("shadow_group");
+} // namespace Str
+
 // The following patters might look a bit weird at first glance, but
 // there are two main reasons for doing them.
 //  - Initializing variables when loading the plugin could throw exceptions
@@ -165,6 +183,25 @@ inline const TfTokenVector& _SupportedBprimTypes() {
     return r;
 }
 
+#ifdef USDAI_ENABLE_TRACE
+void _StartTrace() {
+    if (HdAiConfig::GetInstance().trace_file.empty()) { return; }
+    TraceCollector::GetInstance().SetEnabled(true);
+}
+
+void _WriteTrace() {
+    const auto& traceFile = HdAiConfig::GetInstance().trace_file;
+    if (traceFile.empty()) { return; }
+    TraceCollector::GetInstance().SetEnabled(false);
+    std::ofstream out(traceFile);
+    if (!out) {
+        TF_WARN("Can't open trace file %s.", traceFile.c_str());
+        return;
+    }
+    TraceReporter::GetGlobalReporter()->ReportChromeTracing(out);
+}
+#endif
+
 } // namespace
 
 std::mutex HdAiRenderDelegate::_mutexResourceRegistry;
@@ -180,6 +217,9 @@ HdAiRenderDelegate::HdAiRenderDelegate() {
     std::lock_guard<std::mutex> guard(_mutexResourceRegistry);
     if (_counterResourceRegistry.fetch_add(1) == 0) {
         _resourceRegistry.reset(new HdResourceRegistry());
+#ifdef USDAI_ENABLE_TRACE
+        _StartTrace();
+#endif
     }
     AiMsgSetConsoleFlags(AI_LOG_WARNINGS | AI_LOG_ERRORS);
     hdAiInstallNodes();
@@ -213,6 +253,9 @@ HdAiRenderDelegate::~HdAiRenderDelegate() {
     hdAiUninstallNodes();
     AiUniverseDestroy(_universe);
     AiEnd();
+#ifdef USDAI_ENABLE_TRACE
+    if (_counterResourceRegistry.load() == 0) { _WriteTrace(); }
+#endif
 }
 
 HdRenderParam* HdAiRenderDelegate::GetRenderParam() const {
@@ -438,6 +481,47 @@ TfToken HdAiRenderDelegate::GetMaterialBindingPurpose() const {
     return HdTokens->full;
 }
 
+VtDictionary HdAiRenderDelegate::GetRenderStats() const {
+    auto ret = _renderParam->GetRenderStats();
+    // Counting the nodes and the memory used by arrays when the stats are
+    // queried, so this doesn't slow down syncing.
+    VtDictionary nodes;
+    int64_t arrayBytes = 0;
+    auto addArrayBytes = [&arrayBytes](const AtArray* arr) {
+        if (arr == nullptr) { return; }
+        arrayBytes += static_cast<int64_t>(AiArrayGetKeySize(arr)) *
+                      AiArrayGetNumKeys(arr);
+    };
+    auto* nodeIter = AiUniverseGetNodeIterator(_universe, AI_NODE_ALL);
+    while (!AiNodeIteratorFinished(nodeIter)) {
+        auto* node = AiNodeIteratorGetNext(nodeIter);
+        const auto* nentry = AiNodeGetNodeEntry(node);
+        auto& count = nodes[AiNodeEntryGetName(nentry)];
+        count = VtValue(count.GetWithDefault<int64_t>(0) + 1);
+        auto* paramIter = AiNodeEntryGetParamIterator(nentry);
+        while (!AiParamIteratorFinished(paramIter)) {
+            const auto* pentry = AiParamIteratorGetNext(paramIter);
+            if (AiParamGetType(pentry) == AI_TYPE_ARRAY) {
+                addArrayBytes(AiNodeGetArray(node, AiParamGetName(pentry)));
+            }
+        }
+        AiParamIteratorDestroy(paramIter);
+        auto* userParamIter = AiNodeGetUserParamIterator(node);
+        while (!AiUserParamIteratorFinished(userParamIter)) {
+            const auto* userParam = AiUserParamIteratorGetNext(userParamIter);
+            if (AiUserParamGetType(userParam) == AI_TYPE_ARRAY) {
+                addArrayBytes(
+                    AiNodeGetArray(node, AiUserParamGetName(userParam)));
+            }
+        }
+        AiUserParamIteratorDestroy(userParamIter);
+    }
+    AiNodeIteratorDestroy(nodeIter);
+    ret["nodes"] = VtValue(nodes);
+    ret["arrayBytes"] = VtValue(arrayBytes);
+    return ret;
+}
+
 AtString HdAiRenderDelegate::GetLocalNodeName(const AtString& name) const {
     return AtString(_id.AppendChild(TfToken(name.c_str())).GetText());
 }
@@ -450,4 +534,119 @@ AtNode* HdAiRenderDelegate::GetFallbackShader() const {
     return _fallbackShader;
 }
 
+void HdAiRenderDelegate::RegisterLightLinking(
+    HdAiLight* light, const TfToken& lightLink, const TfToken& shadowLink) {
+    std::lock_guard<std::mutex> lock(_lightLinkingMutex);
+    auto it = _lightLinks.find(light);
+    if (it != _lightLinks.end() && it->second.lightLink == lightLink &&
+        it->second.shadowLink == shadowLink) {
+        return;
+    }
+    // Lights without linking only change the groups on the shapes if other
+    // lights use linking.
+    const auto wasLinked = !_lightGroups.empty() || !_shadowGroups.empty();
+    _lightLinks[light] = {lightLink, shadowLink};
+    _UpdateLightGroups();
+    if (wasLinked || !_lightGroups.empty() || !_shadowGroups.empty()) {
+        _lightLinkingChanged = true;
+    }
+}
+
+void HdAiRenderDelegate::DeregisterLightLinking(HdAiLight* light) {
+    std::lock_guard<std::mutex> lock(_lightLinkingMutex);
+    if (_lightLinks.erase(light) == 0) { return; }
+    const auto wasLinked = !_lightGroups.empty() || !_shadowGroups.empty();
+    _UpdateLightGroups();
+    if (wasLinked) { _lightLinkingChanged = true; }
+}
+
+void HdAiRenderDelegate::_UpdateLightGroups() {
+    _lightGroups.clear();
+    _shadowGroups.clear();
+    _resolvedLightGroups.clear();
+    for (const auto& light : _lightLinks) {
+        _lightGroups[light.second.lightLink].push_back(light.first);
+        _shadowGroups[light.second.shadowLink].push_back(light.first);
+    }
+    // Only having lights without linking is the same as not using the
+    // light groups at all.
+    if (_lightGroups.size() == 1 && _lightGroups.begin()->first.IsEmpty()) {
+        _lightGroups.clear();
+    }
+    if (_shadowGroups.size() == 1 && _shadowGroups.begin()->first.IsEmpty()) {
+        _shadowGroups.clear();
+    }
+}
+
+const HdAiRenderDelegate::ResolvedLightGroups&
+HdAiRenderDelegate::_ResolveLightGroups(const TfTokenVector& categories) {
+    auto it = _resolvedLightGroups.find(categories);
+    if (it != _resolvedLightGroups.end()) { return it->second; }
+    auto resolveGroup = [&](const LightGroups& groups,
+                            std::vector<HdAiLight*>& lights) {
+        auto addLights = [&](const TfToken& collection) {
+            const auto it = groups.find(collection);
+            if (it == groups.end()) { return; }
+            lights.insert(lights.end(), it->second.begin(), it->second.end());
+        };
+        addLights(TfToken());
+        for (const auto& category : categories) { addLights(category); }
+    };
+    auto& resolved = _resolvedLightGroups[categories];
+    resolveGroup(_lightGroups, resolved.lights);
+    resolveGroup(_shadowGroups, resolved.shadows);
+    return resolved;
+}
+
+void HdAiRenderDelegate::ApplyLightLinking(
+    AtNode* shape, HdSceneDelegate* delegate, const SdfPath& id) {
+    const auto categoriesArray = delegate->GetCategories(id);
+    TfTokenVector categories(categoriesArray.begin(), categoriesArray.end());
+    std::sort(categories.begin(), categories.end());
+    categories.erase(
+        std::unique(categories.begin(), categories.end()), categories.end());
+    // The AiShapeAPI attributes can disable the light linking collections.
+    // Querying the scene delegate is slow, so it is done before locking.
+    auto isDisabled = [&](const TfToken& useGroup) -> bool {
+        const auto value = delegate->Get(id, useGroup);
+        return value.IsHolding<bool>() && !value.UncheckedGet<bool>();
+    };
+    const auto lightGroupDisabled = isDisabled(_tokens->useLightGroup);
+    const auto shadowGroupDisabled = isDisabled(_tokens->useShadowGroup);
+    std::lock_guard<std::mutex> lock(_lightLinkingMutex);
+    auto applyGroup = [&](bool disabled, const LightGroups& groups,
+                          const std::vector<HdAiLight*>& groupLights,
+                          const AtString& useParam,
+                          const AtString& groupParam) {
+        if (disabled || groups.empty()) {
+            AiNodeSetBool(shape, useParam, false);
+            return;
+        }
+        // Lights replace their nodes when switching between point and spot
+        // lights, so the nodes are looked up every time.
+        std::vector<AtNode*> lights;
+        lights.reserve(groupLights.size());
+        for (auto* light : groupLights) {
+            lights.push_back(light->GetLightNode());
+        }
+        AiNodeSetBool(shape, useParam, true);
+        AiNodeSetArray(
+            shape, groupParam,
+            AiArrayConvert(
+                static_cast<uint32_t>(lights.size()), 1, AI_TYPE_NODE,
+                lights.data()));
+    };
+    const auto& resolved = _ResolveLightGroups(categories);
+    applyGroup(
+        lightGroupDisabled, _lightGroups, resolved.lights,
+        Str::use_light_group, Str::light_group);
+    applyGroup(
+        shadowGroupDisabled, _shadowGroups, resolved.shadows,
+        Str::use_shadow_group, Str::shadow_group);
+}
+
+bool HdAiRenderDelegate::CheckLightLinkingChanged() {
+    return _lightLinkingChanged.exchange(false);
+}
+
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -25,8 +25,16 @@
 
 #include <ai.h>
 
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 PXR_NAMESPACE_OPEN_SCOPE
 
+class HdAiLight;
+
 class HdAiRenderDelegate final : public HdRenderDelegate {
 public:
     HDAI_API
@@ -82,6 +90,8 @@ public:
     void CommitResources(HdChangeTracker* tracker) override;
     HDAI_API
     TfToken GetMaterialBindingPurpose() const override;
+    HDAI_API
+    VtDictionary GetRenderStats() const override;
 
     HDAI_API
     AtString GetLocalNodeName(const AtString& name) const;
@@ -95,6 +105,29 @@ public:
     HDAI_API
     AtNode* GetFallbackShader() const;
 
+    /// Registers the light and shadow linking collections of a light,
+    /// empty collections mean the light affects every shape.
+    HDAI_API
+    void RegisterLightLinking(
+        HdAiLight* light, const TfToken& lightLink, const TfToken& shadowLink);
+
+    /// Removes a light from the light and shadow linking.
+    HDAI_API
+    void DeregisterLightLinking(HdAiLight* light);
+
+    /// Sets the light and shadow groups on a shape from its categories.
+    /// The ai:use_light_group and ai:use_shadow_group attributes of
+    /// AiShapeAPI can disable the groups per shape. The ai:light_group and
+    /// ai:shadow_group relationships are not supported, because
+    /// UsdImagingDelegate does not return relationship targets.
+    HDAI_API
+    void ApplyLightLinking(
+        AtNode* shape, HdSceneDelegate* delegate, const SdfPath& id);
+
+    /// Returns true if the light linking changed since the last call.
+    HDAI_API
+    bool CheckLightLinkingChanged();
+
 private:
     static std::mutex _mutexResourceRegistry;
     static std::atomic_int _counterResourceRegistry;
@@ -107,6 +140,36 @@ private:
     AtUniverse* _universe;
     AtNode* _options;
     AtNode* _fallbackShader;
+
+    struct LightLinks {
+        TfToken lightLink;
+        TfToken shadowLink;
+    };
+    using LightLinksMap = std::unordered_map<HdAiLight*, LightLinks>;
+    using LightGroups = std::unordered_map<
+        TfToken, std::vector<HdAiLight*>, TfToken::HashFunctor>;
+
+    /// Lights affecting a shape with a given set of categories.
+    struct ResolvedLightGroups {
+        std::vector<HdAiLight*> lights;
+        std::vector<HdAiLight*> shadows;
+    };
+
+    void _UpdateLightGroups();
+    /// Returns the lights for a sorted list of categories, the result is
+    /// cached until the light linking changes.
+    const ResolvedLightGroups& _ResolveLightGroups(
+        const TfTokenVector& categories);
+
+    std::mutex _lightLinkingMutex;
+    LightLinksMap _lightLinks;
+    /// Lights grouped by their light linking collection.
+    LightGroups _lightGroups;
+    /// Lights grouped by their shadow linking collection.
+    LightGroups _shadowGroups;
+    /// Resolved groups for each set of categories used by the shapes.
+    std::map<TfTokenVector, ResolvedLightGroups> _resolvedLightGroups;
+    std::atomic<bool> _lightLinkingChanged{false};
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -13,46 +13,129 @@
 // limitations under the License.
 #include "pxr/imaging/hdAi/renderParam.h"
 
+#include "pxr/usd/usdAi/trace.h"
+
 #include <ai.h>
 
 PXR_NAMESPACE_OPEN_SCOPE
 
+namespace {
+const char* primTypeNames[] = {"mesh", "material", "light", "volume"};
+} // namespace
+
+VtDictionary HdAiRenderStats::GetSyncStats() const {
+    VtDictionary ret;
+    for (auto i = 0; i < PrimTypeCount; ++i) {
+        VtDictionary primStats;
+        primStats["count"] =
+            VtValue(_syncCounts[i].load(std::memory_order_relaxed));
+        primStats["seconds"] = VtValue(
+            static_cast<double>(_syncTimes[i].load(std::memory_order_relaxed)) *
+            1e-9);
+        ret[primTypeNames[i]] = VtValue(primStats);
+    }
+    return ret;
+}
+
 bool HdAiRenderParam::Render() {
+    USDAI_TRACE_FUNCTION();
     const auto status = AiRenderGetStatus();
     if (status == AI_RENDER_STATUS_NOT_STARTED) {
+        _RenderStarted();
         AiRenderBegin();
         return false;
     }
     if (status == AI_RENDER_STATUS_PAUSED) {
+        _RenderStarted();
         AiRenderRestart();
         return false;
     }
-    if (status == AI_RENDER_STATUS_FINISHED) { return true; }
+    if (status == AI_RENDER_STATUS_FINISHED) {
+        std::lock_guard<std::mutex> lock(_convergenceMutex);
+        if (!_converged) {
+            _converged = true;
+            _lastConvergenceTime =
+                std::chrono::duration<double>(Clock::now() - _renderStart)
+                    .count();
+        }
+        return true;
+    }
     if (status == AI_RENDER_STATUS_RESTARTING) { return false; }
+    _RenderStarted();
     AiRenderBegin();
     return false;
 }
 
 void HdAiRenderParam::Restart() {
+    USDAI_TRACE_FUNCTION();
     const auto status = AiRenderGetStatus();
     if (status != AI_RENDER_STATUS_NOT_STARTED) {
         if (status == AI_RENDER_STATUS_RENDERING) {
+            _CountRestart();
             AiRenderInterrupt(AI_BLOCKING);
         } else if (status == AI_RENDER_STATUS_FINISHED) {
+            _CountRestart();
+            _RenderStarted();
             AiRenderRestart();
         }
     }
 }
 
 void HdAiRenderParam::End() {
+    USDAI_TRACE_FUNCTION();
     const auto status = AiRenderGetStatus();
     if (status != AI_RENDER_STATUS_NOT_STARTED) {
         if (status == AI_RENDER_STATUS_RENDERING ||
             status == AI_RENDER_STATUS_RESTARTING) {
             AiRenderAbort(AI_BLOCKING);
         }
+        _ends.fetch_add(1, std::memory_order_relaxed);
         AiRenderEnd();
     }
 }
 
+VtDictionary HdAiRenderParam::GetRenderStats() {
+    VtDictionary ret;
+    ret["sync"] = VtValue(_stats.GetSyncStats());
+    ret["restarts"] = VtValue(_restarts.load(std::memory_order_relaxed));
+    ret["ends"] = VtValue(_ends.load(std::memory_order_relaxed));
+    {
+        std::lock_guard<std::mutex> lock(_restartsMutex);
+        _PruneRestarts();
+        ret["restartsLastMinute"] =
+            VtValue(static_cast<int64_t>(_recentRestarts.size()));
+    }
+    {
+        std::lock_guard<std::mutex> lock(_convergenceMutex);
+        ret["converged"] = VtValue(_converged);
+        ret["renderSeconds"] = VtValue(
+            _converged
+                ? _lastConvergenceTime
+                : std::chrono::duration<double>(Clock::now() - _renderStart)
+                      .count());
+    }
+    return ret;
+}
+
+void HdAiRenderParam::_RenderStarted() {
+    _renderStarts.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(_convergenceMutex);
+    _renderStart = Clock::now();
+    _converged = false;
+}
+
+void HdAiRenderParam::_CountRestart() {
+    _restarts.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(_restartsMutex);
+    _recentRestarts.push_back(Clock::now());
+    _PruneRestarts();
+}
+
+void HdAiRenderParam::_PruneRestarts() {
+    const auto minuteAgo = Clock::now() - std::chrono::minutes(1);
+    while (!_recentRestarts.empty() && _recentRestarts.front() < minuteAgo) {
+        _recentRestarts.pop_front();
+    }
+}
+
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -16,10 +16,58 @@
 
 #include <pxr/pxr.h>
 
+#include <pxr/base/vt/dictionary.h>
 #include <pxr/imaging/hd/renderDelegate.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
 PXR_NAMESPACE_OPEN_SCOPE
 
+/// Counters of the render delegate, collected with atomics, so they can be
+/// updated from the sync threads.
+class HdAiRenderStats {
+public:
+    enum PrimType { Mesh = 0, Material, Light, Volume, PrimTypeCount };
+
+    /// Measures the time spent in the scope, and adds it to the sync
+    /// counters of the prim type.
+    class SyncTimer {
+    public:
+        SyncTimer(HdAiRenderStats& stats, PrimType type)
+            : _stats(stats),
+              _type(type),
+              _start(std::chrono::steady_clock::now()) {}
+
+        ~SyncTimer() {
+            _stats.AddSync(
+                _type, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - _start)
+                           .count());
+        }
+
+    private:
+        HdAiRenderStats& _stats;
+        PrimType _type;
+        std::chrono::steady_clock::time_point _start;
+    };
+
+    void AddSync(PrimType type, int64_t nanoseconds) {
+        _syncCounts[type].fetch_add(1, std::memory_order_relaxed);
+        _syncTimes[type].fetch_add(nanoseconds, std::memory_order_relaxed);
+    }
+
+    /// Returns the sync counts and times, keyed by prim type.
+    VtDictionary GetSyncStats() const;
+
+private:
+    std::atomic<int64_t> _syncCounts[PrimTypeCount]{};
+    std::atomic<int64_t> _syncTimes[PrimTypeCount]{};
+};
+
 class HdAiRenderParam final : public HdRenderParam {
 public:
     ~HdAiRenderParam() override = default;
@@ -27,6 +75,39 @@ public:
     bool Render();
     void Restart();
     void End();
+
+    HdAiRenderStats& GetStats() { return _stats; }
+
+    /// Returns the sync, restart and convergence statistics.
+    VtDictionary GetRenderStats();
+
+    /// Returns how many times the render was started or restarted.
+    int64_t GetRenderStarts() const {
+        return _renderStarts.load(std::memory_order_relaxed);
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void _RenderStarted();
+    void _CountRestart();
+    /// Removes the restarts older than a minute, expects the restarts
+    /// mutex to be locked.
+    void _PruneRestarts();
+
+    HdAiRenderStats _stats;
+    std::mutex _restartsMutex;
+    /// Times of the restarts in the last minute.
+    std::deque<Clock::time_point> _recentRestarts;
+    std::atomic<int64_t> _restarts{0};
+    std::atomic<int64_t> _ends{0};
+    std::atomic<int64_t> _renderStarts{0};
+    /// Guards the render start and convergence, which are written by the
+    /// render thread and read when querying the statistics.
+    std::mutex _convergenceMutex;
+    Clock::time_point _renderStart = Clock::now();
+    double _lastConvergenceTime = 0.0;
+    bool _converged = false;
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
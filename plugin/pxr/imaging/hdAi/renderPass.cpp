@@ -17,9 +17,14 @@
  */
 #include "pxr/imaging/hdAi/renderPass.h"
 
+#include <pxr/base/tf/stringUtils.h>
+
+#include <pxr/imaging/hd/changeTracker.h>
+#include <pxr/imaging/hd/renderIndex.h>
 #include <pxr/imaging/hd/renderPassState.h>
 
 #include "pxr/imaging/hdAi/config.h"
+#include "pxr/imaging/hdAi/debugCodes.h"
 #include "pxr/imaging/hdAi/nodes/nodes.h"
 #include "pxr/imaging/hdAi/utils.h"
 
@@ -98,6 +103,14 @@ HdAiRenderPass::~HdAiRenderPass() {
 void HdAiRenderPass::_Execute(
     const HdRenderPassStateSharedPtr& renderPassState,
     const TfTokenVector& renderTags) {
+    // Shapes have to update their light and shadow groups before rendering,
+    // so we skip this iteration and let Hydra sync them.
+    if (_delegate->CheckLightLinkingChanged()) {
+        GetRenderIndex()->GetChangeTracker().MarkAllRprimsDirty(
+            HdChangeTracker::DirtyCategories);
+        _isConverged = false;
+        return;
+    }
     auto* renderParam =
         reinterpret_cast<HdAiRenderParam*>(_delegate->GetRenderParam());
     const auto vp = renderPassState->GetViewport();
@@ -110,6 +123,7 @@ void HdAiRenderPass::_Execute(
         _viewMtx = viewMtx;
         renderParam->Restart();
         restarted = true;
+        _hasBuckets = false;
         AiNodeSetMatrix(
             _camera, Str::matrix, HdAiConvertMatrix(_viewMtx.GetInverse()));
         AiNodeSetMatrix(
@@ -127,6 +141,7 @@ void HdAiRenderPass::_Execute(
     if (width != _width || height != _height) {
         if (!restarted) { renderParam->Restart(); }
         hdAiEmptyBucketQueue([](const HdAiBucketData*) {});
+        _hasBuckets = false;
         const auto oldNumPixels = static_cast<size_t>(_width * _height);
         _width = width;
         _height = height;
@@ -152,7 +167,22 @@ void HdAiRenderPass::_Execute(
         }
     }
 
+    const auto wasConverged = _isConverged;
     _isConverged = renderParam->Render();
+    // Scene changes restart the render from the sync functions, which
+    // invalidates the buckets the same way as the camera changing.
+    const auto renderStarts = renderParam->GetRenderStarts();
+    if (renderStarts != _renderStarts) {
+        _renderStarts = renderStarts;
+        _hasBuckets = false;
+    }
+    if (_isConverged && !wasConverged &&
+        TfDebug::IsEnabled(HDAI_RENDER_STATS)) {
+        TF_DEBUG(HDAI_RENDER_STATS)
+            .Msg(
+                "HdAiRenderPass - render converged: %s\n",
+                TfStringify(_delegate->GetRenderStats()).c_str());
+    }
     bool needsUpdate = false;
     hdAiEmptyBucketQueue([this, &needsUpdate](const HdAiBucketData* data) {
         const auto xo = AiClamp(data->xo, 0, _width - 1);
@@ -178,6 +208,8 @@ void HdAiRenderPass::_Execute(
         }
     });
 
+    if (needsUpdate) { _hasBuckets = true; }
+    if (!_compositorEnabled) { return; }
     // If the buffers are empty, needsUpdate will be false.
     if (needsUpdate) {
         _compositor.UpdateColor(
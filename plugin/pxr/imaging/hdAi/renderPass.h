@@ -39,6 +39,18 @@ public:
 
     bool IsConverged() const { return _isConverged; }
 
+    /// Disables drawing the buckets with OpenGL, so the render pass can run
+    /// without a GL context.
+    void SetCompositorEnabled(bool enabled) { _compositorEnabled = enabled; }
+
+    /// Returns true if a bucket arrived since the render last restarted or
+    /// the buckets were last reset.
+    bool HasBuckets() const { return _hasBuckets; }
+
+    /// Forgets the buckets that arrived so far, so HasBuckets returns false
+    /// until the next bucket.
+    void ResetBuckets() { _hasBuckets = false; }
+
 protected:
     HDAI_API
     void _Execute(
@@ -63,6 +75,9 @@ private:
     int _height = 0;
 
     bool _isConverged = false;
+    bool _compositorEnabled = true;
+    bool _hasBuckets = false;
+    int64_t _renderStarts = 0;
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
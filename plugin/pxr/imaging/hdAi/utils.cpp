@@ -14,9 +14,14 @@
 #include "pxr/imaging/hdAi/utils.h"
 
 #include <pxr/base/gf/vec2f.h>
+#include <pxr/base/tf/smallVector.h>
 
 #include <pxr/usd/sdf/assetPath.h>
 
+#include "pxr/imaging/hdAi/renderParam.h"
+
+#include <cstring>
+
 PXR_NAMESPACE_OPEN_SCOPE
 
 TF_DEFINE_PRIVATE_TOKENS(
@@ -26,6 +31,35 @@ TF_DEFINE_PRIVATE_TOKENS(
 
 namespace {
 
+const AtString _matrixStr("matrix");
+
+// Converting from double to float in a single loop over the contiguous
+// matrix data, which the compiler can vectorize.
+inline void _ConvertMatrices(
+    const GfMatrix4d* in, size_t count, AtMatrix* out) {
+    for (size_t i = 0; i < count; ++i) {
+        const auto* src = in[i].GetArray();
+        auto* dst = &out[i].data[0][0];
+        for (auto j = 0; j < 16; ++j) { dst[j] = static_cast<float>(src[j]); }
+    }
+}
+
+// Returns true if the node already has the same matrix samples, so we can
+// skip allocating a new array and updating the node.
+inline bool _HasSameMatrices(
+    AtNode* node, const AtMatrix* matrices, uint32_t count) {
+    auto* arr = AiNodeGetArray(node, _matrixStr);
+    if (arr == nullptr || AiArrayGetNumElements(arr) != 1 ||
+        AiArrayGetNumKeys(arr) != count ||
+        AiArrayGetType(arr) != AI_TYPE_MATRIX) {
+        return false;
+    }
+    const auto* data = AiArrayMap(arr);
+    const auto same = memcmp(data, matrices, sizeof(AtMatrix) * count) == 0;
+    AiArrayUnmap(arr);
+    return same;
+}
+
 inline bool _Declare(
     AtNode* node, const TfToken& name, const TfToken& scope,
     const TfToken& type) {
@@ -138,23 +172,8 @@ inline void _DeclareAndAssignConstant(
 } // namespace
 
 AtMatrix HdAiConvertMatrix(const GfMatrix4d& in) {
-    AtMatrix out = AI_M4_IDENTITY;
-    out.data[0][0] = static_cast<float>(in[0][0]);
-    out.data[0][1] = static_cast<float>(in[0][1]);
-    out.data[0][2] = static_cast<float>(in[0][2]);
-    out.data[0][3] = static_cast<float>(in[0][3]);
-    out.data[1][0] = static_cast<float>(in[1][0]);
-    out.data[1][1] = static_cast<float>(in[1][1]);
-    out.data[1][2] = static_cast<float>(in[1][2]);
-    out.data[1][3] = static_cast<float>(in[1][3]);
-    out.data[2][0] = static_cast<float>(in[2][0]);
-    out.data[2][1] = static_cast<float>(in[2][1]);
-    out.data[2][2] = static_cast<float>(in[2][2]);
-    out.data[2][3] = static_cast<float>(in[2][3]);
-    out.data[3][0] = static_cast<float>(in[3][0]);
-    out.data[3][1] = static_cast<float>(in[3][1]);
-    out.data[3][2] = static_cast<float>(in[3][2]);
-    out.data[3][3] = static_cast<float>(in[3][3]);
+    AtMatrix out;
+    _ConvertMatrices(&in, 1, &out);
     return out;
 }
 
@@ -200,38 +219,51 @@ GfMatrix4f HdAiConvertMatrix(const AtMatrix& in) {
     return out;
 }
 
-void HdAiSetTransform(
-    AtNode* node, HdSceneDelegate* delegate, const SdfPath& id) {
+bool HdAiSetTransform(
+    AtNode* node, HdSceneDelegate* delegate, const SdfPath& id,
+    HdAiRenderParam* param) {
     // For now this is hardcoded to two samples and 0.0 / 1.0 sample times.
     constexpr size_t maxSamples = 2;
     HdTimeSampleArray<GfMatrix4d, maxSamples> xf;
     delegate->SampleTransform(id, &xf);
-    AtArray* matrices = AiArrayAllocate(1, xf.count, AI_TYPE_MATRIX);
-    for (auto i = decltype(xf.count){0}; i < xf.count; ++i) {
-        AiArraySetMtx(matrices, i, HdAiConvertMatrix(xf.values[i]));
-    }
-    AiNodeSetArray(node, "matrix", matrices);
+    // The scene delegate can return more samples than requested.
+    TfSmallVector<AtMatrix, maxSamples> matrices(xf.count);
+    _ConvertMatrices(xf.values.data(), xf.count, matrices.data());
+    const auto count = static_cast<uint32_t>(xf.count);
+    if (_HasSameMatrices(node, matrices.data(), count)) { return false; }
+    if (param != nullptr) { param->End(); }
+    AiNodeSetArray(
+        node, _matrixStr,
+        AiArrayConvert(1, count, AI_TYPE_MATRIX, matrices.data()));
+    return true;
 }
 
-void HdAiSetTransform(
-    std::vector<AtNode*>& nodes, HdSceneDelegate* delegate, const SdfPath& id) {
+bool HdAiSetTransform(
+    std::vector<AtNode*>& nodes, HdSceneDelegate* delegate, const SdfPath& id,
+    HdAiRenderParam* param) {
     constexpr size_t maxSamples = 3;
     HdTimeSampleArray<GfMatrix4d, maxSamples> xf;
     delegate->SampleTransform(id, &xf);
-    AtArray* matrices = AiArrayAllocate(1, xf.count, AI_TYPE_MATRIX);
-    for (auto i = decltype(xf.count){0}; i < xf.count; ++i) {
-        AiArraySetMtx(matrices, i, HdAiConvertMatrix(xf.values[i]));
-    }
-    const auto nodeCount = nodes.size();
-    if (nodeCount > 0) {
-        // IIRC you can't set the same array on two different nodes,
-        // because it causes a double-free.
-        // TODO: we need to check if it's still the case with Arnold 5.
-        for (auto i = decltype(nodeCount){1}; i < nodeCount; ++i) {
-            AiNodeSetArray(nodes[i], "matrix", AiArrayCopy(matrices));
+    // Converting the samples once for all the nodes.
+    TfSmallVector<AtMatrix, maxSamples> matrices(xf.count);
+    _ConvertMatrices(xf.values.data(), xf.count, matrices.data());
+    const auto count = static_cast<uint32_t>(xf.count);
+    std::vector<AtNode*> changedNodes;
+    for (auto* node : nodes) {
+        if (!_HasSameMatrices(node, matrices.data(), count)) {
+            changedNodes.push_back(node);
         }
-        AiNodeSetArray(nodes[0], "matrix", matrices);
     }
+    if (changedNodes.empty()) { return false; }
+    if (param != nullptr) { param->End(); }
+    // The array is built once for the prim. Nodes take ownership of their
+    // arrays, so the other nodes get copies of it.
+    auto* arr = AiArrayConvert(1, count, AI_TYPE_MATRIX, matrices.data());
+    for (size_t i = 1; i < changedNodes.size(); ++i) {
+        AiNodeSetArray(changedNodes[i], _matrixStr, AiArrayCopy(arr));
+    }
+    AiNodeSetArray(changedNodes.front(), _matrixStr, arr);
+    return true;
 }
 
 void HdAiSetParameter(
@@ -275,7 +307,7 @@ void HdAiSetParameter(
             }
             break;
         case AI_TYPE_RGBA:
-            if (value.IsHolding<GfVec3f>()) {
+            if (value.IsHolding<GfVec4f>()) {
                 const auto& v = value.UncheckedGet<GfVec4f>();
                 AiNodeSetRGBA(node, paramName, v[0], v[1], v[2], v[3]);
             }
@@ -296,6 +328,9 @@ void HdAiSetParameter(
             if (value.IsHolding<TfToken>()) {
                 AiNodeSetStr(
                     node, paramName, value.UncheckedGet<TfToken>().GetText());
+            } else if (value.IsHolding<std::string>()) {
+                AiNodeSetStr(
+                    node, paramName, value.UncheckedGet<std::string>().c_str());
             } else if (value.IsHolding<SdfAssetPath>()) {
                 const auto& assetPath = value.UncheckedGet<SdfAssetPath>();
                 AiNodeSetStr(
@@ -311,7 +346,16 @@ void HdAiSetParameter(
         case AI_TYPE_MATRIX:
             break; // TODO
         case AI_TYPE_ENUM:
-            break; // TODO
+            if (value.IsHolding<int>()) {
+                AiNodeSetInt(node, paramName, value.UncheckedGet<int>());
+            } else if (value.IsHolding<TfToken>()) {
+                AiNodeSetStr(
+                    node, paramName, value.UncheckedGet<TfToken>().GetText());
+            } else if (value.IsHolding<std::string>()) {
+                AiNodeSetStr(
+                    node, paramName, value.UncheckedGet<std::string>().c_str());
+            }
+            break;
         case AI_TYPE_CLOSURE:
             break; // Should be in the relationships list.
         default:
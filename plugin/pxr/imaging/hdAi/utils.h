@@ -30,18 +30,27 @@
 
 PXR_NAMESPACE_OPEN_SCOPE
 
+class HdAiRenderParam;
+
 HDAI_API
 AtMatrix HdAiConvertMatrix(const GfMatrix4d& in);
 HDAI_API
 AtMatrix HdAiConvertMatrix(const GfMatrix4f& in);
 HDAI_API
 GfMatrix4f HdAiConvertMatrix(const AtMatrix& in);
+/// Sets the sampled transform of a prim on a node. The render is ended
+/// through the render param, if one is passed, before the node is modified.
+/// Returns true if the transform changed.
 HDAI_API
-void HdAiSetTransform(
-    AtNode* node, HdSceneDelegate* delegate, const SdfPath& id);
+bool HdAiSetTransform(
+    AtNode* node, HdSceneDelegate* delegate, const SdfPath& id,
+    HdAiRenderParam* param = nullptr);
+/// Sets the sampled transform of a prim on multiple nodes, the same way as
+/// for a single node. Returns true if the transform changed on any node.
 HDAI_API
-void HdAiSetTransform(
-    std::vector<AtNode*>& nodes, HdSceneDelegate* delegate, const SdfPath& id);
+bool HdAiSetTransform(
+    std::vector<AtNode*>& nodes, HdSceneDelegate* delegate, const SdfPath& id,
+    HdAiRenderParam* param = nullptr);
 HDAI_API
 void HdAiSetParameter(
     AtNode* node, const AtParamEntry* pentry, const VtValue& value);
@@ -20,6 +20,9 @@
 #include "pxr/imaging/hdAi/openvdbAsset.h"
 #include "pxr/imaging/hdAi/utils.h"
 
+#include <algorithm>
+#include <unordered_set>
+
 PXR_NAMESPACE_OPEN_SCOPE
 
 TF_DEFINE_PRIVATE_TOKENS(_tokens, (openvdbAsset)(filePath));
@@ -47,37 +50,64 @@ void HdAiVolume::Sync(
     HdDirtyBits* dirtyBits, const TfToken& reprToken) {
     TF_UNUSED(reprToken);
     auto* param = reinterpret_cast<HdAiRenderParam*>(renderParam);
+    HdAiRenderStats::SyncTimer syncTimer(
+        param->GetStats(), HdAiRenderStats::Volume);
 
     const auto& id = GetId();
-    auto volumesChanged = false;
-    if (HdChangeTracker::IsTopologyDirty(*dirtyBits, id)) {
-        param->End();
-        _CreateVolumes(id, delegate);
-        volumesChanged = true;
-    }
-
-    if (volumesChanged || (*dirtyBits & HdChangeTracker::DirtyMaterialId)) {
-        param->End();
+    const auto materialChanged =
+        (*dirtyBits & HdChangeTracker::DirtyMaterialId) != 0;
+    std::vector<AtNode*> createdVolumes;
+    // The grids loaded depend on the shader, so the volumes are updated
+    // when the material changes.
+    if (HdChangeTracker::IsTopologyDirty(*dirtyBits, id) ||
+        (*dirtyBits & DirtyFields) || materialChanged) {
         const auto* material = reinterpret_cast<const HdAiMaterial*>(
             delegate->GetRenderIndex().GetSprim(
                 HdPrimTypeTokens->material, delegate->GetMaterialId(id)));
+        _UpdateVolumes(id, delegate, material, param, createdVolumes);
         if (material != nullptr) {
-            auto* surfaceShader = material->GetSurfaceShader();
-            for (auto& volume : _volumes) {
-                AiNodeSetPtr(volume, Str::shader, surfaceShader);
+            material->TrackBoundPrimitive(id);
+            // Volume materials can either use the volume terminal, or put
+            // the volume shader on the surface terminal.
+            auto* volumeShader = material->GetVolumeShader();
+            if (volumeShader == nullptr) {
+                volumeShader = material->GetSurfaceShader();
+            }
+            if (materialChanged) { param->End(); }
+            for (auto& volume : materialChanged ? _volumes : createdVolumes) {
+                AiNodeSetPtr(volume, Str::shader, volumeShader);
             }
         }
     }
 
     if (HdChangeTracker::IsTransformDirty(*dirtyBits, id)) {
+        HdAiSetTransform(_volumes, delegate, GetId(), param);
+    } else if (!createdVolumes.empty()) {
+        HdAiSetTransform(createdVolumes, delegate, GetId());
+    }
+
+    if (*dirtyBits & HdChangeTracker::DirtyCategories) {
         param->End();
-        HdAiSetTransform(_volumes, delegate, GetId());
+        for (auto& volume : _volumes) {
+            _delegate->ApplyLightLinking(volume, delegate, id);
+        }
+    } else {
+        for (auto& volume : createdVolumes) {
+            _delegate->ApplyLightLinking(volume, delegate, id);
+        }
     }
 
     *dirtyBits = HdChangeTracker::Clean;
 }
 
-void HdAiVolume::_CreateVolumes(const SdfPath& id, HdSceneDelegate* delegate) {
+void HdAiVolume::_UpdateVolumes(
+    const SdfPath& id, HdSceneDelegate* delegate, const HdAiMaterial* material,
+    HdAiRenderParam* param, std::vector<AtNode*>& createdVolumes) {
+    // Only loading the grids sampled by the shader, if we can tell which
+    // ones those are.
+    std::unordered_set<std::string> grids;
+    const auto pruneGrids =
+        material != nullptr && material->GetVolumeGrids(grids);
     std::unordered_map<std::string, std::vector<TfToken>> openvdbs;
     const auto fieldDescriptors = delegate->GetVolumeFieldDescriptors(id);
     for (const auto& field : fieldDescriptors) {
@@ -99,27 +129,59 @@ void HdAiVolume::_CreateVolumes(const SdfPath& id, HdSceneDelegate* delegate) {
         }
     }
 
-    _volumes.erase(
-        std::remove_if(
-            _volumes.begin(), _volumes.end(),
-            [&openvdbs](AtNode* node) -> bool {
-                if (openvdbs.find(std::string(
-                        AiNodeGetStr(node, Str::filename).c_str())) ==
-                    openvdbs.end()) {
-                    AiNodeDestroy(node);
-                    return true;
-                }
-                return false;
-            }),
-        _volumes.end());
+    if (pruneGrids) {
+        for (auto& openvdb : openvdbs) {
+            auto usedFields = openvdb.second;
+            usedFields.erase(
+                std::remove_if(
+                    usedFields.begin(), usedFields.end(),
+                    [&grids](const TfToken& field) -> bool {
+                        return grids.find(field.GetString()) == grids.end();
+                    }),
+                usedFields.end());
+            // The shader doesn't sample any grids of this file, so we
+            // don't know what it expects.
+            if (!usedFields.empty()) { openvdb.second = std::move(usedFields); }
+        }
+    }
 
+    // Volume nodes that keep their file and grids are left untouched, so
+    // Arnold doesn't have to reload them. Nodes of files that are no
+    // longer used are reused for the new files.
+    std::vector<AtNode*> unusedVolumes;
+    for (auto* volume : _volumes) {
+        const std::string filename(AiNodeGetStr(volume, Str::filename).c_str());
+        if (openvdbs.find(filename) == openvdbs.end()) {
+            unusedVolumes.push_back(volume);
+            _volumeGrids.erase(filename);
+        }
+    }
+    auto ended = false;
+    auto endRender = [&]() {
+        if (!ended) {
+            param->End();
+            ended = true;
+        }
+    };
     for (const auto& openvdb : openvdbs) {
+        auto gridsIt = _volumeGrids.find(openvdb.first);
+        if (gridsIt != _volumeGrids.end() &&
+            gridsIt->second == openvdb.second) {
+            continue;
+        }
+        endRender();
         AtNode* volume = nullptr;
-        for (auto& v : _volumes) {
-            if (openvdb.first == AiNodeGetStr(v, Str::filename).c_str()) {
-                volume = v;
-                break;
+        if (gridsIt != _volumeGrids.end()) {
+            for (auto* v : _volumes) {
+                if (openvdb.first == AiNodeGetStr(v, Str::filename).c_str()) {
+                    volume = v;
+                    break;
+                }
             }
+        } else if (!unusedVolumes.empty()) {
+            volume = unusedVolumes.back();
+            unusedVolumes.pop_back();
+            AiNodeSetStr(volume, Str::filename, openvdb.first.c_str());
         }
         if (volume == nullptr) {
             volume = AiNode(_delegate->GetUniverse(), Str::volume);
@@ -129,6 +191,7 @@ void HdAiVolume::_CreateVolumes(const SdfPath& id, HdSceneDelegate* delegate) {
                 id.AppendChild(TfToken(TfStringPrintf("p_%p", volume)))
                     .GetText());
             _volumes.push_back(volume);
+            createdVolumes.push_back(volume);
         }
         const auto numFields = openvdb.second.size();
         auto* fields = AiArrayAllocate(numFields, 1, AI_TYPE_STRING);
@@ -136,6 +199,14 @@ void HdAiVolume::_CreateVolumes(const SdfPath& id, HdSceneDelegate* delegate) {
             AiArraySetStr(fields, i, AtString(openvdb.second[i].GetText()));
         }
         AiNodeSetArray(volume, Str::grids, fields);
+        _volumeGrids[openvdb.first] = openvdb.second;
+    }
+
+    if (unusedVolumes.empty()) { return; }
+    endRender();
+    for (auto* volume : unusedVolumes) {
+        _volumes.erase(std::find(_volumes.begin(), _volumes.end(), volume));
+        AiNodeDestroy(volume);
     }
 }
 
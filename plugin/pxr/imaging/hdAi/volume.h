@@ -23,10 +23,14 @@
 
 #include <ai.h>
 
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 PXR_NAMESPACE_OPEN_SCOPE
 
+class HdAiMaterial;
+
 class HdAiVolume : public HdVolume {
 public:
     HDAI_API
@@ -44,6 +48,10 @@ public:
     HDAI_API
     HdDirtyBits GetInitialDirtyBitsMask() const override;
 
+    /// Set by the fields when their file or grid name changes.
+    static constexpr HdDirtyBits DirtyFields =
+        HdChangeTracker::CustomBitsBegin;
+
 protected:
     HDAI_API
     HdDirtyBits _PropagateDirtyBits(HdDirtyBits bits) const override;
@@ -51,11 +59,18 @@ protected:
     HDAI_API
     void _InitRepr(const TfToken& reprToken, HdDirtyBits* dirtyBits) override;
 
+    /// Creates, updates or removes the volume nodes to match the fields of
+    /// the volume, touching only the nodes whose file or grids changed.
     HDAI_API
-    void _CreateVolumes(const SdfPath& id, HdSceneDelegate* delegate);
+    void _UpdateVolumes(
+        const SdfPath& id, HdSceneDelegate* delegate,
+        const HdAiMaterial* material, HdAiRenderParam* param,
+        std::vector<AtNode*>& createdVolumes);
 
     HdAiRenderDelegate* _delegate;
     std::vector<AtNode*> _volumes;
+    /// Grids set on the volume nodes, keyed by the filename of the node.
+    std::unordered_map<std::string, std::vector<TfToken>> _volumeGrids;
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -17,9 +17,6 @@
 #include <pxr/base/tf/staticTokens.h>
 #include <pxr/base/tf/stringUtils.h>
 
-#include <pxr/usd/usd/prim.h>
-#include <pxr/usd/usd/primRange.h>
-
 #include "pxr/usd/usdAi/tokens.h"
 
 #include "pxr/usd/ndrAi/utils.h"
@@ -30,7 +27,8 @@
 
 PXR_NAMESPACE_OPEN_SCOPE
 
-TF_DEFINE_PRIVATE_TOKENS(_tokens, (shader)(arnold));
+TF_DEFINE_PRIVATE_TOKENS(
+    _tokens, (shader)(arnold)((dontDiscover, "ndrai_dont_discover")));
 
 NDR_REGISTER_DISCOVERY_PLUGIN(NdrAiDiscoveryPlugin);
 
@@ -41,11 +39,22 @@ NdrAiDiscoveryPlugin::~NdrAiDiscoveryPlugin() {}
 NdrNodeDiscoveryResultVec NdrAiDiscoveryPlugin::DiscoverNodes(
     const Context& context) {
     NdrNodeDiscoveryResultVec ret;
-    auto shaderDefs = NdrAiGetShaderDefs();
-    for (const UsdPrim& prim : shaderDefs->Traverse()) {
-        const auto shaderName = prim.GetName();
-        TfToken filename("<built-in>");
-        prim.GetMetadata(UsdAiTokens->filename, &filename);
+    const auto& shaderIndex = NdrAiGetShaderIndex();
+    ret.reserve(shaderIndex.size());
+    // Only reading the prim metadata here, parameters are parsed on demand
+    // by the parser plugin.
+    for (const auto& it : shaderIndex) {
+        const auto& shaderName = it.first;
+        const auto& primSpec = it.second;
+        if (VtDictionaryGet<bool>(
+                NdrAiGetNodeMetadata(primSpec),
+                _tokens->dontDiscover.GetString(), VtDefault = false)) {
+            continue;
+        }
+        const auto filenameValue = primSpec->GetInfo(UsdAiTokens->filename);
+        const auto filename = filenameValue.IsHolding<TfToken>()
+                                  ? filenameValue.UncheckedGet<TfToken>()
+                                  : TfToken("<built-in>");
         ret.emplace_back(
             NdrIdentifier(
                 TfStringPrintf("ai:%s", shaderName.GetText())),    // identifier
@@ -11,32 +11,199 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
-/*
- * TODO:
- *  - Properly parse type and array size.
- *  - Generate output types based on shader output type.
- * */
 #include "pxr/usd/ndrAi/aiParser.h"
 
 #include <pxr/base/tf/staticTokens.h>
+#include <pxr/base/tf/stringUtils.h>
+#include <pxr/base/vt/types.h>
 
 #include <pxr/usd/ndr/node.h>
 
 #include <pxr/usd/sdr/shaderNode.h>
 #include <pxr/usd/sdr/shaderProperty.h>
 
-#include <pxr/usd/sdf/propertySpec.h>
+#include <pxr/usd/sdf/attributeSpec.h>
+#include <pxr/usd/sdf/schema.h>
 
-#include <pxr/usd/usd/attribute.h>
-#include <pxr/usd/usd/property.h>
+#include "pxr/usd/usdAi/aiNodeAPI.h"
+#include "pxr/usd/usdAi/tokens.h"
 
 #include "pxr/usd/ndrAi/utils.h"
 
+#include <ai.h>
+
+#include <algorithm>
+#include <unordered_map>
+
 PXR_NAMESPACE_OPEN_SCOPE
 
 NDR_REGISTER_PARSER_PLUGIN(NdrAiParserPlugin);
 
-TF_DEFINE_PRIVATE_TOKENS(_tokens, (arnold)(binary));
+TF_DEFINE_PRIVATE_TOKENS(
+    _tokens, (arnold)(binary)(out)(desc)(linkable)(label)(page)(widget));
+
+namespace {
+
+using MetadataMap =
+    std::unordered_map<TfToken, NdrTokenMap, TfToken::HashFunctor>;
+
+// Converts Arnold metadata to Sdr metadata, renaming the entries that have
+// an Sdr equivalent and keeping the rest as they are.
+void _AddMetadata(
+    const TfToken& name, const VtValue& value, NdrTokenMap& metadata) {
+    auto sdrName = name;
+    if (name == _tokens->desc) {
+        sdrName = SdrPropertyMetadata->Help;
+    } else if (name == _tokens->linkable) {
+        sdrName = SdrPropertyMetadata->Connectable;
+    } else if (name == _tokens->label) {
+        sdrName = SdrPropertyMetadata->Label;
+    } else if (name == _tokens->page) {
+        sdrName = SdrPropertyMetadata->Page;
+    } else if (name == _tokens->widget) {
+        sdrName = SdrPropertyMetadata->Widget;
+    }
+    metadata[sdrName] = TfStringify(value);
+}
+
+// Returns the Sdr type for an Arnold parameter type, and sets arraySize for
+// the types Sdr represents as fixed size float arrays. Returns an empty
+// token for types that can't be represented.
+TfToken _GetSdrType(int paramType, int& arraySize) {
+    arraySize = 0;
+    switch (paramType) {
+        case AI_TYPE_BYTE:
+        case AI_TYPE_INT:
+        case AI_TYPE_UINT:
+        case AI_TYPE_USHORT:
+        case AI_TYPE_BOOLEAN:
+            return SdrPropertyTypes->Int;
+        case AI_TYPE_FLOAT:
+        case AI_TYPE_HALF:
+            return SdrPropertyTypes->Float;
+        case AI_TYPE_RGB:
+            return SdrPropertyTypes->Color;
+        case AI_TYPE_RGBA:
+            arraySize = 4;
+            return SdrPropertyTypes->Float;
+        case AI_TYPE_VECTOR:
+            return SdrPropertyTypes->Vector;
+        case AI_TYPE_VECTOR2:
+            arraySize = 2;
+            return SdrPropertyTypes->Float;
+        case AI_TYPE_STRING:
+        case AI_TYPE_ENUM:
+            return SdrPropertyTypes->String;
+        case AI_TYPE_MATRIX:
+            return SdrPropertyTypes->Matrix;
+        case AI_TYPE_NODE:
+        case AI_TYPE_CLOSURE:
+            return SdrPropertyTypes->Terminal;
+        default:
+            return TfToken();
+    }
+}
+
+template <typename T>
+bool _ConvertToIntArray(const VtValue& value, VtValue& out) {
+    if (!value.IsHolding<VtArray<T>>()) { return false; }
+    const auto& in = value.UncheckedGet<VtArray<T>>();
+    VtIntArray ret(in.size());
+    std::transform(in.begin(), in.end(), ret.begin(), [](const T& v) -> int {
+        return static_cast<int>(v);
+    });
+    out = VtValue(ret);
+    return true;
+}
+
+// Sdr ints are plain ints, but booleans and the unsigned Arnold types are
+// authored with their own value types.
+VtValue _GetSdrDefault(const VtValue& value, const TfToken& type) {
+    if (type != SdrPropertyTypes->Int) { return value; }
+    if (value.IsHolding<bool>()) {
+        return VtValue(value.UncheckedGet<bool>() ? 1 : 0);
+    }
+    if (value.IsHolding<unsigned char>()) {
+        return VtValue(static_cast<int>(value.UncheckedGet<unsigned char>()));
+    }
+    if (value.IsHolding<unsigned int>()) {
+        return VtValue(static_cast<int>(value.UncheckedGet<unsigned int>()));
+    }
+    VtValue ret;
+    if (_ConvertToIntArray<bool>(value, ret) ||
+        _ConvertToIntArray<unsigned char>(value, ret) ||
+        _ConvertToIntArray<unsigned int>(value, ret)) {
+        return ret;
+    }
+    return value;
+}
+
+int _GetParamType(const SdfSpecHandle& spec, const TfToken& field) {
+    const auto value = spec->GetInfo(field);
+    return value.IsHolding<TfToken>()
+               ? UsdAiNodeAPI::GetParamTypeFromToken(
+                     value.UncheckedGet<TfToken>())
+               : AI_TYPE_UNDEFINED;
+}
+
+SdrShaderPropertyUniquePtr _ParseParameter(
+    const SdfAttributeSpecHandle& attrSpec, NdrTokenMap metadata) {
+    auto paramType = _GetParamType(attrSpec, UsdAiTokens->paramType);
+    if (paramType == AI_TYPE_ARRAY) {
+        // Arnold arrays are always resizable.
+        paramType = _GetParamType(attrSpec, UsdAiTokens->elemType);
+        metadata[SdrPropertyMetadata->IsDynamicArray] = "1";
+    }
+    auto arraySize = 0;
+    const auto type = _GetSdrType(paramType, arraySize);
+    if (type.IsEmpty()) { return nullptr; }
+    const auto customData = attrSpec->GetInfo(SdfFieldKeys->CustomData);
+    if (customData.IsHolding<VtDictionary>()) {
+        const auto arnoldMetadata = VtDictionaryGet<VtDictionary>(
+            customData.UncheckedGet<VtDictionary>(),
+            UsdAiTokens->arnoldMetadata.GetString(),
+            VtDefault = VtDictionary());
+        for (const auto& entry : arnoldMetadata) {
+            _AddMetadata(TfToken(entry.first), entry.second, metadata);
+        }
+    }
+    NdrOptionVec options;
+    const auto enumValues = attrSpec->GetInfo(UsdAiTokens->enumValues);
+    if (enumValues.IsHolding<VtTokenArray>()) {
+        for (const auto& enumValue : enumValues.UncheckedGet<VtTokenArray>()) {
+            options.emplace_back(enumValue, TfToken());
+        }
+    }
+    return SdrShaderPropertyUniquePtr(new SdrShaderProperty(
+        attrSpec->GetNameToken(),                           // name
+        type,                                               // type
+        _GetSdrDefault(attrSpec->GetDefaultValue(), type),  // defaultValue
+        false,                                              // isOutput
+        arraySize,                                          // arraySize
+        metadata,                                           // metadata
+        NdrTokenMap(),                                      // hints
+        options                                             // options
+        ));
+}
+
+SdrShaderPropertyUniquePtr _ParseOutput(const SdfPrimSpecHandle& primSpec) {
+    const auto outputType = _GetParamType(primSpec, UsdAiTokens->outputType);
+    auto arraySize = 0;
+    const auto type = _GetSdrType(outputType, arraySize);
+    if (type.IsEmpty()) { return nullptr; }
+    return SdrShaderPropertyUniquePtr(new SdrShaderProperty(
+        _tokens->out,  // name
+        type,          // type
+        VtValue(),     // defaultValue
+        true,          // isOutput
+        arraySize,     // arraySize
+        NdrTokenMap(), // metadata
+        NdrTokenMap(), // hints
+        NdrOptionVec() // options
+        ));
+}
+
+} // namespace
 
 NdrAiParserPlugin::NdrAiParserPlugin() {}
 
@@ -44,33 +211,50 @@ NdrAiParserPlugin::~NdrAiParserPlugin() {}
 
 NdrNodeUniquePtr NdrAiParserPlugin::Parse(
     const NdrNodeDiscoveryResult& discoveryResult) {
-    auto shaderDefs = NdrAiGetShaderDefs();
-    auto prim = shaderDefs->GetPrimAtPath(SdfPath(
-        TfStringPrintf("/%s", discoveryResult.identifier.GetText() + 3)));
-    if (!prim) { return nullptr; }
+    const auto& shaderIndex = NdrAiGetShaderIndex();
+    const auto it = shaderIndex.find(TfToken(discoveryResult.name));
+    if (it == shaderIndex.end()) { return nullptr; }
+    const auto& primSpec = it->second;
+    const auto attributes = primSpec->GetAttributes();
+
+    // Metadata of the parameters are either stored in their customData, or
+    // in namespaced attributes named <parameter>:<metadata>.
+    MetadataMap paramMetadata;
+    for (const auto& attrSpec : attributes) {
+        const auto attrName = attrSpec->GetName();
+        const auto colonPos = attrName.find(':');
+        if (colonPos == std::string::npos ||
+            TfStringStartsWith(attrName, "info:")) {
+            continue;
+        }
+        auto metaName = attrName.substr(colonPos + 1);
+        std::replace(metaName.begin(), metaName.end(), ':', '.');
+        _AddMetadata(
+            TfToken(metaName), attrSpec->GetDefaultValue(),
+            paramMetadata[TfToken(attrName.substr(0, colonPos))]);
+    }
+
     NdrPropertyUniquePtrVec properties;
-    const auto props = prim.GetAuthoredProperties();
-    properties.reserve(props.size());
-    for (const auto& property : props) {
-        const auto& propertyName = property.GetName();
-        if (TfStringContains(propertyName.GetString(), ":")) { continue; }
-        const auto propertyStack = property.GetPropertyStack();
-        if (propertyStack.empty()) { continue; }
-        const auto attr = prim.GetAttribute(propertyName);
-        VtValue v;
-        attr.Get(&v);
-        properties.emplace_back(
-            SdrShaderPropertyUniquePtr(new SdrShaderProperty(
-                propertyName,                                 // name
-                propertyStack[0]->GetTypeName().GetAsToken(), // type
-                v,                                            // defaultValue
-                false,                                        // isOutput
-                0,                                            // arraySize
-                NdrTokenMap(),                                // metadata
-                NdrTokenMap(),                                // hints
-                NdrOptionVec()                                // options
-                )));
+    properties.reserve(attributes.size() + 1);
+    for (const auto& attrSpec : attributes) {
+        const auto& attrName = attrSpec->GetNameToken();
+        if (TfStringContains(attrName.GetString(), ":")) { continue; }
+        const auto metadata = paramMetadata.find(attrName);
+        auto property = _ParseParameter(
+            attrSpec, metadata == paramMetadata.end() ? NdrTokenMap()
+                                                      : metadata->second);
+        if (property != nullptr) {
+            properties.emplace_back(std::move(property));
+        }
+    }
+    auto output = _ParseOutput(primSpec);
+    if (output != nullptr) { properties.emplace_back(std::move(output)); }
+
+    NdrTokenMap nodeMetadata;
+    for (const auto& entry : NdrAiGetNodeMetadata(primSpec)) {
+        _AddMetadata(TfToken(entry.first), entry.second, nodeMetadata);
     }
+
     return NdrNodeUniquePtr(new SdrShaderNode(
         discoveryResult.identifier,    // identifier
         discoveryResult.version,       // version
@@ -79,7 +263,8 @@ NdrNodeUniquePtr NdrAiParserPlugin::Parse(
         discoveryResult.discoveryType, // context
         discoveryResult.sourceType,    // sourceType
         discoveryResult.uri,           // uri
-        std::move(properties)));
+        std::move(properties),         // properties
+        nodeMetadata));                // metadata
 }
 
 const NdrTokenVec& NdrAiParserPlugin::GetDiscoveryTypes() const {
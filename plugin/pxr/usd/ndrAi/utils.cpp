@@ -13,8 +13,11 @@
 // limitations under the License.
 #include "pxr/usd/ndrAi/utils.h"
 
+#include "pxr/usd/usdAi/tokens.h"
 #include "pxr/usd/usdAi/utils.h"
 
+#include <pxr/usd/sdf/schema.h>
+
 PXR_NAMESPACE_OPEN_SCOPE
 
 UsdStageRefPtr NdrAiGetShaderDefs() {
@@ -24,4 +27,27 @@ UsdStageRefPtr NdrAiGetShaderDefs() {
     return cache;
 }
 
+const NdrAiShaderIndex& NdrAiGetShaderIndex() {
+    static const auto index = []() -> NdrAiShaderIndex {
+        NdrAiShaderIndex ret;
+        auto shaderDefs = NdrAiGetShaderDefs();
+        if (shaderDefs == nullptr) { return ret; }
+        const auto rootPrims = shaderDefs->GetRootLayer()->GetRootPrims();
+        ret.reserve(rootPrims.size());
+        for (const auto& primSpec : rootPrims) {
+            ret.emplace(primSpec->GetNameToken(), primSpec);
+        }
+        return ret;
+    }();
+    return index;
+}
+
+VtDictionary NdrAiGetNodeMetadata(const SdfPrimSpecHandle& primSpec) {
+    const auto customData = primSpec->GetInfo(SdfFieldKeys->CustomData);
+    if (!customData.IsHolding<VtDictionary>()) { return VtDictionary(); }
+    return VtDictionaryGet<VtDictionary>(
+        customData.UncheckedGet<VtDictionary>(),
+        UsdAiTokens->arnoldMetadata.GetString(), VtDefault = VtDictionary());
+}
+
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -17,12 +17,27 @@
 #include <pxr/pxr.h>
 #include "pxr/usd/ndrAi/api.h"
 
+#include <pxr/usd/sdf/primSpec.h>
 #include <pxr/usd/usd/stage.h>
 
+#include <unordered_map>
+
 PXR_NAMESPACE_OPEN_SCOPE
 
 UsdStageRefPtr NdrAiGetShaderDefs();
 
+using NdrAiShaderIndex =
+    std::unordered_map<TfToken, SdfPrimSpecHandle, TfToken::HashFunctor>;
+
+/// Returns the descriptions of the shaders by name.
+///
+/// The descriptions are authored in the root layer of the stage, so the
+/// index is built from its root prim specs, without composing the stage.
+const NdrAiShaderIndex& NdrAiGetShaderIndex();
+
+/// Returns the Arnold metadata of the node described by \p primSpec.
+VtDictionary NdrAiGetNodeMetadata(const SdfPrimSpecHandle& primSpec);
+
 PXR_NAMESPACE_CLOSE_SCOPE
 
 #endif // NDRAI_UTILS_H
@@ -17,7 +17,14 @@
 #include <vector>
 
 extern AtNodeMethods* previewSurfaceMtd;
+extern AtNodeMethods* primvarReaderFloatMtd;
 extern AtNodeMethods* primvarReaderFloat2Mtd;
+extern AtNodeMethods* primvarReaderFloat3Mtd;
+extern AtNodeMethods* primvarReaderFloat4Mtd;
+extern AtNodeMethods* primvarReaderIntMtd;
+extern AtNodeMethods* primvarReaderNormalMtd;
+extern AtNodeMethods* primvarReaderPointMtd;
+extern AtNodeMethods* primvarReaderVectorMtd;
 extern AtNodeMethods* uvTextureMtd;
 
 node_loader {
@@ -31,8 +38,22 @@ node_loader {
     const static std::vector<NodeDef> nodes{
         {previewSurfaceMtd, AI_TYPE_CLOSURE, "UsdPreviewSurface",
          AI_NODE_SHADER},
+        {primvarReaderFloatMtd, AI_TYPE_FLOAT, "UsdPrimvarReader_float",
+         AI_NODE_SHADER},
         {primvarReaderFloat2Mtd, AI_TYPE_VECTOR2, "UsdPrimvarReader_float2",
          AI_NODE_SHADER},
+        {primvarReaderFloat3Mtd, AI_TYPE_RGB, "UsdPrimvarReader_float3",
+         AI_NODE_SHADER},
+        {primvarReaderFloat4Mtd, AI_TYPE_RGBA, "UsdPrimvarReader_float4",
+         AI_NODE_SHADER},
+        {primvarReaderIntMtd, AI_TYPE_INT, "UsdPrimvarReader_int",
+         AI_NODE_SHADER},
+        {primvarReaderNormalMtd, AI_TYPE_VECTOR, "UsdPrimvarReader_normal",
+         AI_NODE_SHADER},
+        {primvarReaderPointMtd, AI_TYPE_VECTOR, "UsdPrimvarReader_point",
+         AI_NODE_SHADER},
+        {primvarReaderVectorMtd, AI_TYPE_VECTOR, "UsdPrimvarReader_vector",
+         AI_NODE_SHADER},
         {uvTextureMtd, AI_TYPE_RGBA, "UsdUVTexture", AI_NODE_SHADER}};
 
     const auto is = static_cast<size_t>(i);
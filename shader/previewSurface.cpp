@@ -33,7 +33,31 @@ enum params {
     p_displacement,
     p_occlusion
 };
-}
+
+const AtString diffuseColorStr("diffuseColor");
+const AtString emissiveColorStr("emissiveColor");
+const AtString roughnessStr("roughness");
+const AtString opacityStr("opacity");
+const AtString normalStr("normal");
+const AtString occlusionStr("occlusion");
+
+// Values of the unlinked parameters are cached in node_update, so we only
+// evaluate the linked ones in shader_evaluate.
+struct ShaderData {
+    AtRGB diffuseColor = AI_RGB_BLACK;
+    AtRGB emissiveColor = AI_RGB_BLACK;
+    AtVector normal = AtVector(0.0f, 0.0f, 1.0f);
+    float roughness = 0.5f;
+    float opacity = 1.0f;
+    float occlusion = 1.0f;
+    bool diffuseColorLinked = false;
+    bool emissiveColorLinked = false;
+    bool normalLinked = false;
+    bool roughnessLinked = false;
+    bool opacityLinked = false;
+    bool occlusionLinked = false;
+};
+} // namespace
 
 node_parameters {
     AiParameterRGB("diffuseColor", 0.18f, 0.18f, 0.18f);
@@ -53,9 +77,7 @@ node_parameters {
     AiMetaDataSetBool(nentry, "", "ndrai_dont_discover", true);
 }
 
-node_initialize {}
-
-#include <iostream>
+node_initialize { AiNodeSetLocalData(node, new ShaderData()); }
 
 // Thanks to  Chris­t­ian Schuler, for the contangent_frame
 //     + perturb_normal funcs:
@@ -84,13 +106,30 @@ AtVector perturbNormal(AtShaderGlobals* sg, AtVector tangentNormal) {
     return AiV3Normalize(AiM4VectorByMatrixMult(TBN, tangentNormal));
 }
 
-node_update {}
+node_update {
+    auto* data = reinterpret_cast<ShaderData*>(AiNodeGetLocalData(node));
+    data->diffuseColorLinked = AiNodeIsLinked(node, diffuseColorStr);
+    data->diffuseColor = AiNodeGetRGB(node, diffuseColorStr);
+    data->emissiveColorLinked = AiNodeIsLinked(node, emissiveColorStr);
+    data->emissiveColor = AiNodeGetRGB(node, emissiveColorStr);
+    data->normalLinked = AiNodeIsLinked(node, normalStr);
+    data->normal = AiNodeGetVec(node, normalStr);
+    data->roughnessLinked = AiNodeIsLinked(node, roughnessStr);
+    data->roughness = AiNodeGetFlt(node, roughnessStr);
+    data->opacityLinked = AiNodeIsLinked(node, opacityStr);
+    data->opacity = AiNodeGetFlt(node, opacityStr);
+    data->occlusionLinked = AiNodeIsLinked(node, occlusionStr);
+    data->occlusion = AiNodeGetFlt(node, occlusionStr);
+}
 
-node_finish {}
+node_finish { delete reinterpret_cast<ShaderData*>(AiNodeGetLocalData(node)); }
 
 shader_evaluate {
+    const auto* data =
+        reinterpret_cast<const ShaderData*>(AiNodeGetLocalData(node));
     auto& closures = sg->out.CLOSURE();
-    const auto opacity = AiShaderEvalParamFlt(p_opacity);
+    const auto opacity =
+        data->opacityLinked ? AiShaderEvalParamFlt(p_opacity) : data->opacity;
     if (opacity < AI_OPACITY_EPSILON) {
         closures.add(AiClosureTransparent(sg, AI_RGB_WHITE));
         return;
@@ -104,7 +143,8 @@ shader_evaluate {
         return;
     }
 
-    const auto tangentNormal = AiShaderEvalParamVec(p_normal);
+    const auto tangentNormal =
+        data->normalLinked ? AiShaderEvalParamVec(p_normal) : data->normal;
     if (!AiV3IsSmall(tangentNormal) &&
         !AiV3IsSmall(tangentNormal - AtVector(0, 0, 1))) {
         sg->N = perturbNormal(sg, tangentNormal);
@@ -117,12 +157,20 @@ shader_evaluate {
     }
 
     // TODO: implement the full shader.
-    const auto roughness = AiShaderEvalParamFlt(p_roughness);
-    const auto occlusion = AiShaderEvalParamFlt(p_occlusion);
-    closures.add(AiOrenNayarBSDF(
-        sg, occlusion * AiShaderEvalParamRGB(p_diffuseColor), sg->Nf,
-        roughness));
-    const auto emissiveColor = AiShaderEvalParamRGB(p_emissiveColor);
+    const auto roughness = data->roughnessLinked
+                               ? AiShaderEvalParamFlt(p_roughness)
+                               : data->roughness;
+    const auto occlusion = data->occlusionLinked
+                               ? AiShaderEvalParamFlt(p_occlusion)
+                               : data->occlusion;
+    const auto diffuseColor = data->diffuseColorLinked
+                                  ? AiShaderEvalParamRGB(p_diffuseColor)
+                                  : data->diffuseColor;
+    closures.add(
+        AiOrenNayarBSDF(sg, occlusion * diffuseColor, sg->Nf, roughness));
+    const auto emissiveColor = data->emissiveColorLinked
+                                   ? AiShaderEvalParamRGB(p_emissiveColor)
+                                   : data->emissiveColor;
     if (!AiColorIsSmall(emissiveColor)) {
         closures.add(AiClosureEmission(sg, emissiveColor));
     }
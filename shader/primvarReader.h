@@ -0,0 +1,205 @@
+// Copyright 2019 Luma Pictures
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/// @file primvarReader.h
+///
+/// Shared implementation of the UsdPrimvarReader_* shaders.
+///
+/// Each reader is a small translation unit, exporting the node methods and
+/// forwarding them to PrimvarReader, parametrized with one of the traits
+/// below.
+#pragma once
+
+#include <ai.h>
+
+namespace PrimvarReaderImpl {
+
+enum { p_varname = 0, p_fallback };
+
+const AtString varnameStr("varname");
+const AtString fallbackStr("fallback");
+
+} // namespace PrimvarReaderImpl
+
+struct PrimvarReaderFloatTraits {
+    using Type = float;
+    static void declareFallback(AtList* params) {
+        AiParameterFlt("fallback", 0.0f);
+    }
+    static Type getFallback(const AtNode* node) {
+        return AiNodeGetFlt(node, PrimvarReaderImpl::fallbackStr);
+    }
+    static Type evalFallback(const AtNode* node, AtShaderGlobals* sg) {
+        return AiShaderEvalParamFlt(PrimvarReaderImpl::p_fallback);
+    }
+    static Type& output(AtShaderGlobals* sg) { return sg->out.FLT(); }
+    static bool getUserData(
+        AtShaderGlobals* sg, const AtString& name, Type& value) {
+        return AiUDataGetFlt(name, value);
+    }
+};
+
+struct PrimvarReaderIntTraits {
+    using Type = int;
+    static void declareFallback(AtList* params) {
+        AiParameterInt("fallback", 0);
+    }
+    static Type getFallback(const AtNode* node) {
+        return AiNodeGetInt(node, PrimvarReaderImpl::fallbackStr);
+    }
+    static Type evalFallback(const AtNode* node, AtShaderGlobals* sg) {
+        return AiShaderEvalParamInt(PrimvarReaderImpl::p_fallback);
+    }
+    static Type& output(AtShaderGlobals* sg) { return sg->out.INT(); }
+    static bool getUserData(
+        AtShaderGlobals* sg, const AtString& name, Type& value) {
+        return AiUDataGetInt(name, value);
+    }
+};
+
+struct PrimvarReaderFloat2Traits {
+    using Type = AtVector2;
+    static void declareFallback(AtList* params) {
+        AiParameterVec2("fallback", 0.0f, 0.0f);
+    }
+    static Type getFallback(const AtNode* node) {
+        return AiNodeGetVec2(node, PrimvarReaderImpl::fallbackStr);
+    }
+    static Type evalFallback(const AtNode* node, AtShaderGlobals* sg) {
+        return AiShaderEvalParamVec2(PrimvarReaderImpl::p_fallback);
+    }
+    static Type& output(AtShaderGlobals* sg) { return sg->out.VEC2(); }
+    static bool getUserData(
+        AtShaderGlobals* sg, const AtString& name, Type& value) {
+        return AiUDataGetVec2(name, value);
+    }
+};
+
+/// Float3 primvars are exported as RGB when they have the color role,
+/// and as VECTOR otherwise, so we are looking for both.
+struct PrimvarReaderFloat3Traits {
+    using Type = AtRGB;
+    static void declareFallback(AtList* params) {
+        AiParameterRGB("fallback", 0.0f, 0.0f, 0.0f);
+    }
+    static Type getFallback(const AtNode* node) {
+        return AiNodeGetRGB(node, PrimvarReaderImpl::fallbackStr);
+    }
+    static Type evalFallback(const AtNode* node, AtShaderGlobals* sg) {
+        return AiShaderEvalParamRGB(PrimvarReaderImpl::p_fallback);
+    }
+    static Type& output(AtShaderGlobals* sg) { return sg->out.RGB(); }
+    static bool getUserData(
+        AtShaderGlobals* sg, const AtString& name, Type& value) {
+        if (AiUDataGetRGB(name, value)) { return true; }
+        AtVector v;
+        if (!AiUDataGetVec(name, v)) { return false; }
+        value = AtRGB(v.x, v.y, v.z);
+        return true;
+    }
+};
+
+struct PrimvarReaderFloat4Traits {
+    using Type = AtRGBA;
+    static void declareFallback(AtList* params) {
+        AiParameterRGBA("fallback", 0.0f, 0.0f, 0.0f, 0.0f);
+    }
+    static Type getFallback(const AtNode* node) {
+        return AiNodeGetRGBA(node, PrimvarReaderImpl::fallbackStr);
+    }
+    static Type evalFallback(const AtNode* node, AtShaderGlobals* sg) {
+        return AiShaderEvalParamRGBA(PrimvarReaderImpl::p_fallback);
+    }
+    static Type& output(AtShaderGlobals* sg) { return sg->out.RGBA(); }
+    static bool getUserData(
+        AtShaderGlobals* sg, const AtString& name, Type& value) {
+        return AiUDataGetRGBA(name, value);
+    }
+};
+
+/// Used for the normal, point and vector readers.
+struct PrimvarReaderVectorTraits {
+    using Type = AtVector;
+    static void declareFallback(AtList* params) {
+        AiParameterVec("fallback", 0.0f, 0.0f, 0.0f);
+    }
+    static Type getFallback(const AtNode* node) {
+        return AiNodeGetVec(node, PrimvarReaderImpl::fallbackStr);
+    }
+    static Type evalFallback(const AtNode* node, AtShaderGlobals* sg) {
+        return AiShaderEvalParamVec(PrimvarReaderImpl::p_fallback);
+    }
+    static Type& output(AtShaderGlobals* sg) { return sg->out.VEC(); }
+    static bool getUserData(
+        AtShaderGlobals* sg, const AtString& name, Type& value) {
+        if (AiUDataGetVec(name, value)) { return true; }
+        AtRGB c;
+        if (!AiUDataGetRGB(name, c)) { return false; }
+        value = AtVector(c.r, c.g, c.b);
+        return true;
+    }
+};
+
+template <typename Traits>
+class PrimvarReader {
+public:
+    static void parameters(AtList* params, AtNodeEntry* nentry) {
+        AiParameterStr("varname", "");
+        Traits::declareFallback(params);
+
+        AiMetaDataSetBool(nentry, "", "ndrai_dont_discover", true);
+    }
+
+    static void initialize(AtNode* node) {
+        AiNodeSetLocalData(node, new ShaderData());
+    }
+
+    static void update(AtNode* node) {
+        auto* data = reinterpret_cast<ShaderData*>(AiNodeGetLocalData(node));
+        data->varnameLinked =
+            AiNodeIsLinked(node, PrimvarReaderImpl::varnameStr);
+        data->varname = AiNodeGetStr(node, PrimvarReaderImpl::varnameStr);
+        data->fallbackLinked =
+            AiNodeIsLinked(node, PrimvarReaderImpl::fallbackStr);
+        data->fallback = Traits::getFallback(node);
+    }
+
+    static void finish(AtNode* node) {
+        delete reinterpret_cast<ShaderData*>(AiNodeGetLocalData(node));
+    }
+
+    static void evaluate(AtNode* node, AtShaderGlobals* sg) {
+        const auto* data =
+            reinterpret_cast<const ShaderData*>(AiNodeGetLocalData(node));
+        const auto varname =
+            data->varnameLinked
+                ? AiShaderEvalParamStr(PrimvarReaderImpl::p_varname)
+                : data->varname;
+        if (varname.empty() ||
+            !Traits::getUserData(sg, varname, Traits::output(sg))) {
+            Traits::output(sg) = data->fallbackLinked
+                                     ? Traits::evalFallback(node, sg)
+                                     : data->fallback;
+        }
+    }
+
+private:
+    // Values of the unlinked parameters are cached in node_update, so we
+    // only evaluate the linked ones in shader_evaluate.
+    struct ShaderData {
+        AtString varname;
+        typename Traits::Type fallback = typename Traits::Type();
+        bool varnameLinked = false;
+        bool fallbackLinked = false;
+    };
+};
@@ -11,31 +11,18 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
-#include <ai.h>
+#include "primvarReader.h"
 
 AI_SHADER_NODE_EXPORT_METHODS(primvarReaderFloat2Mtd);
 
-namespace {
-enum { p_varname, p_fallback };
-}
+using Reader = PrimvarReader<PrimvarReaderFloat2Traits>;
 
-node_parameters {
-    AiParameterStr("varname", "");
-    AiParameterVec2("fallback", 0.0f, 0.0f);
+node_parameters { Reader::parameters(params, nentry); }
 
-    AiMetaDataSetBool(nentry, "", "ndrai_dont_discover", true);
-}
+node_initialize { Reader::initialize(node); }
 
-node_initialize {}
+node_update { Reader::update(node); }
 
-node_update {}
+node_finish { Reader::finish(node); }
 
-node_finish {}
-
-shader_evaluate {
-    const auto varname = AiShaderEvalParamStr(p_varname);
-    if (varname.empty() || !AiUDataGetVec2(varname, sg->out.VEC2())) {
-        sg->out.VEC2() = AiShaderEvalParamVec2(p_fallback);
-        return;
-    }
-}
\ No newline at end of file
+shader_evaluate { Reader::evaluate(node, sg); }
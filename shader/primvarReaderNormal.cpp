@@ -0,0 +1,28 @@
+// Copyright 2019 Luma Pictures
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "primvarReader.h"
+
+AI_SHADER_NODE_EXPORT_METHODS(primvarReaderNormalMtd);
+
+using Reader = PrimvarReader<PrimvarReaderVectorTraits>;
+
+node_parameters { Reader::parameters(params, nentry); }
+
+node_initialize { Reader::initialize(node); }
+
+node_update { Reader::update(node); }
+
+node_finish { Reader::finish(node); }
+
+shader_evaluate { Reader::evaluate(node, sg); }
@@ -13,6 +13,16 @@
 // limitations under the License.
 #include <ai.h>
 
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
 AI_SHADER_NODE_EXPORT_METHODS(uvTextureMtd);
 
 namespace {
@@ -24,14 +34,149 @@ enum {
     p_fallback,
     p_scale,
     p_bias,
+    p_useTx,
 };
 
 const AtString empty;
 const AtString black("black");
-const AtString clamp("black");
+const AtString clamp("clamp");
 const AtString repeat("repeat");
 const AtString mirror("mirror");
 const AtString useMetadata("useMetadata");
+
+const AtString fileStr("file");
+const AtString wrapSStr("wrapS");
+const AtString wrapTStr("wrapT");
+const AtString fallbackStr("fallback");
+const AtString scaleStr("scale");
+const AtString biasStr("bias");
+const AtString useTxStr("useTx");
+
+constexpr auto udimToken = "<UDIM>";
+constexpr auto udimTokenLength = 6;
+// UDIM tiles 1001 - 1100.
+constexpr auto udimFirstTile = 1001;
+constexpr auto udimTilesPerRow = 10;
+constexpr auto udimNumTiles = 100;
+
+bool isFile(const std::string& path) {
+    struct stat s;
+    return stat(path.c_str(), &s) == 0 && S_ISREG(s.st_mode);
+}
+
+// Returns the path to the .tx file next to the source texture if it exists,
+// so Arnold doesn't have to look for it every time the file is opened.
+std::string resolveTx(const std::string& path) {
+    const auto dot = path.rfind('.');
+    const auto slash = path.rfind('/');
+    if (dot == std::string::npos ||
+        (slash != std::string::npos && dot < slash)) {
+        return path;
+    }
+    if (path.compare(dot, std::string::npos, ".tx") == 0) { return path; }
+    auto txPath = path.substr(0, dot) + ".tx";
+    return isFile(txPath) ? txPath : path;
+}
+
+uint8_t getWrapMode(const AtString& mode) {
+    if (mode == black) {
+        return AI_WRAP_BLACK;
+    } else if (mode == clamp) {
+        return AI_WRAP_CLAMP;
+    } else if (mode == mirror) {
+        return AI_WRAP_MIRROR;
+    } else if (mode == repeat) {
+        return AI_WRAP_PERIODIC;
+    } else {
+        return AI_WRAP_FILE;
+    }
+}
+
+// Values of the unlinked parameters are cached in node_update, including
+// the texture handle, so we only evaluate the linked ones in
+// shader_evaluate.
+struct ShaderData {
+    AtTextureHandle* texture = nullptr;
+    // Handles for each UDIM tile, only used when the filename contains the
+    // <UDIM> token.
+    std::array<AtTextureHandle*, udimNumTiles> tiles;
+    // Tiles found for the last UDIM filename, so the directory is only
+    // listed when the filename changes.
+    std::string udimFile;
+    bool udimUseTx = false;
+    std::vector<std::pair<int, std::string>> udimTilePaths;
+    AtRGBA fallback = AI_RGBA_ZERO;
+    AtRGBA scale = AI_RGBA_ZERO;
+    AtRGBA bias = AI_RGBA_ZERO;
+    uint8_t wrapS = AI_WRAP_FILE;
+    uint8_t wrapT = AI_WRAP_FILE;
+    bool fileLinked = false;
+    bool wrapSLinked = false;
+    bool wrapTLinked = false;
+    bool fallbackLinked = false;
+    bool scaleLinked = false;
+    bool biasLinked = false;
+    bool isUdim = false;
+
+    ShaderData() { tiles.fill(nullptr); }
+
+    void destroyTexture() {
+        if (texture != nullptr) {
+            AiTextureHandleDestroy(texture);
+            texture = nullptr;
+        }
+        for (auto& tile : tiles) {
+            if (tile != nullptr) {
+                AiTextureHandleDestroy(tile);
+                tile = nullptr;
+            }
+        }
+        isUdim = false;
+    }
+
+    // Creates a handle for each tile found next to the UDIM filename.
+    void createTiles(const std::string& file, size_t udimPos, bool useTx) {
+        isUdim = true;
+        if (file != udimFile || useTx != udimUseTx) {
+            udimFile = file;
+            udimUseTx = useTx;
+            findTiles(file, udimPos, useTx);
+        }
+        for (const auto& tile : udimTilePaths) {
+            tiles[tile.first] = AiTextureHandleCreate(tile.second.c_str());
+        }
+    }
+
+    // Lists the tiles next to the UDIM filename.
+    void findTiles(const std::string& file, size_t udimPos, bool useTx) {
+        udimTilePaths.clear();
+        const auto slash = file.rfind('/', udimPos);
+        const auto dir = slash == std::string::npos ? std::string(".")
+                                                    : file.substr(0, slash);
+        const auto nameStart = slash == std::string::npos ? 0 : slash + 1;
+        const auto prefix = file.substr(nameStart, udimPos - nameStart);
+        const auto suffix = file.substr(udimPos + udimTokenLength);
+        auto* d = opendir(dir.c_str());
+        if (d == nullptr) { return; }
+        for (struct dirent* de = nullptr; (de = readdir(d)) != nullptr;) {
+            const std::string name(de->d_name);
+            if (name.size() != prefix.size() + 4 + suffix.size() ||
+                name.compare(0, prefix.size(), prefix) != 0 ||
+                name.compare(prefix.size() + 4, suffix.size(), suffix) != 0) {
+                continue;
+            }
+            const auto tileStr = name.substr(prefix.size(), 4);
+            char* end = nullptr;
+            const auto tile = strtol(tileStr.c_str(), &end, 10);
+            if (end != tileStr.c_str() + 4) { continue; }
+            const auto index = static_cast<int>(tile - udimFirstTile);
+            if (index < 0 || index >= udimNumTiles) { continue; }
+            auto path = file.substr(0, udimPos) + tileStr + suffix;
+            if (useTx) { path = resolveTx(path); }
+            udimTilePaths.emplace_back(index, std::move(path));
+        }
+        closedir(d);
+    }
 } // namespace
 
 node_parameters {
@@ -42,49 +187,100 @@ node_parameters {
     AiParameterRGBA("fallback", 0.0f, 0.0f, 0.0f, 1.0f);
     AiParameterRGBA("scale", 1.0f, 1.0f, 1.0f, 1.0f);
     AiParameterRGBA("bias", 0.0f, 0.0f, 0.0f, 0.0f);
+    // Use the .tx file next to the texture if there is one. Off by default,
+    // because a stale .tx would silently replace the source texture.
+    AiParameterBool("useTx", false);
 
     AiMetaDataSetBool(nentry, "", "ndrai_dont_discover", true);
 }
 
-node_initialize {}
+node_initialize { AiNodeSetLocalData(node, new ShaderData()); }
 
-node_update {}
+node_update {
+    auto* data = reinterpret_cast<ShaderData*>(AiNodeGetLocalData(node));
+    data->destroyTexture();
+    data->fileLinked = AiNodeIsLinked(node, fileStr);
+    if (!data->fileLinked) {
+        const std::string file(AiNodeGetStr(node, fileStr).c_str());
+        const auto useTx = AiNodeGetBool(node, useTxStr);
+        const auto udimPos = file.find(udimToken);
+        if (udimPos != std::string::npos) {
+            data->createTiles(file, udimPos, useTx);
+        } else if (!file.empty()) {
+            data->texture = AiTextureHandleCreate(
+                (useTx ? resolveTx(file) : file).c_str());
+        }
+    }
+    data->wrapSLinked = AiNodeIsLinked(node, wrapSStr);
+    data->wrapS = getWrapMode(AiNodeGetStr(node, wrapSStr));
+    data->wrapTLinked = AiNodeIsLinked(node, wrapTStr);
+    data->wrapT = getWrapMode(AiNodeGetStr(node, wrapTStr));
+    data->fallbackLinked = AiNodeIsLinked(node, fallbackStr);
+    data->fallback = AiNodeGetRGBA(node, fallbackStr);
+    data->scaleLinked = AiNodeIsLinked(node, scaleStr);
+    data->scale = AiNodeGetRGBA(node, scaleStr);
+    data->biasLinked = AiNodeIsLinked(node, biasStr);
+    data->bias = AiNodeGetRGBA(node, biasStr);
+}
 
-node_finish {}
+node_finish {
+    auto* data = reinterpret_cast<ShaderData*>(AiNodeGetLocalData(node));
+    data->destroyTexture();
+    delete data;
+}
 
 shader_evaluate {
-    const auto file = AiShaderEvalParamStr(p_file);
-    if (file.empty()) {
-        sg->out.RGBA() = AiShaderEvalParamRGBA(p_fallback);
-        return;
-    }
+    const auto* data =
+        reinterpret_cast<const ShaderData*>(AiNodeGetLocalData(node));
+    auto getFallback = [&]() -> AtRGBA {
+        return data->fallbackLinked ? AiShaderEvalParamRGBA(p_fallback)
+                                    : data->fallback;
+    };
 
     AtTextureParams params = {};
     AiTextureParamsSetDefaults(params);
-
-    auto getWrapMode = [](const AtString& mode) -> uint8_t {
-        if (mode == black) {
-            return AI_WRAP_BLACK;
-        } else if (mode == clamp) {
-            return AI_WRAP_CLAMP;
-        } else if (mode == mirror) {
-            return AI_WRAP_MIRROR;
-        } else if (mode == repeat) {
-            return AI_WRAP_PERIODIC;
-        } else {
-            return AI_WRAP_FILE;
-        }
-    };
-
-    params.wrap_s = getWrapMode(AiShaderEvalParamStr(p_wrapS));
-    params.wrap_t = getWrapMode(AiShaderEvalParamStr(p_wrapT));
+    params.wrap_s = data->wrapSLinked
+                        ? getWrapMode(AiShaderEvalParamStr(p_wrapS))
+                        : data->wrapS;
+    params.wrap_t = data->wrapTLinked
+                        ? getWrapMode(AiShaderEvalParamStr(p_wrapT))
+                        : data->wrapT;
 
     auto success = false;
-    sg->out.RGBA() = AiTextureAccess(sg, file, empty, params, &success);
+    if (data->fileLinked) {
+        const auto file = AiShaderEvalParamStr(p_file);
+        if (file.empty()) {
+            sg->out.RGBA() = getFallback();
+            return;
+        }
+        sg->out.RGBA() = AiTextureAccess(sg, file, empty, params, &success);
+    } else if (data->isUdim) {
+        const auto tileU = static_cast<int>(floorf(sg->u));
+        const auto tileV = static_cast<int>(floorf(sg->v));
+        if (tileU >= 0 && tileU < udimTilesPerRow && tileV >= 0) {
+            const auto index = tileU + tileV * udimTilesPerRow;
+            if (index < udimNumTiles && data->tiles[index] != nullptr) {
+                // Moving the lookup to the 0-1 range of the tile.
+                const auto u = sg->u;
+                const auto v = sg->v;
+                sg->u -= static_cast<float>(tileU);
+                sg->v -= static_cast<float>(tileV);
+                sg->out.RGBA() = AiTextureHandleAccess(
+                    sg, data->tiles[index], params, &success);
+                sg->u = u;
+                sg->v = v;
+            }
+        }
+    } else if (data->texture != nullptr) {
+        sg->out.RGBA() =
+            AiTextureHandleAccess(sg, data->texture, params, &success);
+    }
     if (!success) {
-        sg->out.RGBA() = AiShaderEvalParamRGBA(p_fallback);
+        sg->out.RGBA() = getFallback();
         return;
     }
-    sg->out.RGBA() *= AiShaderEvalParamRGBA(p_scale);
-    sg->out.RGBA() += AiShaderEvalParamRGBA(p_bias);
+    sg->out.RGBA() *=
+        data->scaleLinked ? AiShaderEvalParamRGBA(p_scale) : data->scale;
+    sg->out.RGBA() +=
+        data->biasLinked ? AiShaderEvalParamRGBA(p_bias) : data->bias;
 }
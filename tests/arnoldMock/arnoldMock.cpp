@@ -0,0 +1,2185 @@
+// Copyright 2019 Luma Pictures
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "arnoldMock.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// The types declared as opaque in ai.h.
+
+struct AtList {
+    AtNodeEntry* entry;
+};
+
+struct AtArray {
+    uint32_t nelements = 0;
+    uint8_t nkeys = 0;
+    uint8_t type = AI_TYPE_NONE;
+    std::vector<uint8_t> data;
+};
+
+struct AtParamEntry {
+    ~AtParamEntry() {
+        if (type == AI_TYPE_ARRAY) { delete defaultValue.ARRAY(); }
+    }
+
+    AtString name;
+    uint8_t type = AI_TYPE_NONE;
+    uint8_t subtype = AI_TYPE_NONE;
+    AtParamValue defaultValue;
+    AtMatrix defaultMatrix;
+    std::vector<const char*> enumValues;
+};
+
+struct AtNodeEntry {
+    AtString name;
+    int type = AI_NODE_UNDEFINED;
+    uint8_t outputType = AI_TYPE_NONE;
+    std::string filename;
+    std::string version;
+    AtNodeMethods methods;
+    std::vector<std::unique_ptr<AtParamEntry>> params;
+    std::unordered_map<AtString, size_t, AtStringHash> paramIndices;
+    std::vector<AtMetaDataEntry> metadata;
+    int count = 0;
+};
+
+struct AtUserParamEntry {
+    AtString name;
+    int type = AI_TYPE_NONE;
+    int arrayType = AI_TYPE_NONE;
+    int category = AI_USERDEF_UNDEFINED;
+    size_t slot = 0;
+};
+
+struct AtUniverse {
+    std::unordered_set<AtNode*> nodes;
+    std::unordered_map<AtString, AtNode*, AtStringHash> nodesByName;
+    AtNode* options = nullptr;
+};
+
+struct AtNode {
+    // Storage of a single built-in or user parameter.
+    struct Slot {
+        uint8_t type = AI_TYPE_NONE;
+        uint8_t subtype = AI_TYPE_NONE;
+        AtParamValue value;
+        AtMatrix matrix;
+        const AtParamEntry* entry = nullptr;
+    };
+
+    struct Link {
+        AtNode* source = nullptr;
+        int component = -1;
+    };
+
+    const AtNodeEntry* entry = nullptr;
+    AtUniverse* universe = nullptr;
+    AtString name;
+    std::vector<Slot> slots;
+    std::vector<std::unique_ptr<AtUserParamEntry>> userParams;
+    std::unordered_map<AtString, size_t, AtStringHash> userIndices;
+    std::unordered_map<std::string, Link> links;
+    std::unordered_multiset<AtNode*> targets;
+    void* localData = nullptr;
+};
+
+struct AtParamIterator {
+    const AtNodeEntry* entry;
+    size_t index;
+};
+
+struct AtUserParamIterator {
+    std::vector<const AtUserParamEntry*> params;
+    size_t index;
+};
+
+struct AtNodeIterator {
+    std::vector<AtNode*> nodes;
+    size_t index;
+};
+
+struct AtNodeEntryIterator {
+    std::vector<AtNodeEntry*> entries;
+    size_t index;
+};
+
+struct AtMetaDataIterator {
+    std::vector<const AtMetaDataEntry*> entries;
+    size_t index;
+};
+
+namespace {
+
+// Call statistics
+
+struct CallCounter {
+    explicit CallCounter(const char* name);
+
+    const char* name;
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> nanoseconds;
+};
+
+std::mutex& callCountersMutex() {
+    static std::mutex ret;
+    return ret;
+}
+
+std::vector<CallCounter*>& callCounters() {
+    static std::vector<CallCounter*> ret;
+    return ret;
+}
+
+CallCounter::CallCounter(const char* name)
+    : name(name), count(0), nanoseconds(0) {
+    std::lock_guard<std::mutex> lock(callCountersMutex());
+    callCounters().push_back(this);
+}
+
+class CallTimer {
+public:
+    explicit CallTimer(CallCounter& counter)
+        : _counter(counter), _start(std::chrono::steady_clock::now()) {}
+
+    ~CallTimer() {
+        const auto elapsed = std::chrono::steady_clock::now() - _start;
+        _counter.count.fetch_add(1, std::memory_order_relaxed);
+        _counter.nanoseconds.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                .count(),
+            std::memory_order_relaxed);
+    }
+
+private:
+    CallCounter& _counter;
+    std::chrono::steady_clock::time_point _start;
+};
+
+// Records the call and the time spent inside the enclosing function.
+#define MOCK_CALL()                                \
+    static CallCounter _mockCallCounter(__func__); \
+    CallTimer _mockCallTimer(_mockCallCounter)
+
+// Global state
+
+std::mutex& stringsMutex() {
+    static std::mutex ret;
+    return ret;
+}
+
+std::unordered_set<std::string>& strings() {
+    static std::unordered_set<std::string> ret;
+    return ret;
+}
+
+// Guards the node entries and the universes, the parameters of a node are not
+// guarded, similarly to Arnold.
+std::recursive_mutex& sceneMutex() {
+    static std::recursive_mutex ret;
+    return ret;
+}
+
+std::unordered_map<AtString, std::unique_ptr<AtNodeEntry>, AtStringHash>&
+nodeEntries() {
+    static std::unordered_map<
+        AtString, std::unique_ptr<AtNodeEntry>, AtStringHash>
+        ret;
+    return ret;
+}
+
+// Installation order of the node entries, used by the iterators.
+std::vector<AtNodeEntry*>& nodeEntryOrder() {
+    static std::vector<AtNodeEntry*> ret;
+    return ret;
+}
+
+std::unordered_set<AtUniverse*>& universes() {
+    static std::unordered_set<AtUniverse*> ret;
+    return ret;
+}
+
+AtUniverse* defaultUniverse = nullptr;
+
+int consoleFlags = AI_LOG_WARNINGS | AI_LOG_ERRORS;
+
+using ScopedLock = std::lock_guard<std::recursive_mutex>;
+
+const AtString nameStr("name");
+const AtString optionsStr("options");
+
+void printMessage(
+    int flag, const char* prefix, const char* format, va_list ap) {
+    if ((consoleFlags & flag) == 0) { return; }
+    fprintf(stderr, "[arnoldMock] %s", prefix);
+    vfprintf(stderr, format, ap);
+    fprintf(stderr, "\n");
+}
+
+AtUniverse* getUniverse(const AtUniverse* universe) {
+    return universe == nullptr ? defaultUniverse
+                               : const_cast<AtUniverse*>(universe);
+}
+
+// Types and arrays
+
+size_t getTypeSize(uint8_t type) {
+    switch (type) {
+        case AI_TYPE_BYTE:
+        case AI_TYPE_BOOLEAN:
+            return 1;
+        case AI_TYPE_USHORT:
+        case AI_TYPE_HALF:
+            return 2;
+        case AI_TYPE_INT:
+        case AI_TYPE_UINT:
+        case AI_TYPE_FLOAT:
+        case AI_TYPE_ENUM:
+            return 4;
+        case AI_TYPE_RGB:
+            return sizeof(AtRGB);
+        case AI_TYPE_RGBA:
+            return sizeof(AtRGBA);
+        case AI_TYPE_VECTOR:
+            return sizeof(AtVector);
+        case AI_TYPE_VECTOR2:
+            return sizeof(AtVector2);
+        case AI_TYPE_STRING:
+            return sizeof(AtString);
+        case AI_TYPE_POINTER:
+        case AI_TYPE_NODE:
+        case AI_TYPE_ARRAY:
+        case AI_TYPE_CLOSURE:
+            return sizeof(void*);
+        case AI_TYPE_MATRIX:
+            return sizeof(AtMatrix);
+        default:
+            return 0;
+    }
+}
+
+AtArray* allocateArray(uint32_t nelements, uint8_t nkeys, uint8_t type) {
+    auto* ret = new AtArray;
+    ret->nelements = nelements;
+    ret->nkeys = nkeys;
+    ret->type = type;
+    ret->data.resize(
+        static_cast<size_t>(nelements) * nkeys * getTypeSize(type), 0);
+    return ret;
+}
+
+template <typename T>
+bool getArrayElement(
+    const AtArray* a, uint32_t i, uint8_t type, const char* file, int line,
+    T& out) {
+    if (a == nullptr) { return false; }
+    if (a->type != type) {
+        AiMsgWarning(
+            "%s:%d: reading a %s array as %s", file, line,
+            AiParamGetTypeName(a->type), AiParamGetTypeName(type));
+        return false;
+    }
+    if (i >= a->nelements * a->nkeys) {
+        AiMsgWarning(
+            "%s:%d: index %u is out of range (%u)", file, line, i,
+            a->nelements * a->nkeys);
+        return false;
+    }
+    memcpy(&out, a->data.data() + i * sizeof(T), sizeof(T));
+    return true;
+}
+
+template <typename T>
+bool setArrayElement(
+    AtArray* a, uint32_t i, uint8_t type, const char* file, int line,
+    const T& in) {
+    if (a == nullptr) { return false; }
+    if (a->type != type) {
+        AiMsgWarning(
+            "%s:%d: writing %s into a %s array", file, line,
+            AiParamGetTypeName(type), AiParamGetTypeName(a->type));
+        return false;
+    }
+    if (i >= a->nelements * a->nkeys) {
+        AiMsgWarning(
+            "%s:%d: index %u is out of range (%u)", file, line, i,
+            a->nelements * a->nkeys);
+        return false;
+    }
+    memcpy(a->data.data() + i * sizeof(T), &in, sizeof(T));
+    return true;
+}
+
+// Node entries
+
+AtParamEntry* addParameter(AtList* params, const char* pname, uint8_t type) {
+    auto* entry = params->entry;
+    const AtString name(pname);
+    if (entry->paramIndices.find(name) != entry->paramIndices.end()) {
+        AiMsgWarning(
+            "%s: parameter %s is already declared", entry->name.c_str(),
+            pname);
+        return nullptr;
+    }
+    auto* param = new AtParamEntry;
+    param->name = name;
+    param->type = type;
+    param->defaultMatrix = AiM4Identity();
+    entry->paramIndices.emplace(name, entry->params.size());
+    entry->params.emplace_back(param);
+    return param;
+}
+
+void setMetaData(
+    AtNodeEntry* nentry, const AtString& param, const AtString& name,
+    uint8_t type, const AtParamValue& value) {
+    if (nentry == nullptr) { return; }
+    for (auto& it : nentry->metadata) {
+        if (it.param == param && it.name == name) {
+            it.type = type;
+            it.value = value;
+            return;
+        }
+    }
+    AtMetaDataEntry entry;
+    entry.name = name;
+    entry.param = param;
+    entry.type = type;
+    entry.value = value;
+    nentry->metadata.push_back(entry);
+}
+
+const AtMetaDataEntry* getMetaData(
+    const AtNodeEntry* nentry, const AtString& param, const AtString& name,
+    uint8_t type) {
+    if (nentry == nullptr) { return nullptr; }
+    for (const auto& it : nentry->metadata) {
+        if (it.param == param && it.name == name) {
+            return it.type == type ? &it : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+// Nodes
+
+AtNode::Slot* findSlot(const AtNode* node, const AtString& param) {
+    if (node == nullptr) { return nullptr; }
+    auto* mutableNode = const_cast<AtNode*>(node);
+    const auto paramIt = node->entry->paramIndices.find(param);
+    if (paramIt != node->entry->paramIndices.end()) {
+        return &mutableNode->slots[paramIt->second];
+    }
+    const auto userIt = node->userIndices.find(param);
+    if (userIt != node->userIndices.end()) {
+        return &mutableNode->slots[userIt->second];
+    }
+    return nullptr;
+}
+
+// Returns the slot when it exists and its type is one of the accepted ones,
+// warns otherwise, similarly to Arnold.
+AtNode::Slot* findSlot(
+    const AtNode* node, const AtString& param,
+    std::initializer_list<uint8_t> types, const char* function) {
+    auto* slot = findSlot(node, param);
+    if (slot == nullptr) {
+        if (node != nullptr) {
+            AiMsgWarning(
+                "%s: %s has no parameter named %s", function,
+                AiNodeGetName(node), param.c_str());
+        }
+        return nullptr;
+    }
+    if (std::find(types.begin(), types.end(), slot->type) == types.end()) {
+        AiMsgWarning(
+            "%s: %s.%s is of type %s", function, AiNodeGetName(node),
+            param.c_str(), AiParamGetTypeName(slot->type));
+        return nullptr;
+    }
+    return slot;
+}
+
+void resetSlot(AtNode::Slot& slot) {
+    if (slot.type == AI_TYPE_ARRAY) {
+        AiArrayDestroy(slot.value.ARRAY());
+        slot.value.ARRAY() = nullptr;
+    }
+    if (slot.entry == nullptr) {
+        slot.value = AtParamValue();
+        return;
+    }
+    slot.value = slot.entry->defaultValue;
+    slot.matrix = slot.entry->defaultMatrix;
+    if (slot.type == AI_TYPE_ARRAY && slot.value.ARRAY() != nullptr) {
+        slot.value.ARRAY() = AiArrayCopy(slot.value.ARRAY());
+    }
+}
+
+void setNodeName(AtNode* node, const AtString& name) {
+    ScopedLock lock(sceneMutex());
+    auto& byName = node->universe->nodesByName;
+    if (!node->name.empty()) {
+        const auto it = byName.find(node->name);
+        if (it != byName.end() && it->second == node) { byName.erase(it); }
+    }
+    node->name = name;
+    node->slots[0].value.STR() = name;
+    if (!name.empty()) { byName[name] = node; }
+}
+
+void removeLinksFrom(AtNode* source) {
+    for (auto* target : source->targets) {
+        for (auto it = target->links.begin(); it != target->links.end();) {
+            if (it->second.source == source) {
+                it = target->links.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    source->targets.clear();
+}
+
+void removeLink(AtNode* node, const std::string& input) {
+    const auto it = node->links.find(input);
+    if (it == node->links.end()) { return; }
+    auto& targets = it->second.source->targets;
+    const auto target = targets.find(node);
+    if (target != targets.end()) { targets.erase(target); }
+    node->links.erase(it);
+}
+
+int getComponentIndex(const char* component) {
+    if (component == nullptr || component[0] == '\0' || component[1] != '\0') {
+        return -1;
+    }
+    switch (component[0]) {
+        case 'r':
+        case 'x':
+            return 0;
+        case 'g':
+        case 'y':
+            return 1;
+        case 'b':
+        case 'z':
+            return 2;
+        case 'a':
+            return 3;
+        default:
+            return -1;
+    }
+}
+
+bool addLink(
+    AtNode* source, int component, AtNode* target, const char* input) {
+    if (source == nullptr || target == nullptr || input == nullptr) {
+        return false;
+    }
+    const std::string key(input);
+    const auto dot = key.find('.');
+    const AtString param(key.substr(0, dot).c_str());
+    if (findSlot(target, param) == nullptr) {
+        AiMsgWarning(
+            "unable to link %s, %s has no parameter named %s",
+            AiNodeGetName(source), AiNodeGetName(target), param.c_str());
+        return false;
+    }
+    removeLink(target, key);
+    auto& link = target->links[key];
+    link.source = source;
+    link.component = component;
+    source->targets.insert(target);
+    return true;
+}
+
+AtUserParamEntry* parseDeclaration(
+    const AtString& name, const char* declaration) {
+    static const std::unordered_map<std::string, int> categories = {
+        {"constant", AI_USERDEF_CONSTANT},
+        {"uniform", AI_USERDEF_UNIFORM},
+        {"varying", AI_USERDEF_VARYING},
+        {"indexed", AI_USERDEF_INDEXED}};
+    static const std::unordered_map<std::string, int> types = {
+        {"BYTE", AI_TYPE_BYTE},       {"INT", AI_TYPE_INT},
+        {"UINT", AI_TYPE_UINT},       {"BOOL", AI_TYPE_BOOLEAN},
+        {"FLOAT", AI_TYPE_FLOAT},     {"RGB", AI_TYPE_RGB},
+        {"RGBA", AI_TYPE_RGBA},       {"VECTOR", AI_TYPE_VECTOR},
+        {"VECTOR2", AI_TYPE_VECTOR2}, {"STRING", AI_TYPE_STRING},
+        {"POINTER", AI_TYPE_POINTER}, {"NODE", AI_TYPE_NODE},
+        {"MATRIX", AI_TYPE_MATRIX},   {"ARRAY", AI_TYPE_ARRAY}};
+    std::istringstream ss(declaration == nullptr ? "" : declaration);
+    std::string category;
+    std::string type;
+    std::string arrayType;
+    ss >> category >> type;
+    const auto categoryIt = categories.find(category);
+    const auto typeIt = types.find(type);
+    if (categoryIt == categories.end() || typeIt == types.end()) {
+        return nullptr;
+    }
+    auto* ret = new AtUserParamEntry;
+    ret->name = name;
+    ret->category = categoryIt->second;
+    ret->type = typeIt->second;
+    if (ret->type == AI_TYPE_ARRAY) {
+        ss >> arrayType;
+        const auto arrayTypeIt = types.find(arrayType);
+        if (arrayTypeIt == types.end() ||
+            arrayTypeIt->second == AI_TYPE_ARRAY) {
+            delete ret;
+            return nullptr;
+        }
+        ret->arrayType = arrayTypeIt->second;
+    }
+    return ret;
+}
+
+void destroyNode(AtNode* node) {
+    removeLinksFrom(node);
+    std::vector<std::string> inputs;
+    for (const auto& it : node->links) { inputs.push_back(it.first); }
+    for (const auto& it : inputs) { removeLink(node, it); }
+    for (auto& slot : node->slots) {
+        if (slot.type == AI_TYPE_ARRAY) { AiArrayDestroy(slot.value.ARRAY()); }
+    }
+    auto* universe = node->universe;
+    universe->nodes.erase(node);
+    const auto it = universe->nodesByName.find(node->name);
+    if (it != universe->nodesByName.end() && it->second == node) {
+        universe->nodesByName.erase(it);
+    }
+    if (universe->options == node) { universe->options = nullptr; }
+    const_cast<AtNodeEntry*>(node->entry)->count -= 1;
+    delete node;
+}
+
+void destroyUniverse(AtUniverse* universe) {
+    std::vector<AtNode*> nodes(
+        universe->nodes.begin(), universe->nodes.end());
+    for (auto* node : nodes) { destroyNode(node); }
+    universes().erase(universe);
+    delete universe;
+}
+
+void noopNode(AtNode*) {}
+
+void noopEvaluate(AtNode*, AtShaderGlobals*) {}
+
+void installBuiltin(
+    int type, uint8_t outputType, const char* name,
+    void (*parameters)(AtList*, AtNodeEntry*)) {
+    if (AiNodeEntryLookUp(name) != nullptr) { return; }
+    const AtNodeMethods methods = {
+        parameters, noopNode, noopNode, noopNode, noopEvaluate};
+    AiNodeEntryInstall(type, outputType, name, "", &methods, AI_VERSION);
+}
+
+AtArray* identityMatrixArray() {
+    auto* ret = AiArrayAllocate(1, 1, AI_TYPE_MATRIX);
+    AiArraySetMtx(ret, 0, AiM4Identity());
+    return ret;
+}
+
+// Parameters shared by every shape.
+void shapeParameters(AtList* params) {
+    AiParameterArray("matrix", identityMatrixArray());
+    AiParameterByte("visibility", AI_RAY_ALL);
+    AiParameterByte("sidedness", AI_RAY_ALL);
+    AiParameterBool("receive_shadows", true);
+    AiParameterBool("self_shadows", true);
+    AiParameterBool("opaque", true);
+    AiParameterBool("matte", false);
+    AiParameterNode("shader", nullptr);
+    AiParameterUInt("id", 0);
+    AiParameterFlt("motion_start", 0.0f);
+    AiParameterFlt("motion_end", 1.0f);
+    AiParameterBool("use_light_group", false);
+    AiParameterArray("light_group", AiArrayAllocate(0, 1, AI_TYPE_NODE));
+    AiParameterBool("use_shadow_group", false);
+    AiParameterArray("shadow_group", AiArrayAllocate(0, 1, AI_TYPE_NODE));
+}
+
+const char* subdivTypes[] = {"none", "catclark", "linear", nullptr};
+const char* coordSpaces[] = {"world", "object", "Pref", nullptr};
+const char* filterTypes[] = {
+    "closest", "bilinear", "bicubic", "smart_bicubic", nullptr};
+const char* wrapModes[] = {
+    "periodic", "black", "clamp", "mirror", "file", nullptr};
+
+} // namespace
+
+// Strings
+
+const char* AiCreateAtStringData_private(const char* str) {
+    if (str == nullptr || str[0] == '\0') { return nullptr; }
+    std::lock_guard<std::mutex> lock(stringsMutex());
+    return strings().emplace(str).first->c_str();
+}
+
+size_t AiAtStringLength(const char* str) {
+    return str == nullptr ? 0 : strlen(str);
+}
+
+size_t AiAtStringHash(const char* str) {
+    // Strings are interned, so the address is a stable and unique hash.
+    return std::hash<const void*>()(str);
+}
+
+// Session
+
+void AiBegin(AtSessionMode) {
+    MOCK_CALL();
+    ScopedLock lock(sceneMutex());
+    if (defaultUniverse != nullptr) {
+        AiMsgWarning("AiBegin: there is an active session");
+        return;
+    }
+    defaultUniverse = new AtUniverse;
+    universes().insert(defaultUniverse);
+    ArnoldMock::InstallBuiltinNodes();
+}
+
+void AiEnd() {
+    MOCK_CALL();
+    ScopedLock lock(sceneMutex());
+    std::vector<AtUniverse*> remaining(universes().begin(), universes().end());
+    for (auto* universe : remaining) { destroyUniverse(universe); }
+    defaultUniverse = nullptr;
+    nodeEntries().clear();
+    nodeEntryOrder().clear();
+}
+
+const char* AiGetVersion(char* arch, char* major, char* minor, char* fix) {
+    MOCK_CALL();
+    if (arch != nullptr) {
+        snprintf(arch, 8, "%d", AI_VERSION_ARCH_NUM);
+    }
+    if (major != nullptr) {
+        snprintf(major, 8, "%d", AI_VERSION_MAJOR_NUM);
+    }
+    if (minor != nullptr) {
+        snprintf(minor, 8, "%d", AI_VERSION_MINOR_NUM);
+    }
+    if (fix != nullptr) { snprintf(fix, 32, "%s", AI_VERSION_FIX); }
+    return AI_VERSION;
+}
+
+AtUniverse* AiUniverse() {
+    MOCK_CALL();
+    ScopedLock lock(sceneMutex());
+    if (defaultUniverse == nullptr) {
+        AiMsgError("AiUniverse: called outside of an AiBegin/AiEnd block");
+        return nullptr;
+    }
+    auto* ret = new AtUniverse;
+    universes().insert(ret);
+    return ret;
+}
+
+void AiUniverseDestroy(AtUniverse* universe) {
+    MOCK_CALL();
+    ScopedLock lock(sceneMutex());
+    if (universe == nullptr || universe == defaultUniverse ||
+        universes().find(universe) == universes().end()) {
+        return;
+    }
+    destroyUniverse(universe);
+}
+
+bool AiUniverseIsActive() {
+    MOCK_CALL();
+    ScopedLock lock(sceneMutex());
+    return defaultUniverse != nullptr;
+}
+
+AtNodeIterator* AiUniverseGetNodeIterator(unsigned int node_mask) {
+    return AiUniverseGetNodeIterator(nullptr, node_mask);
+}
+
+AtNodeIterator* AiUniverseGetNodeIterator(
+    const AtUniverse* universe, unsigned int node_mask) {
+    MOCK_CALL();
+    ScopedLock lock(sceneMutex());
+    auto* ret = new AtNodeIterator;
+    ret->index = 0;
+    const auto* u = getUniverse(universe);
+    if (u == nullptr) { return ret; }
+    for (auto* node : u->nodes) {
+        if ((node->entry->type & node_mask) != 0) {
+            ret->nodes.push_back(node);
+        }
+    }
+    return ret;
+}
+
+AtNodeEntryIterator* AiUniverseGetNodeEntryIterator(unsigned int node_mask) {
+    MOCK_CALL();
+    ScopedLock lock(sceneMutex());
+    auto* ret = new AtNodeEntryIterator;
+    ret->index = 0;
+    for (auto* entry : nodeEntryOrder()) {
+        if ((entry->type & node_mask) != 0) { ret->entries.push_back(entry); }
+    }
+    return ret;
+}
+
+AtNode* AiUniverseGetOptions(const AtUniverse* universe) {
+    MOCK_CALL();
+    ScopedLock lock(sceneMutex());
+    auto* u = getUniverse(universe);
+    if (u == nullptr) { return nullptr; }
+    if (u->options == nullptr) {
+        u->options = AiNode(u, optionsStr, optionsStr);
+    }
+    return u->options;
+}
+
+void AiLoadPlugins(const char*) { MOCK_CALL(); }
+
+bool AiMetaDataLoadFile(const char*) {
+    MOCK_CALL();
+    return false;
+}
+
+// Messages
+
+void AiMsgSetConsoleFlags(int flags) {
+    MOCK_CALL();
+    consoleFlags = flags;
+}
+
+void AiMsgInfo(const char* format, ...) {
+    va_list ap;
+    va_start(ap, format);
+    printMessage(AI_LOG_INFO, "", format, ap);
+    va_end(ap);
+}
+
+void AiMsgDebug(const char* format, ...) {
+    va_list ap;
+    va_start(ap, format);
+    printMessage(AI_LOG_DEBUG, "", format, ap);
+    va_end(ap);
+}
+
+void AiMsgWarning(const char* format, ...) {
+    va_list ap;
+    va_start(ap, format);
+    printMessage(AI_LOG_WARNINGS, "WARNING | ", format, ap);
+    va_end(ap);
+}
+
+void AiMsgError(const char* format, ...) {
+    va_list ap;
+    va_start(ap, format);
+    printMessage(AI_LOG_ERRORS, "ERROR | ", format, ap);
+    va_end(ap);
+}
+
+// Node entries
+
+void AiNodeEntryInstall(
+    int type, uint8_t output_type, const char* name, const char* filename,
+    const AtNodeMethods* methods, const char* version) {
+    MOCK_CALL();
+    ScopedLock lock(sceneMutex());
+    const AtString entryName(name);
+    if (entryName.empty() || methods == nullptr) { return; }
+    if (nodeEntries().find(entryName) != nodeEntries().end()) {
+        AiMsgWarning("AiNodeEntryInstall: %s is already installed", name);
+        return;
+    }
+    auto* entry = new AtNodeEntry;
+    entry->name = entryName;
+    entry->type = type;
+    entry->outputType = output_type;
+    entry->filename = filename == nullptr ? "" : filename;
+    entry->version = version == nullptr ? "" : version;
+    entry->methods = *methods;
+    nodeEntries()[entryName].reset(entry);
+    nodeEntryOrder().push_back(entry);
+
+    AtList params{entry};
+    AiNodeParamStr(&params, -1, "name", "");
+    if (methods->Parameters != nullptr) {
+        methods->Parameters(&params, entry);
+    }
+}
+
+void AiNodeEntryUninstall(const char* name) {
+    MOCK_CALL();
+    ScopedLock lock(sceneMutex());
+    const auto it = nodeEntries().find(AtString(name));
+    if (it == nodeEntries().end()) { return; }
+    if (it->second->count > 0) {
+        AiMsgWarning(
+            "AiNodeEntryUninstall: %s still has %d nodes", name,
+            it->second->count);
+        return;
+    }
+    auto& order = nodeEntryOrder();
+    order.erase(std::remove(order.begin(), order.end(), it->second.get()));
+    nodeEntries().erase(it);
+}
+
+const AtNodeEntry* AiNodeEntryLookUp(const AtString name) {
+    MOCK_CALL();
+    ScopedLock lock(sceneMutex());
+    const auto it = nodeEntries().find(name);
+    return it == nodeEntries().end() ? nullptr : it->second.get();
+}
+
+const char* AiNodeEntryGetName(const AtNodeEntry* nentry) {
+    MOCK_CALL();
+    return nentry == nullptr ? nullptr : nentry->name.c_str();
+}
+
+AtString AiNodeEntryGetNameAtString(const AtNodeEntry* nentry) {
+    MOCK_CALL();
+    return nentry == nullptr ? AtString() : nentry->name;
+}
+
+int AiNodeEntryGetType(const AtNodeEntry* nentry) {
+    MOCK_CALL();
+    return nentry == nullptr ? AI_NODE_UNDEFINED : nentry->type;
+}
+
+const char* AiNodeEntryGetTypeName(const AtNodeEntry* nentry) {
+    MOCK_CALL();
+    if (nentry == nullptr) { return nullptr; }
+    switch (nentry->type) {
+        case AI_NODE_OPTIONS:
+            return "options";
+        case AI_NODE_CAMERA:
+            return "camera";
+        case AI_NODE_LIGHT:
+            return "light";
+        case AI_NODE_SHAPE:
+        case AI_NODE_SHAPE_PROCEDURAL:
+        case AI_NODE_SHAPE_VOLUME:
+        case AI_NODE_SHAPE_IMPLICIT:
+            return "shape";
+        case AI_NODE_SHADER:
+            return "shader";
+        case AI_NODE_OVERRIDE:
+            return "override";
+        case AI_NODE_DRIVER:
+            return "driver";
+        case AI_NODE_FILTER:
+            return "filter";
+        case AI_NODE_COLOR_MANAGER:
+            return "color_manager";
+        case AI_NODE_OPERATOR:
+            return "operator";
+        default:
+            return "undefined";
+    }
+}
+
+int AiNodeEntryGetOutputType(const AtNodeEntry* nentry) {
+    MOCK_CALL();
+    return nentry == nullptr ? AI_TYPE_NONE : nentry->outputType;
+}
+
+const char* AiNodeEntryGetFilename(const AtNodeEntry* nentry) {
+    MOCK_CALL();
+    if (nentry == nullptr || nentry->filename.empty()) { return nullptr; }
+    return nentry->filename.c_str();
+}
+
+const char* AiNodeEntryGetVersion(const AtNodeEntry* nentry) {
+    MOCK_CALL();
+    return nentry == nullptr ? nullptr : nentry->version.c_str();
+}
+
+int AiNodeEntryGetCount(const AtNodeEntry* nentry) {
+    MOCK_CALL();
+    return nentry == nullptr ? 0 : nentry->count;
+}
+
+int AiNodeEntryGetNumParams(const AtNodeEntry* nentry) {
+    MOCK_CALL();
+    return nentry == nullptr ? 0 : static_cast<int>(nentry->params.size());
+}
+
+const AtParamEntry* AiNodeEntryGetParameter(
+    const AtNodeEntry* nentry, int i) {
+    MOCK_CALL();
+    if (nentry == nullptr || i < 0 ||
+        static_cast<size_t>(i) >= nentry->params.size()) {
+        return nullptr;
+    }
+    return nentry->params[i].get();
+}
+
+const AtParamEntry* AiNodeEntryLookUpParameter(
+    const AtNodeEntry* nentry, const AtString param) {
+    MOCK_CALL();
+    if (nentry == nullptr) { return nullptr; }
+    const auto it = nentry->paramIndices.find(param);
+    return it == nentry->paramIndices.end() ? nullptr
+                                            : nentry->params[it->second].get();
+}
+
+AtParamIterator* AiNodeEntryGetParamIterator(const AtNodeEntry* nentry) {
+    MOCK_CALL();
+    return new AtParamIterator{nentry, 0};
+}
+
+AtMetaDataIterator* AiNodeEntryGetMetaDataIterator(
+    const AtNodeEntry* nentry, const char* param) {
+    MOCK_CALL();
+    auto* ret = new AtMetaDataIterator;
+    ret->index = 0;
+    if (nentry == nullptr) { return ret; }
+    // Without a parameter name, Arnold iterates over every entry.
+    const auto hasParam = param != nullptr;
+    const AtString paramStr(param);
+    for (const auto& it : nentry->metadata) {
+        if (!hasParam || it.param == paramStr) { ret->entries.push_back(&it); }
+    }
+    return ret;
+}
+
+void AiNodeEntryIteratorDestroy(AtNodeEntryIterator* iter) {
+    MOCK_CALL();
+    delete iter;
+}
+
+AtNodeEntry* AiNodeEntryIteratorGetNext(AtNodeEntryIterator* iter) {
+    MOCK_CALL();
+    if (iter == nullptr || iter->index >= iter->entries.size()) {
+        return nullptr;
+    }
+    return iter->entries[iter->index++];
+}
+
+bool AiNodeEntryIteratorFinished(const AtNodeEntryIterator* iter) {
+    MOCK_CALL();
+    return iter == nullptr || iter->index >= iter->entries.size();
+}
+
+// Parameter entries
+
+AtString AiParamGetName(const AtParamEntry* pentry) {
+    MOCK_CALL();
+    return pentry == nullptr ? AtString() : pentry->name;
+}
+
+uint8_t AiParamGetType(const AtParamEntry* pentry) {
+    MOCK_CALL();
+    return pentry == nullptr ? AI_TYPE_NONE : pentry->type;
+}
+
+uint8_t AiParamGetSubType(const AtParamEntry* pentry) {
+    MOCK_CALL();
+    return pentry == nullptr ? AI_TYPE_NONE : pentry->subtype;
+}
+
+const AtParamValue* AiParamGetDefault(const AtParamEntry* pentry) {
+    MOCK_CALL();
+    return pentry == nullptr ? nullptr : &pentry->defaultValue;
+}
+
+AtEnum AiParamGetEnum(const AtParamEntry* pentry) {
+    MOCK_CALL();
+    if (pentry == nullptr || pentry->enumValues.empty()) { return nullptr; }
+    return const_cast<const char**>(pentry->enumValues.data());
+}
+
+const char* AiParamGetTypeName(uint8_t type) {
+    switch (type) {
+        case AI_TYPE_BYTE:
+            return "BYTE";
+        case AI_TYPE_INT:
+            return "INT";
+        case AI_TYPE_UINT:
+            return "UINT";
+        case AI_TYPE_BOOLEAN:
+            return "BOOL";
+        case AI_TYPE_FLOAT:
+            return "FLOAT";
+        case AI_TYPE_RGB:
+            return "RGB";
+        case AI_TYPE_RGBA:
+            return "RGBA";
+        case AI_TYPE_VECTOR:
+            return "VECTOR";
+        case AI_TYPE_VECTOR2:
+            return "VECTOR2";
+        case AI_TYPE_STRING:
+            return "STRING";
+        case AI_TYPE_POINTER:
+            return "POINTER";
+        case AI_TYPE_NODE:
+            return "NODE";
+        case AI_TYPE_ARRAY:
+            return "ARRAY";
+        case AI_TYPE_MATRIX:
+            return "MATRIX";
+        case AI_TYPE_ENUM:
+            return "ENUM";
+        case AI_TYPE_CLOSURE:
+            return "CLOSURE";
+        case AI_TYPE_USHORT:
+            return "USHORT";
+        case AI_TYPE_HALF:
+            return "HALF";
+        default:
+            return "UNDEFINED";
+    }
+}
+
+int AiParamGetTypeSize(uint8_t type) {
+    return static_cast<int>(getTypeSize(type));
+}
+
+void AiParamIteratorDestroy(AtParamIterator* iter) {
+    MOCK_CALL();
+    delete iter;
+}
+
+const AtParamEntry* AiParamIteratorGetNext(AtParamIterator* iter) {
+    MOCK_CALL();
+    if (AiParamIteratorFinished(iter)) { return nullptr; }
+    return iter->entry->params[iter->index++].get();
+}
+
+bool AiParamIteratorFinished(const AtParamIterator* iter) {
+    return iter == nullptr || iter->entry == nullptr ||
+           iter->index >= iter->entry->params.size();
+}
+
+void AiNodeParamByte(
+    AtList* params, int, const char* pname, uint8_t pdefault) {
+    MOCK_CALL();
+    auto* param = addParameter(params, pname, AI_TYPE_BYTE);
+    if (param != nullptr) { param->defaultValue.BYTE() = pdefault; }
+}
+
+void AiNodeParamInt(AtList* params, int, const char* pname, int pdefault) {
+    MOCK_CALL();
+    auto* param = addParameter(params, pname, AI_TYPE_INT);
+    if (param != nullptr) { param->defaultValue.INT() = pdefault; }
+}
+
+void AiNodeParamUInt(
+    AtList* params, int, const char* pname, unsigned int pdefault) {
+    MOCK_CALL();
+    auto* param = addParameter(params, pname, AI_TYPE_UINT);
+    if (param != nullptr) { param->defaultValue.UINT() = pdefault; }
+}
+
+void AiNodeParamBool(AtList* params, int, const char* pname, bool pdefault) {
+    MOCK_CALL();
+    auto* param = addParameter(params, pname, AI_TYPE_BOOLEAN);
+    if (param != nullptr) { param->defaultValue.BOOL() = pdefault; }
+}
+
+void AiNodeParamFlt(AtList* params, int, const char* pname, float pdefault) {
+    MOCK_CALL();
+    auto* param = addParameter(params, pname, AI_TYPE_FLOAT);
+    if (param != nullptr) { param->defaultValue.FLT() = pdefault; }
+}
+
+void AiNodeParamRGB(
+    AtList* params, int, const char* pname, float r, float g, float b) {
+    MOCK_CALL();
+    auto* param = addParameter(params, pname, AI_TYPE_RGB);
+    if (param != nullptr) { param->defaultValue.RGB() = AtRGB(r, g, b); }
+}
+
+void AiNodeParamRGBA(
+    AtList* params, int, const char* pname, float r, float g, float b,
+    float a) {
+    MOCK_CALL();
+    auto* param = addParameter(params, pname, AI_TYPE_RGBA);
+    if (param != nullptr) { param->defaultValue.RGBA() = AtRGBA(r, g, b, a); }
+}
+
+void AiNodeParamVec(
+    AtList* params, int, const char* pname, float x, float y, float z) {
+    MOCK_CALL();
+    auto* param = addParameter(params, pname, AI_TYPE_VECTOR);
+    if (param != nullptr) { param->defaultValue.VEC() = AtVector(x, y, z); }
+}
+
+void AiNodeParamVec2(
+    AtList* params, int, const char* pname, float x, float y) {
+    MOCK_CALL();
+    auto* param = addParameter(params, pname, AI_TYPE_VECTOR2);
+    if (param != nullptr) { param->defaultValue.VEC2() = AtVector2(x, y); }
+}
+
+void AiNodeParamStr(
+    AtList* params, int, const char* pname, const char* pdefault) {
+    MOCK_CALL();
+    auto* param = addParameter(params, pname, AI_TYPE_STRING);
+    if (param != nullptr) { param->defaultValue.STR() = AtString(pdefault); }
+}
+
+void AiNodeParamPtr(AtList* params, int, const char* pname, void* pdefault) {
+    MOCK_CALL();
+    auto* param = addParameter(params, pname, AI_TYPE_POINTER);
+    if (param != nullptr) { param->defaultValue.PTR() = pdefault; }
+}
+
+void AiNodeParamNode(
+    AtList* params, int, const char* pname, AtNode* pdefault) {
+    MOCK_CALL();
+    auto* param = addParameter(params, pname, AI_TYPE_NODE);
+    if (param != nullptr) { param->defaultValue.PTR() = pdefault; }
+}
+
+void AiNodeParamArray(
+    AtList* params, int, const char* pname, AtArray* pdefault) {
+    MOCK_CALL();
+    auto* param = addParameter(params, pname, AI_TYPE_ARRAY);
+    if (param == nullptr) {
+        AiArrayDestroy(pdefault);
+        return;
+    }
+    // The entry owns the default, and the nodes own a copy of it.
+    param->defaultValue.ARRAY() = pdefault;
+    param->subtype = pdefault == nullptr ? AI_TYPE_NONE : pdefault->type;
+}
+
+void AiNodeParamMtx(
+    AtList* params, int, const char* pname, AtMatrix matrix) {
+    MOCK_CALL();
+    auto* param = addParameter(params, pname, AI_TYPE_MATRIX);
+    if (param == nullptr) { return; }
+    param->defaultMatrix = matrix;
+    param->defaultValue.pMTX() = &param->defaultMatrix;
+}
+
+void AiNodeParamEnum(
+    AtList* params, int, const char* pname, int pdefault, AtEnum enum_type) {
+    MOCK_CALL();
+    auto* param = addParameter(params, pname, AI_TYPE_ENUM);
+    if (param == nullptr) { return; }
+    param->defaultValue.INT() = pdefault;
+    for (auto* it = enum_type; it != nullptr && *it != nullptr; ++it) {
+        param->enumValues.push_back(AtString(*it).c_str());
+    }
+    param->enumValues.push_back(nullptr);
+}
+
+void AiNodeParamClosure(AtList* params, int, const char* pname) {
+    MOCK_CALL();
+    addParameter(params, pname, AI_TYPE_CLOSURE);
+}
+
+// Metadata
+
+#define MOCK_METADATA_FUNCTIONS(Name, SetType, GetType, TypeEnum, Accessor) \
+    void AiMetaDataSet##Name(                                              \
+        AtNodeEntry* nentry, const AtString param, const AtString name,    \
+        SetType value) {                                                   \
+        MOCK_CALL();                                                       \
+        AtParamValue v;                                                    \
+        v.Accessor() = value;                                              \
+        setMetaData(nentry, param, name, TypeEnum, v);                     \
+    }                                                                      \
+    bool AiMetaDataGet##Name(                                              \
+        const AtNodeEntry* nentry, const AtString param,                   \
+        const AtString name, GetType* value) {                             \
+        MOCK_CALL();                                                       \
+        const auto* entry = getMetaData(nentry, param, name, TypeEnum);    \
+        if (entry == nullptr) { return false; }                            \
+        if (value != nullptr) { *value = entry->value.Accessor(); }        \
+        return true;                                                       \
+    }
+
+MOCK_METADATA_FUNCTIONS(Bool, bool, bool, AI_TYPE_BOOLEAN, BOOL)
+MOCK_METADATA_FUNCTIONS(Int, int, int, AI_TYPE_INT, INT)
+MOCK_METADATA_FUNCTIONS(Flt, float, float, AI_TYPE_FLOAT, FLT)
+MOCK_METADATA_FUNCTIONS(RGB, const AtRGB&, AtRGB, AI_TYPE_RGB, RGB)
+MOCK_METADATA_FUNCTIONS(Vec, const AtVector&, AtVector, AI_TYPE_VECTOR, VEC)
+MOCK_METADATA_FUNCTIONS(
+    Vec2, const AtVector2&, AtVector2, AI_TYPE_VECTOR2, VEC2)
+MOCK_METADATA_FUNCTIONS(Str, const AtString, AtString, AI_TYPE_STRING, STR)
+
+#undef MOCK_METADATA_FUNCTIONS
+
+void AiMetaDataIteratorDestroy(AtMetaDataIterator* iter) {
+    MOCK_CALL();
+    delete iter;
+}
+
+const AtMetaDataEntry* AiMetaDataIteratorGetNext(AtMetaDataIterator* iter) {
+    MOCK_CALL();
+    if (iter == nullptr || iter->index >= iter->entries.size()) {
+        return nullptr;
+    }
+    return iter->entries[iter->index++];
+}
+
+bool AiMetaDataIteratorFinished(const AtMetaDataIterator* iter) {
+    MOCK_CALL();
+    return iter == nullptr || iter->index >= iter->entries.size();
+}
+
+// Nodes
+
+AtNode* AiNode(
+    AtUniverse* universe, const AtString nentry_name, const AtString name,
+    const AtNode*) {
+    MOCK_CALL();
+    ScopedLock lock(sceneMutex());
+    auto* u = getUniverse(universe);
+    if (u == nullptr) {
+        AiMsgError("AiNode: called outside of an AiBegin/AiEnd block");
+        return nullptr;
+    }
+    const auto entryIt = nodeEntries().find(nentry_name);
+    if (entryIt == nodeEntries().end()) {
+        AiMsgWarning("AiNode: %s is not installed", nentry_name.c_str());
+        return nullptr;
+    }
+    auto* entry = entryIt->second.get();
+    auto* node = new AtNode;
+    node->entry = entry;
+    node->universe = u;
+    node->slots.resize(entry->params.size());
+    for (size_t i = 0; i < entry->params.size(); ++i) {
+        auto& slot = node->slots[i];
+        slot.entry = entry->params[i].get();
+        slot.type = slot.entry->type;
+        slot.subtype = slot.entry->subtype;
+        resetSlot(slot);
+    }
+    entry->count += 1;
+    u->nodes.insert(node);
+    setNodeName(node, name);
+    return node;
+}
+
+AtNode* AiNodeLookUpByName(
+    const AtUniverse* universe, const AtString name, const AtNode*) {
+    MOCK_CALL();
+    ScopedLock lock(sceneMutex());
+    const auto* u = getUniverse(universe);
+    if (u == nullptr) { return nullptr; }
+    const auto it = u->nodesByName.find(name);
+    return it == u->nodesByName.end() ? nullptr : it->second;
+}
+
+bool AiNodeDestroy(AtNode* node) {
+    MOCK_CALL();
+    if (node == nullptr) { return false; }
+    ScopedLock lock(sceneMutex());
+    destroyNode(node);
+    return true;
+}
+
+void AiNodeReplace(AtNode* old_node, AtNode* new_node, bool remove) {
+    MOCK_CALL();
+    if (old_node == nullptr || new_node == nullptr) { return; }
+    ScopedLock lock(sceneMutex());
+    for (auto* target : old_node->targets) {
+        for (auto& it : target->links) {
+            if (it.second.source == old_node) {
+                it.second.source = new_node;
+                new_node->targets.insert(target);
+            }
+        }
+    }
+    old_node->targets.clear();
+    // Node and node array parameters referencing the old node.
+    for (auto* node : old_node->universe->nodes) {
+        for (auto& slot : node->slots) {
+            if (slot.type == AI_TYPE_NODE && slot.value.PTR() == old_node) {
+                slot.value.PTR() = new_node;
+                continue;
+            }
+            auto* array = slot.type == AI_TYPE_ARRAY ? slot.value.ARRAY()
+                                                     : nullptr;
+            if (array != nullptr && array->type == AI_TYPE_NODE) {
+                auto* data = static_cast<AtNode**>(AiArrayMap(array));
+                const auto count = array->nelements * array->nkeys;
+                std::replace(data, data + count, old_node, new_node);
+                AiArrayUnmap(array);
+            }
+        }
+    }
+    if (remove) { destroyNode(old_node); }
+}
+
+void AiNodeResetParameter(AtNode* node, const char* param) {
+    MOCK_CALL();
+    const AtString paramStr(param);
+    auto* slot = findSlot(node, paramStr);
+    if (slot == nullptr) { return; }
+    removeLink(node, paramStr.c_str());
+    if (slot->entry == nullptr) {
+        ScopedLock lock(sceneMutex());
+        const auto it = node->userIndices.find(paramStr);
+        // Keeping the slot, so the indices of the other user parameters are
+        // stable.
+        if (slot->type == AI_TYPE_ARRAY) {
+            AiArrayDestroy(slot->value.ARRAY());
+        }
+        slot->type = AI_TYPE_NONE;
+        slot->value = AtParamValue();
+        node->userParams.erase(std::remove_if(
+            node->userParams.begin(), node->userParams.end(),
+            [&](const std::unique_ptr<AtUserParamEntry>& entry) {
+                return entry->name == paramStr;
+            }), node->userParams.end());
+        node->userIndices.erase(it);
+    } else if (paramStr == nameStr) {
+        setNodeName(node, AtString());
+    } else {
+        resetSlot(*slot);
+    }
+}
+
+const AtNodeEntry* AiNodeGetNodeEntry(const AtNode* node) {
+    MOCK_CALL();
+    return node == nullptr ? nullptr : node->entry;
+}
+
+const char* AiNodeGetName(const AtNode* node) {
+    MOCK_CALL();
+    return node == nullptr ? nullptr : node->name.c_str();
+}
+
+AtUniverse* AiNodeGetUniverse(const AtNode* node) {
+    MOCK_CALL();
+    return node == nullptr ? nullptr : node->universe;
+}
+
+bool AiNodeIs(const AtNode* node, const AtString str) {
+    MOCK_CALL();
+    return node != nullptr && node->entry->name == str;
+}
+
+void* AiNodeGetLocalData(const AtNode* node) {
+    MOCK_CALL();
+    return node == nullptr ? nullptr : node->localData;
+}
+
+void AiNodeSetLocalData(AtNode* node, void* data) {
+    MOCK_CALL();
+    if (node != nullptr) { node->localData = data; }
+}
+
+void AiNodeIteratorDestroy(AtNodeIterator* iter) {
+    MOCK_CALL();
+    delete iter;
+}
+
+AtNode* AiNodeIteratorGetNext(AtNodeIterator* iter) {
+    MOCK_CALL();
+    if (iter == nullptr || iter->index >= iter->nodes.size()) {
+        return nullptr;
+    }
+    return iter->nodes[iter->index++];
+}
+
+bool AiNodeIteratorFinished(const AtNodeIterator* iter) {
+    MOCK_CALL();
+    return iter == nullptr || iter->index >= iter->nodes.size();
+}
+
+// Node parameters
+
+void AiNodeSetByte(AtNode* node, const AtString param, uint8_t val) {
+    MOCK_CALL();
+    auto* slot = findSlot(
+        node, param, {AI_TYPE_BYTE, AI_TYPE_INT, AI_TYPE_UINT}, __func__);
+    if (slot == nullptr) { return; }
+    if (slot->type == AI_TYPE_BYTE) {
+        slot->value.BYTE() = val;
+    } else {
+        slot->value.INT() = val;
+    }
+}
+
+void AiNodeSetInt(AtNode* node, const AtString param, int val) {
+    MOCK_CALL();
+    auto* slot = findSlot(
+        node, param, {AI_TYPE_INT, AI_TYPE_UINT, AI_TYPE_ENUM, AI_TYPE_BYTE},
+        __func__);
+    if (slot == nullptr) { return; }
+    if (slot->type == AI_TYPE_BYTE) {
+        slot->value.BYTE() = static_cast<uint8_t>(val);
+    } else {
+        slot->value.INT() = val;
+    }
+}
+
+void AiNodeSetUInt(AtNode* node, const AtString param, unsigned int val) {
+    MOCK_CALL();
+    auto* slot =
+        findSlot(node, param, {AI_TYPE_UINT, AI_TYPE_INT}, __func__);
+    if (slot != nullptr) { slot->value.UINT() = val; }
+}
+
+void AiNodeSetBool(AtNode* node, const AtString param, bool val) {
+    MOCK_CALL();
+    auto* slot = findSlot(node, param, {AI_TYPE_BOOLEAN}, __func__);
+    if (slot != nullptr) { slot->value.BOOL() = val; }
+}
+
+void AiNodeSetFlt(AtNode* node, const AtString param, float val) {
+    MOCK_CALL();
+    auto* slot = findSlot(node, param, {AI_TYPE_FLOAT}, __func__);
+    if (slot != nullptr) { slot->value.FLT() = val; }
+}
+
+void AiNodeSetPtr(AtNode* node, const AtString param, void* val) {
+    MOCK_CALL();
+    auto* slot =
+        findSlot(node, param, {AI_TYPE_POINTER, AI_TYPE_NODE}, __func__);
+    if (slot != nullptr) { slot->value.PTR() = val; }
+}
+
+void AiNodeSetArray(AtNode* node, const AtString param, AtArray* val) {
+    MOCK_CALL();
+    auto* slot = findSlot(node, param, {AI_TYPE_ARRAY}, __func__);
+    if (slot == nullptr) {
+        // Arnold takes ownership even when the parameter does not exist.
+        AiArrayDestroy(val);
+        return;
+    }
+    if (slot->value.ARRAY() != val) { AiArrayDestroy(slot->value.ARRAY()); }
+    slot->value.ARRAY() = val;
+}
+
+void AiNodeSetMatrix(AtNode* node, const AtString param, AtMatrix val) {
+    MOCK_CALL();
+    auto* slot = findSlot(node, param, {AI_TYPE_MATRIX}, __func__);
+    if (slot == nullptr) { return; }
+    slot->matrix = val;
+    slot->value.pMTX() = &slot->matrix;
+}
+
+void AiNodeSetStr(AtNode* node, const AtString param, AtString str) {
+    MOCK_CALL();
+    auto* slot =
+        findSlot(node, param, {AI_TYPE_STRING, AI_TYPE_ENUM}, __func__);
+    if (slot == nullptr) { return; }
+    if (slot->type == AI_TYPE_STRING) {
+        if (slot->entry != nullptr && param == nameStr) {
+            setNodeName(node, str);
+        } else {
+            slot->value.STR() = str;
+        }
+        return;
+    }
+    // Enums can be set via the name of the value.
+    const auto& values = slot->entry->enumValues;
+    for (size_t i = 0; i + 1 < values.size(); ++i) {
+        if (str == values[i]) {
+            slot->value.INT() = static_cast<int>(i);
+            return;
+        }
+    }
+    AiMsgWarning(
+        "AiNodeSetStr: %s is not a valid value for %s.%s", str.c_str(),
+        AiNodeGetName(node), param.c_str());
+}
+
+void AiNodeSetRGB(
+    AtNode* node, const AtString param, float r, float g, float b) {
+    MOCK_CALL();
+    auto* slot = findSlot(
+        node, param, {AI_TYPE_RGB, AI_TYPE_RGBA, AI_TYPE_VECTOR}, __func__);
+    if (slot == nullptr) { return; }
+    if (slot->type == AI_TYPE_RGBA) {
+        slot->value.RGBA() = AtRGBA(r, g, b, 1.0f);
+    } else {
+        slot->value.RGB() = AtRGB(r, g, b);
+    }
+}
+
+void AiNodeSetRGBA(
+    AtNode* node, const AtString param, float r, float g, float b, float a) {
+    MOCK_CALL();
+    auto* slot =
+        findSlot(node, param, {AI_TYPE_RGBA, AI_TYPE_RGB}, __func__);
+    if (slot == nullptr) { return; }
+    if (slot->type == AI_TYPE_RGB) {
+        slot->value.RGB() = AtRGB(r, g, b);
+    } else {
+        slot->value.RGBA() = AtRGBA(r, g, b, a);
+    }
+}
+
+void AiNodeSetVec(
+    AtNode* node, const AtString param, float x, float y, float z) {
+    MOCK_CALL();
+    auto* slot =
+        findSlot(node, param, {AI_TYPE_VECTOR, AI_TYPE_RGB}, __func__);
+    if (slot != nullptr) { slot->value.VEC() = AtVector(x, y, z); }
+}
+
+void AiNodeSetVec2(AtNode* node, const AtString param, float x, float y) {
+    MOCK_CALL();
+    auto* slot = findSlot(node, param, {AI_TYPE_VECTOR2}, __func__);
+    if (slot != nullptr) { slot->value.VEC2() = AtVector2(x, y); }
+}
+
+uint8_t AiNodeGetByte(const AtNode* node, const AtString param) {
+    MOCK_CALL();
+    const auto* slot = findSlot(node, param, {AI_TYPE_BYTE}, __func__);
+    return slot == nullptr ? 0 : slot->value.BYTE();
+}
+
+int AiNodeGetInt(const AtNode* node, const AtString param) {
+    MOCK_CALL();
+    const auto* slot = findSlot(
+        node, param, {AI_TYPE_INT, AI_TYPE_UINT, AI_TYPE_ENUM, AI_TYPE_BYTE},
+        __func__);
+    if (slot == nullptr) { return 0; }
+    return slot->type == AI_TYPE_BYTE ? slot->value.BYTE()
+                                      : slot->value.INT();
+}
+
+unsigned int AiNodeGetUInt(const AtNode* node, const AtString param) {
+    MOCK_CALL();
+    const auto* slot =
+        findSlot(node, param, {AI_TYPE_UINT, AI_TYPE_INT}, __func__);
+    return slot == nullptr ? 0 : slot->value.UINT();
+}
+
+bool AiNodeGetBool(const AtNode* node, const AtString param) {
+    MOCK_CALL();
+    const auto* slot = findSlot(node, param, {AI_TYPE_BOOLEAN}, __func__);
+    return slot != nullptr && slot->value.BOOL();
+}
+
+float AiNodeGetFlt(const AtNode* node, const AtString param) {
+    MOCK_CALL();
+    const auto* slot = findSlot(node, param, {AI_TYPE_FLOAT}, __func__);
+    return slot == nullptr ? 0.0f : slot->value.FLT();
+}
+
+void* AiNodeGetPtr(const AtNode* node, const AtString param) {
+    MOCK_CALL();
+    const auto* slot =
+        findSlot(node, param, {AI_TYPE_POINTER, AI_TYPE_NODE}, __func__);
+    return slot == nullptr ? nullptr : slot->value.PTR();
+}
+
+AtArray* AiNodeGetArray(const AtNode* node, const AtString param) {
+    MOCK_CALL();
+    const auto* slot = findSlot(node, param, {AI_TYPE_ARRAY}, __func__);
+    return slot == nullptr ? nullptr : slot->value.ARRAY();
+}
+
+AtMatrix AiNodeGetMatrix(const AtNode* node, const AtString param) {
+    MOCK_CALL();
+    const auto* slot = findSlot(node, param, {AI_TYPE_MATRIX}, __func__);
+    return slot == nullptr ? AiM4Identity() : slot->matrix;
+}
+
+AtString AiNodeGetStr(const AtNode* node, const AtString param) {
+    MOCK_CALL();
+    const auto* slot =
+        findSlot(node, param, {AI_TYPE_STRING, AI_TYPE_ENUM}, __func__);
+    if (slot == nullptr) { return AtString(); }
+    if (slot->type == AI_TYPE_STRING) { return slot->value.STR(); }
+    const auto& values = slot->entry->enumValues;
+    const auto index = slot->value.INT();
+    if (index < 0 || static_cast<size_t>(index) + 1 >= values.size()) {
+        return AtString();
+    }
+    return AtString(values[index]);
+}
+
+AtRGB AiNodeGetRGB(const AtNode* node, const AtString param) {
+    MOCK_CALL();
+    const auto* slot = findSlot(
+        node, param, {AI_TYPE_RGB, AI_TYPE_RGBA, AI_TYPE_VECTOR}, __func__);
+    return slot == nullptr ? AtRGB(0.0f, 0.0f, 0.0f) : slot->value.RGB();
+}
+
+AtRGBA AiNodeGetRGBA(const AtNode* node, const AtString param) {
+    MOCK_CALL();
+    const auto* slot =
+        findSlot(node, param, {AI_TYPE_RGBA, AI_TYPE_RGB}, __func__);
+    if (slot == nullptr) { return AtRGBA(0.0f, 0.0f, 0.0f, 0.0f); }
+    if (slot->type == AI_TYPE_RGB) {
+        const auto& rgb = slot->value.RGB();
+        return AtRGBA(rgb.r, rgb.g, rgb.b, 1.0f);
+    }
+    return slot->value.RGBA();
+}
+
+AtVector AiNodeGetVec(const AtNode* node, const AtString param) {
+    MOCK_CALL();
+    const auto* slot =
+        findSlot(node, param, {AI_TYPE_VECTOR, AI_TYPE_RGB}, __func__);
+    return slot == nullptr ? AtVector(0.0f, 0.0f, 0.0f) : slot->value.VEC();
+}
+
+AtVector2 AiNodeGetVec2(const AtNode* node, const AtString param) {
+    MOCK_CALL();
+    const auto* slot = findSlot(node, param, {AI_TYPE_VECTOR2}, __func__);
+    return slot == nullptr ? AtVector2(0.0f, 0.0f) : slot->value.VEC2();
+}
+
+// User parameters
+
+bool AiNodeDeclare(
+    AtNode* node, const AtString param, const char* declaration) {
+    MOCK_CALL();
+    if (node == nullptr || param.empty()) { return false; }
+    if (findSlot(node, param) != nullptr) {
+        AiMsgWarning(
+            "AiNodeDeclare: %s already has a parameter named %s",
+            AiNodeGetName(node), param.c_str());
+        return false;
+    }
+    auto* userParam = parseDeclaration(param, declaration);
+    if (userParam == nullptr) {
+        AiMsgWarning(
+            "AiNodeDeclare: invalid declaration \"%s\" for %s.%s",
+            declaration == nullptr ? "" : declaration, AiNodeGetName(node),
+            param.c_str());
+        return false;
+    }
+    // Non-constant user data is always stored in arrays.
+    AtNode::Slot slot;
+    if (userParam->type == AI_TYPE_ARRAY) {
+        slot.type = AI_TYPE_ARRAY;
+        slot.subtype = static_cast<uint8_t>(userParam->arrayType);
+    } else if (userParam->category != AI_USERDEF_CONSTANT) {
+        slot.type = AI_TYPE_ARRAY;
+        slot.subtype = static_cast<uint8_t>(userParam->type);
+    } else {
+        slot.type = static_cast<uint8_t>(userParam->type);
+    }
+    slot.value = AtParamValue();
+    slot.matrix = AiM4Identity();
+    userParam->slot = node->slots.size();
+    node->userIndices[param] = node->slots.size();
+    node->slots.push_back(slot);
+    node->userParams.emplace_back(userParam);
+    if (userParam->category == AI_USERDEF_INDEXED) {
+        const auto idxs = std::string(param.c_str()) + "idxs";
+        AtNode::Slot idxsSlot;
+        idxsSlot.type = AI_TYPE_ARRAY;
+        idxsSlot.subtype = AI_TYPE_UINT;
+        idxsSlot.value = AtParamValue();
+        node->userIndices[AtString(idxs.c_str())] = node->slots.size();
+        node->slots.push_back(idxsSlot);
+    }
+    return true;
+}
+
+const AtUserParamEntry* AiNodeLookUpUserParameter(
+    const AtNode* node, const AtString param) {
+    MOCK_CALL();
+    if (node == nullptr) { return nullptr; }
+    for (const auto& it : node->userParams) {
+        if (it->name == param) { return it.get(); }
+    }
+    return nullptr;
+}
+
+AtUserParamIterator* AiNodeGetUserParamIterator(const AtNode* node) {
+    MOCK_CALL();
+    auto* ret = new AtUserParamIterator;
+    ret->index = 0;
+    if (node == nullptr) { return ret; }
+    for (const auto& it : node->userParams) { ret->params.push_back(it.get()); }
+    return ret;
+}
+
+const char* AiUserParamGetName(const AtUserParamEntry* upentry) {
+    MOCK_CALL();
+    return upentry == nullptr ? nullptr : upentry->name.c_str();
+}
+
+int AiUserParamGetType(const AtUserParamEntry* upentry) {
+    MOCK_CALL();
+    return upentry == nullptr ? AI_TYPE_NONE : upentry->type;
+}
+
+int AiUserParamGetArrayType(const AtUserParamEntry* upentry) {
+    MOCK_CALL();
+    return upentry == nullptr ? AI_TYPE_NONE : upentry->arrayType;
+}
+
+int AiUserParamGetCategory(const AtUserParamEntry* upentry) {
+    MOCK_CALL();
+    return upentry == nullptr ? AI_USERDEF_UNDEFINED : upentry->category;
+}
+
+void AiUserParamIteratorDestroy(AtUserParamIterator* iter) {
+    MOCK_CALL();
+    delete iter;
+}
+
+const AtUserParamEntry* AiUserParamIteratorGetNext(
+    AtUserParamIterator* iter) {
+    MOCK_CALL();
+    if (iter == nullptr || iter->index >= iter->params.size()) {
+        return nullptr;
+    }
+    return iter->params[iter->index++];
+}
+
+bool AiUserParamIteratorFinished(const AtUserParamIterator* iter) {
+    MOCK_CALL();
+    return iter == nullptr || iter->index >= iter->params.size();
+}
+
+// Links
+
+bool AiNodeLink(AtNode* src, const char* input, AtNode* target) {
+    MOCK_CALL();
+    ScopedLock lock(sceneMutex());
+    return addLink(src, -1, target, input);
+}
+
+bool AiNodeLinkOutput(
+    AtNode* src, const char* output, AtNode* target, const char* input) {
+    MOCK_CALL();
+    ScopedLock lock(sceneMutex());
+    return addLink(src, getComponentIndex(output), target, input);
+}
+
+bool AiNodeUnlink(AtNode* node, const char* input) {
+    MOCK_CALL();
+    if (node == nullptr || input == nullptr) { return false; }
+    ScopedLock lock(sceneMutex());
+    const std::string key(input);
+    const auto prefix = key + ".";
+    std::vector<std::string> inputs;
+    for (const auto& it : node->links) {
+        if (it.first == key ||
+            it.first.compare(0, prefix.size(), prefix) == 0) {
+            inputs.push_back(it.first);
+        }
+    }
+    for (const auto& it : inputs) { removeLink(node, it); }
+    return !inputs.empty();
+}
+
+bool AiNodeIsLinked(const AtNode* node, const char* input) {
+    MOCK_CALL();
+    if (node == nullptr || input == nullptr) { return false; }
+    ScopedLock lock(sceneMutex());
+    const std::string key(input);
+    if (node->links.find(key) != node->links.end()) { return true; }
+    // Linking any of the components links the parameter.
+    const auto prefix = key + ".";
+    for (const auto& it : node->links) {
+        if (it.first.compare(0, prefix.size(), prefix) == 0) { return true; }
+    }
+    return false;
+}
+
+AtNode* AiNodeGetLink(const AtNode* node, const char* input, int* comp) {
+    MOCK_CALL();
+    if (comp != nullptr) { *comp = -1; }
+    if (node == nullptr || input == nullptr) { return nullptr; }
+    ScopedLock lock(sceneMutex());
+    const auto it = node->links.find(input);
+    if (it == node->links.end()) { return nullptr; }
+    if (comp != nullptr) { *comp = it->second.component; }
+    return it->second.source;
+}
+
+// Arrays
+
+AtArray* AiArray(uint32_t nelements, uint8_t nkeys, uint8_t type, ...) {
+    MOCK_CALL();
+    auto* ret = allocateArray(nelements, nkeys, type);
+    const auto count = nelements * nkeys;
+    va_list ap;
+    va_start(ap, type);
+    for (uint32_t i = 0; i < count; ++i) {
+        auto* dest = ret->data.data() + i * getTypeSize(type);
+        switch (type) {
+            case AI_TYPE_BYTE:
+            case AI_TYPE_BOOLEAN: {
+                const auto v = static_cast<uint8_t>(va_arg(ap, int));
+                memcpy(dest, &v, sizeof(v));
+                break;
+            }
+            case AI_TYPE_INT:
+            case AI_TYPE_UINT:
+            case AI_TYPE_ENUM: {
+                const auto v = va_arg(ap, int);
+                memcpy(dest, &v, sizeof(v));
+                break;
+            }
+            case AI_TYPE_FLOAT: {
+                const auto v = static_cast<float>(va_arg(ap, double));
+                memcpy(dest, &v, sizeof(v));
+                break;
+            }
+            case AI_TYPE_STRING: {
+                const AtString v(va_arg(ap, const char*));
+                memcpy(dest, &v, sizeof(v));
+                break;
+            }
+            case AI_TYPE_POINTER:
+            case AI_TYPE_NODE:
+            case AI_TYPE_ARRAY: {
+                const auto v = va_arg(ap, void*);
+                memcpy(dest, &v, sizeof(v));
+                break;
+            }
+            case AI_TYPE_RGB: {
+                const auto v = va_arg(ap, AtRGB);
+                memcpy(dest, &v, sizeof(v));
+                break;
+            }
+            case AI_TYPE_RGBA: {
+                const auto v = va_arg(ap, AtRGBA);
+                memcpy(dest, &v, sizeof(v));
+                break;
+            }
+            case AI_TYPE_VECTOR: {
+                const auto v = va_arg(ap, AtVector);
+                memcpy(dest, &v, sizeof(v));
+                break;
+            }
+            case AI_TYPE_VECTOR2: {
+                const auto v = va_arg(ap, AtVector2);
+                memcpy(dest, &v, sizeof(v));
+                break;
+            }
+            case AI_TYPE_MATRIX: {
+                const auto v = va_arg(ap, AtMatrix);
+                memcpy(dest, &v, sizeof(v));
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    va_end(ap);
+    return ret;
+}
+
+AtArray* AiArrayAllocate(uint32_t nelements, uint8_t nkeys, uint8_t type) {
+    MOCK_CALL();
+    return allocateArray(nelements, nkeys, type);
+}
+
+AtArray* AiArrayConvert(
+    uint32_t nelements, uint8_t nkeys, uint8_t type, const void* data) {
+    MOCK_CALL();
+    auto* ret = allocateArray(nelements, nkeys, type);
+    if (data != nullptr && !ret->data.empty()) {
+        memcpy(ret->data.data(), data, ret->data.size());
+    }
+    return ret;
+}
+
+AtArray* AiArrayCopy(const AtArray* array) {
+    MOCK_CALL();
+    return array == nullptr ? nullptr : new AtArray(*array);
+}
+
+void AiArrayDestroy(AtArray* array) {
+    MOCK_CALL();
+    delete array;
+}
+
+void AiArrayResize(AtArray* array, uint32_t nelements, uint8_t nkeys) {
+    MOCK_CALL();
+    if (array == nullptr) { return; }
+    array->nelements = nelements;
+    array->nkeys = nkeys;
+    array->data.resize(
+        static_cast<size_t>(nelements) * nkeys * getTypeSize(array->type), 0);
+}
+
+bool AiArraySetKey(AtArray* array, uint8_t key, const void* data) {
+    MOCK_CALL();
+    if (array == nullptr || data == nullptr || key >= array->nkeys) {
+        return false;
+    }
+    const auto keySize = array->nelements * getTypeSize(array->type);
+    memcpy(array->data.data() + key * keySize, data, keySize);
+    return true;
+}
+
+void* AiArrayMap(AtArray* array) {
+    MOCK_CALL();
+    return array == nullptr ? nullptr : array->data.data();
+}
+
+void* AiArrayMapKey(AtArray* array, uint8_t key) {
+    MOCK_CALL();
+    if (array == nullptr || key >= array->nkeys) { return nullptr; }
+    return array->data.data() +
+           key * array->nelements * getTypeSize(array->type);
+}
+
+void AiArrayUnmap(AtArray*) { MOCK_CALL(); }
+
+uint32_t AiArrayGetNumElements(const AtArray* array) {
+    MOCK_CALL();
+    return array == nullptr ? 0 : array->nelements;
+}
+
+uint8_t AiArrayGetNumKeys(const AtArray* array) {
+    MOCK_CALL();
+    return array == nullptr ? 0 : array->nkeys;
+}
+
+uint8_t AiArrayGetType(const AtArray* array) {
+    MOCK_CALL();
+    return array == nullptr ? AI_TYPE_NONE : array->type;
+}
+
+size_t AiArrayGetDataSize(const AtArray* array) {
+    MOCK_CALL();
+    return array == nullptr ? 0 : array->data.size();
+}
+
+size_t AiArrayGetKeySize(const AtArray* array) {
+    MOCK_CALL();
+    return array == nullptr ? 0
+                            : array->nelements * getTypeSize(array->type);
+}
+
+#define MOCK_ARRAY_FUNCTIONS(Name, Type, TypeEnum, Default)                  \
+    Type AiArrayGet##Name##Func(                                             \
+        const AtArray* a, uint32_t i, const char* file, int line) {          \
+        MOCK_CALL();                                                         \
+        Type ret = Default;                                                  \
+        getArrayElement(a, i, TypeEnum, file, line, ret);                    \
+        return ret;                                                          \
+    }                                                                        \
+    bool AiArraySet##Name##Func(                                             \
+        AtArray* a, uint32_t i, Type val, const char* file, int line) {      \
+        MOCK_CALL();                                                         \
+        return setArrayElement(a, i, TypeEnum, file, line, val);             \
+    }
+
+MOCK_ARRAY_FUNCTIONS(Bool, bool, AI_TYPE_BOOLEAN, false)
+MOCK_ARRAY_FUNCTIONS(Byte, uint8_t, AI_TYPE_BYTE, 0)
+MOCK_ARRAY_FUNCTIONS(Int, int, AI_TYPE_INT, 0)
+MOCK_ARRAY_FUNCTIONS(UInt, uint32_t, AI_TYPE_UINT, 0)
+MOCK_ARRAY_FUNCTIONS(Flt, float, AI_TYPE_FLOAT, 0.0f)
+MOCK_ARRAY_FUNCTIONS(RGB, AtRGB, AI_TYPE_RGB, AtRGB(0.0f, 0.0f, 0.0f))
+MOCK_ARRAY_FUNCTIONS(
+    RGBA, AtRGBA, AI_TYPE_RGBA, AtRGBA(0.0f, 0.0f, 0.0f, 0.0f))
+MOCK_ARRAY_FUNCTIONS(Vec, AtVector, AI_TYPE_VECTOR, AtVector(0.0f, 0.0f, 0.0f))
+MOCK_ARRAY_FUNCTIONS(Vec2, AtVector2, AI_TYPE_VECTOR2, AtVector2(0.0f, 0.0f))
+MOCK_ARRAY_FUNCTIONS(Str, AtString, AI_TYPE_STRING, AtString())
+MOCK_ARRAY_FUNCTIONS(Ptr, void*, AI_TYPE_POINTER, nullptr)
+MOCK_ARRAY_FUNCTIONS(Array, AtArray*, AI_TYPE_ARRAY, nullptr)
+MOCK_ARRAY_FUNCTIONS(Mtx, AtMatrix, AI_TYPE_MATRIX, AiM4Identity())
+
+#undef MOCK_ARRAY_FUNCTIONS
+
+namespace ArnoldMock {
+
+std::map<std::string, CallStats> GetCallStats() {
+    std::map<std::string, CallStats> ret;
+    std::lock_guard<std::mutex> lock(callCountersMutex());
+    for (const auto* counter : callCounters()) {
+        const auto count = counter->count.load();
+        if (count == 0) { continue; }
+        // Overloads share the same name.
+        auto& stats = ret[counter->name];
+        stats.count += count;
+        stats.seconds += static_cast<double>(counter->nanoseconds.load()) *
+                         1e-9;
+    }
+    return ret;
+}
+
+void ResetCallStats() {
+    std::lock_guard<std::mutex> lock(callCountersMutex());
+    for (auto* counter : callCounters()) {
+        counter->count = 0;
+        counter->nanoseconds = 0;
+    }
+}
+
+void InstallBuiltinNodes() {
+    ScopedLock lock(sceneMutex());
+    installBuiltin(
+        AI_NODE_OPTIONS, AI_TYPE_NONE, "options",
+        [](AtList* params, AtNodeEntry*) {
+            AiParameterInt("xres", 320);
+            AiParameterInt("yres", 240);
+            AiParameterNode("camera", nullptr);
+            AiParameterArray("outputs", AiArrayAllocate(0, 1, AI_TYPE_STRING));
+            AiParameterInt("AA_samples", 1);
+            AiParameterInt("threads", 0);
+            AiParameterBool("enable_progressive_render", false);
+        });
+    installBuiltin(
+        AI_NODE_CAMERA, AI_TYPE_NONE, "persp_camera",
+        [](AtList* params, AtNodeEntry*) {
+            AiParameterArray("matrix", identityMatrixArray());
+            AiParameterFlt("fov", 54.43f);
+            AiParameterFlt("near_clip", 0.0001f);
+            AiParameterFlt("far_clip", 1e30f);
+            AiParameterVec2("screen_window_min", -1.0f, -1.0f);
+            AiParameterVec2("screen_window_max", 1.0f, 1.0f);
+        });
+    installBuiltin(
+        AI_NODE_SHAPE, AI_TYPE_NONE, "polymesh",
+        [](AtList* params, AtNodeEntry*) {
+            shapeParameters(params);
+            AiParameterArray("nsides", AiArrayAllocate(0, 1, AI_TYPE_UINT));
+            AiParameterArray("vidxs", AiArrayAllocate(0, 1, AI_TYPE_UINT));
+            AiParameterArray("nidxs", AiArrayAllocate(0, 1, AI_TYPE_UINT));
+            AiParameterArray("uvidxs", AiArrayAllocate(0, 1, AI_TYPE_UINT));
+            AiParameterArray("shidxs", AiArrayAllocate(0, 1, AI_TYPE_BYTE));
+            AiParameterArray("vlist", AiArrayAllocate(0, 1, AI_TYPE_VECTOR));
+            AiParameterArray("nlist", AiArrayAllocate(0, 1, AI_TYPE_VECTOR));
+            AiParameterArray("uvlist", AiArrayAllocate(0, 1, AI_TYPE_VECTOR2));
+            AiParameterBool("smoothing", false);
+            AiParameterEnum("subdiv_type", 0, subdivTypes);
+            AiParameterByte("subdiv_iterations", 1);
+            AiParameterArray(
+                "crease_idxs", AiArrayAllocate(0, 1, AI_TYPE_UINT));
+            AiParameterArray(
+                "crease_sharpness", AiArrayAllocate(0, 1, AI_TYPE_FLOAT));
+            AiParameterArray("disp_map", AiArrayAllocate(0, 1, AI_TYPE_NODE));
+            AiParameterFlt("disp_padding", 0.0f);
+            AiParameterFlt("disp_height", 1.0f);
+            AiParameterFlt("disp_zero_value", 0.0f);
+            AiParameterBool("disp_autobump", false);
+        });
+    installBuiltin(
+        AI_NODE_SHAPE_VOLUME, AI_TYPE_NONE, "volume",
+        [](AtList* params, AtNodeEntry*) {
+            shapeParameters(params);
+            AiParameterStr("filename", "");
+            AiParameterArray("grids", AiArrayAllocate(0, 1, AI_TYPE_STRING));
+            AiParameterFlt("step_size", 0.0f);
+            AiParameterFlt("step_scale", 1.0f);
+            AiParameterFlt("volume_padding", 0.0f);
+        });
+    installBuiltin(
+        AI_NODE_SHADER, AI_TYPE_CLOSURE, "standard_surface",
+        [](AtList* params, AtNodeEntry*) {
+            AiParameterFlt("base", 0.8f);
+            AiParameterRGB("base_color", 1.0f, 1.0f, 1.0f);
+            AiParameterFlt("diffuse_roughness", 0.0f);
+            AiParameterFlt("metalness", 0.0f);
+            AiParameterFlt("specular", 1.0f);
+            AiParameterRGB("specular_color", 1.0f, 1.0f, 1.0f);
+            AiParameterFlt("specular_roughness", 0.2f);
+            AiParameterFlt("specular_IOR", 1.5f);
+            AiParameterFlt("transmission", 0.0f);
+            AiParameterRGB("transmission_color", 1.0f, 1.0f, 1.0f);
+            AiParameterFlt("subsurface", 0.0f);
+            AiParameterRGB("subsurface_color", 1.0f, 1.0f, 1.0f);
+            AiParameterFlt("coat", 0.0f);
+            AiParameterRGB("coat_color", 1.0f, 1.0f, 1.0f);
+            AiParameterFlt("emission", 0.0f);
+            AiParameterRGB("emission_color", 1.0f, 1.0f, 1.0f);
+            AiParameterRGB("opacity", 1.0f, 1.0f, 1.0f);
+            AiParameterBool("thin_walled", false);
+            AiParameterVec("normal", 0.0f, 0.0f, 0.0f);
+        });
+    installBuiltin(
+        AI_NODE_SHADER, AI_TYPE_CLOSURE, "standard_hair",
+        [](AtList* params, AtNodeEntry*) {
+            AiParameterFlt("base", 1.0f);
+            AiParameterRGB("base_color", 1.0f, 1.0f, 1.0f);
+            AiParameterFlt("melanin", 1.0f);
+            AiParameterFlt("melanin_redness", 0.5f);
+            AiParameterFlt("roughness", 0.2f);
+            AiParameterFlt("ior", 1.55f);
+        });
+    installBuiltin(
+        AI_NODE_SHADER, AI_TYPE_CLOSURE, "standard_volume",
+        [](AtList* params, AtNodeEntry*) {
+            AiParameterFlt("density", 1.0f);
+            AiParameterStr("density_channel", "density");
+            AiParameterFlt("scatter", 1.0f);
+            AiParameterRGB("scatter_color", 0.5f, 0.5f, 0.5f);
+            AiParameterStr("scatter_color_channel", "");
+            AiParameterFlt("emission", 0.0f);
+            AiParameterStr("emission_channel", "");
+            AiParameterStr("temperature_channel", "temperature");
+        });
+    installBuiltin(
+        AI_NODE_SHADER, AI_TYPE_RGB, "noise",
+        [](AtList* params, AtNodeEntry*) {
+            AiParameterInt("octaves", 1);
+            AiParameterFlt("distortion", 0.0f);
+            AiParameterFlt("lacunarity", 1.92f);
+            AiParameterFlt("amplitude", 1.0f);
+            AiParameterVec("scale", 1.0f, 1.0f, 1.0f);
+            AiParameterVec("offset", 0.0f, 0.0f, 0.0f);
+            AiParameterRGB("color1", 0.0f, 0.0f, 0.0f);
+            AiParameterRGB("color2", 1.0f, 1.0f, 1.0f);
+            AiParameterEnum("coord_space", 1, coordSpaces);
+        });
+    installBuiltin(
+        AI_NODE_SHADER, AI_TYPE_RGBA, "image",
+        [](AtList* params, AtNodeEntry*) {
+            AiParameterStr("filename", "");
+            AiParameterStr("color_space", "auto");
+            AiParameterEnum("filter", 3, filterTypes);
+            AiParameterRGB("multiply", 1.0f, 1.0f, 1.0f);
+            AiParameterRGB("offset", 0.0f, 0.0f, 0.0f);
+            AiParameterStr("uvset", "");
+            AiParameterEnum("swrap", 0, wrapModes);
+            AiParameterEnum("twrap", 0, wrapModes);
+            AiParameterRGBA("missing_texture_color", 0.0f, 0.0f, 0.0f, 0.0f);
+        });
+    installBuiltin(
+        AI_NODE_SHADER, AI_TYPE_FLOAT, "user_data_float",
+        [](AtList* params, AtNodeEntry*) {
+            AiParameterStr("attribute", "");
+            AiParameterFlt("default", 0.0f);
+        });
+    installBuiltin(
+        AI_NODE_SHADER, AI_TYPE_INT, "user_data_int",
+        [](AtList* params, AtNodeEntry*) {
+            AiParameterStr("attribute", "");
+            AiParameterInt("default", 0);
+        });
+    installBuiltin(
+        AI_NODE_SHADER, AI_TYPE_RGB, "user_data_rgb",
+        [](AtList* params, AtNodeEntry*) {
+            AiParameterStr("attribute", "");
+            AiParameterRGB("default", 0.0f, 0.0f, 0.0f);
+        });
+    installBuiltin(
+        AI_NODE_SHADER, AI_TYPE_RGBA, "user_data_rgba",
+        [](AtList* params, AtNodeEntry*) {
+            AiParameterStr("attribute", "");
+            AiParameterRGBA("default", 0.0f, 0.0f, 0.0f, 1.0f);
+        });
+    installBuiltin(
+        AI_NODE_SHADER, AI_TYPE_STRING, "user_data_string",
+        [](AtList* params, AtNodeEntry*) {
+            AiParameterStr("attribute", "");
+            AiParameterStr("default", "");
+        });
+}
+
+} // namespace ArnoldMock
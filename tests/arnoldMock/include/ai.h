@@ -0,0 +1,850 @@
+// Copyright 2019 Luma Pictures
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/// @file ai.h
+///
+/// Stand-in for the subset of the Arnold 5 API used by usdAi and hdAi.
+///
+/// The declarations follow the Arnold SDK, so code built against this header
+/// also builds against the real one. The implementation in arnoldMock.cpp
+/// keeps nodes, parameters, arrays and metadata in memory and never renders
+/// anything, so tests and benchmarks can run without a licensed renderer.
+/// See arnoldMock.h for the functions that are specific to the mock.
+///
+/// With BUILD_ARNOLD_MOCK, usdAi, usdAiShaderInfo, the usdAi tests and the
+/// usdAi benchmarks are built against this header and link the mock. hdAi
+/// and the other plugins can't, because rendering, drivers and texture
+/// tools are not declared here (AiRenderBegin, AiQuantize8bit, AiMakeTx...).
+#ifndef ARNOLD_MOCK_AI_H
+#define ARNOLD_MOCK_AI_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#define AI_API __attribute__((visibility("default")))
+
+#define AI_VERSION_ARCH_NUM 5
+#define AI_VERSION_MAJOR_NUM 0
+#define AI_VERSION_MINOR_NUM 0
+#define AI_VERSION_FIX "0-mock"
+#define AI_VERSION "5.0.0.0-mock"
+
+#define __AI_FILE__ __FILE__
+#define __AI_LINE__ __LINE__
+
+// Strings
+
+AI_API const char* AiCreateAtStringData_private(const char* str);
+AI_API size_t AiAtStringLength(const char* str);
+AI_API size_t AiAtStringHash(const char* str);
+
+/// Interned string, comparing two AtStrings only compares their pointers.
+class AtString {
+public:
+    AtString() = default;
+    explicit AtString(const char* str)
+        : _data(AiCreateAtStringData_private(str)) {}
+
+    bool operator==(const AtString& other) const {
+        return _data == other._data;
+    }
+    bool operator!=(const AtString& other) const {
+        return _data != other._data;
+    }
+    bool operator==(const char* other) const {
+        return strcmp(c_str(), other == nullptr ? "" : other) == 0;
+    }
+    bool operator!=(const char* other) const { return !(*this == other); }
+
+    bool empty() const { return length() == 0; }
+    size_t length() const {
+        return _data == nullptr ? 0 : AiAtStringLength(_data);
+    }
+    size_t hash() const {
+        return _data == nullptr ? 0 : AiAtStringHash(_data);
+    }
+    const char* c_str() const { return _data == nullptr ? "" : _data; }
+    operator const char*() const { return c_str(); }
+
+private:
+    const char* _data = nullptr;
+};
+
+struct AtStringHash {
+    size_t operator()(const AtString& str) const { return str.hash(); }
+};
+
+// Math types
+
+struct AtVector2 {
+    AtVector2() = default;
+    constexpr AtVector2(float x, float y) : x(x), y(y) {}
+    bool operator==(const AtVector2& o) const { return x == o.x && y == o.y; }
+    bool operator!=(const AtVector2& o) const { return !(*this == o); }
+    float x, y;
+};
+
+struct AtVector {
+    AtVector() = default;
+    constexpr AtVector(float x, float y, float z) : x(x), y(y), z(z) {}
+    AtVector operator+(const AtVector& o) const {
+        return AtVector(x + o.x, y + o.y, z + o.z);
+    }
+    AtVector operator-(const AtVector& o) const {
+        return AtVector(x - o.x, y - o.y, z - o.z);
+    }
+    AtVector operator*(float f) const { return AtVector(x * f, y * f, z * f); }
+    AtVector operator-() const { return AtVector(-x, -y, -z); }
+    bool operator==(const AtVector& o) const {
+        return x == o.x && y == o.y && z == o.z;
+    }
+    bool operator!=(const AtVector& o) const { return !(*this == o); }
+    float x, y, z;
+};
+
+struct AtRGB {
+    AtRGB() = default;
+    constexpr AtRGB(float r, float g, float b) : r(r), g(g), b(b) {}
+    AtRGB operator+(const AtRGB& o) const {
+        return AtRGB(r + o.r, g + o.g, b + o.b);
+    }
+    AtRGB operator*(float f) const { return AtRGB(r * f, g * f, b * f); }
+    bool operator==(const AtRGB& o) const {
+        return r == o.r && g == o.g && b == o.b;
+    }
+    bool operator!=(const AtRGB& o) const { return !(*this == o); }
+    float r, g, b;
+};
+
+struct AtRGBA {
+    AtRGBA() = default;
+    constexpr AtRGBA(float r, float g, float b, float a)
+        : r(r), g(g), b(b), a(a) {}
+    bool operator==(const AtRGBA& o) const {
+        return r == o.r && g == o.g && b == o.b && a == o.a;
+    }
+    bool operator!=(const AtRGBA& o) const { return !(*this == o); }
+    float r, g, b, a;
+};
+
+struct AtMatrix {
+    float* operator[](int row) { return data[row]; }
+    const float* operator[](int row) const { return data[row]; }
+    bool operator==(const AtMatrix& o) const {
+        return memcmp(data, o.data, sizeof(data)) == 0;
+    }
+    bool operator!=(const AtMatrix& o) const { return !(*this == o); }
+    float data[4][4];
+};
+
+inline AtMatrix AiM4Identity() {
+    AtMatrix ret;
+    for (auto i = 0; i < 4; ++i) {
+        for (auto j = 0; j < 4; ++j) { ret.data[i][j] = i == j ? 1.0f : 0.0f; }
+    }
+    return ret;
+}
+
+static const AtMatrix AI_M4_IDENTITY = AiM4Identity();
+
+#define AI_EPSILON 1.0e-4f
+
+template <typename T>
+inline T AiClamp(T v, T lo, T hi) {
+    return v < lo ? lo : (hi < v ? hi : v);
+}
+
+// Opaque types, defined by the implementation.
+
+struct AtArray;
+struct AtList;
+struct AtNode;
+struct AtNodeEntry;
+struct AtParamEntry;
+struct AtUserParamEntry;
+struct AtParamIterator;
+struct AtUserParamIterator;
+struct AtNodeIterator;
+struct AtNodeEntryIterator;
+struct AtMetaDataIterator;
+struct AtUniverse;
+struct AtShaderGlobals;
+
+typedef const char** AtEnum;
+
+// Parameter types
+
+#define AI_TYPE_BYTE 0x00
+#define AI_TYPE_INT 0x01
+#define AI_TYPE_UINT 0x02
+#define AI_TYPE_BOOLEAN 0x03
+#define AI_TYPE_FLOAT 0x04
+#define AI_TYPE_RGB 0x05
+#define AI_TYPE_RGBA 0x06
+#define AI_TYPE_VECTOR 0x07
+#define AI_TYPE_VECTOR2 0x08
+#define AI_TYPE_STRING 0x09
+#define AI_TYPE_POINTER 0x0A
+#define AI_TYPE_NODE 0x0B
+#define AI_TYPE_ARRAY 0x0C
+#define AI_TYPE_MATRIX 0x0D
+#define AI_TYPE_ENUM 0x0E
+#define AI_TYPE_CLOSURE 0x0F
+#define AI_TYPE_USHORT 0x10
+#define AI_TYPE_HALF 0x11
+#define AI_TYPE_UNDEFINED 0xFF
+#define AI_TYPE_NONE 0xFF
+
+#define AI_USERDEF_UNDEFINED 0
+#define AI_USERDEF_CONSTANT 1
+#define AI_USERDEF_UNIFORM 2
+#define AI_USERDEF_VARYING 3
+#define AI_USERDEF_INDEXED 4
+
+// Node types
+
+#define AI_NODE_UNDEFINED 0x0000
+#define AI_NODE_OPTIONS 0x0001
+#define AI_NODE_CAMERA 0x0002
+#define AI_NODE_LIGHT 0x0004
+#define AI_NODE_SHAPE 0x0008
+#define AI_NODE_SHADER 0x0010
+#define AI_NODE_OVERRIDE 0x0020
+#define AI_NODE_DRIVER 0x0040
+#define AI_NODE_FILTER 0x0080
+#define AI_NODE_SHAPE_PROCEDURAL 0x0100
+#define AI_NODE_SHAPE_VOLUME 0x0200
+#define AI_NODE_SHAPE_IMPLICIT 0x0400
+#define AI_NODE_COLOR_MANAGER 0x0800
+#define AI_NODE_OPERATOR 0x1000
+#define AI_NODE_ALL 0xFFFF
+
+// Ray types
+
+#define AI_RAY_UNDEFINED 0x00
+#define AI_RAY_CAMERA 0x01
+#define AI_RAY_SHADOW 0x02
+#define AI_RAY_DIFFUSE_TRANSMIT 0x04
+#define AI_RAY_SPECULAR_TRANSMIT 0x08
+#define AI_RAY_VOLUME 0x10
+#define AI_RAY_DIFFUSE_REFLECT 0x20
+#define AI_RAY_SPECULAR_REFLECT 0x40
+#define AI_RAY_SUBSURFACE 0x80
+#define AI_RAY_ALL 0xFF
+
+// Logging
+
+#define AI_LOG_NONE 0x0000
+#define AI_LOG_INFO 0x0001
+#define AI_LOG_WARNINGS 0x0002
+#define AI_LOG_ERRORS 0x0004
+#define AI_LOG_DEBUG 0x0008
+#define AI_LOG_STATS 0x0010
+#define AI_LOG_ALL 0xFFFF
+
+enum AtSessionMode { AI_SESSION_BATCH = 0, AI_SESSION_INTERACTIVE };
+
+/// Value of a parameter, the active member depends on the parameter type.
+struct AtParamValue {
+    AtParamValue() : _pmtx(nullptr) {}
+
+    bool BOOL() const { return _bool; }
+    uint8_t BYTE() const { return _byte; }
+    int INT() const { return _int; }
+    unsigned int UINT() const { return _uint; }
+    float FLT() const { return _flt; }
+    const AtRGB& RGB() const { return _rgb; }
+    const AtRGBA& RGBA() const { return _rgba; }
+    const AtVector& VEC() const { return _vec; }
+    const AtVector2& VEC2() const { return _vec2; }
+    const AtString& STR() const { return _str; }
+    void* PTR() const { return _ptr; }
+    AtArray* ARRAY() const { return _array; }
+    const AtMatrix* pMTX() const { return _pmtx; }
+
+    bool& BOOL() { return _bool; }
+    uint8_t& BYTE() { return _byte; }
+    int& INT() { return _int; }
+    unsigned int& UINT() { return _uint; }
+    float& FLT() { return _flt; }
+    AtRGB& RGB() { return _rgb; }
+    AtRGBA& RGBA() { return _rgba; }
+    AtVector& VEC() { return _vec; }
+    AtVector2& VEC2() { return _vec2; }
+    AtString& STR() { return _str; }
+    void*& PTR() { return _ptr; }
+    AtArray*& ARRAY() { return _array; }
+    AtMatrix*& pMTX() { return _pmtx; }
+
+private:
+    union {
+        bool _bool;
+        uint8_t _byte;
+        int _int;
+        unsigned int _uint;
+        float _flt;
+        AtRGB _rgb;
+        AtRGBA _rgba;
+        AtVector _vec;
+        AtVector2 _vec2;
+        AtString _str;
+        void* _ptr;
+        AtArray* _array;
+        AtMatrix* _pmtx;
+    };
+};
+
+struct AtMetaDataEntry {
+    AtString name;
+    AtString param;
+    uint8_t type;
+    AtParamValue value;
+};
+
+// Node methods
+
+struct AtNodeMethods {
+    void (*Parameters)(AtList* params, AtNodeEntry* nentry);
+    void (*Initialize)(AtNode* node);
+    void (*Update)(AtNode* node);
+    void (*Finish)(AtNode* node);
+    void (*Evaluate)(AtNode* node, AtShaderGlobals* sg);
+};
+
+#define AI_SHADER_NODE_EXPORT_METHODS(tag)                                    \
+    static void Parameters(AtList* params, AtNodeEntry* nentry);             \
+    static void Initialize(AtNode* node);                                    \
+    static void Update(AtNode* node);                                        \
+    static void Finish(AtNode* node);                                        \
+    static void Evaluate(AtNode* node, AtShaderGlobals* sg);                 \
+    static const AtNodeMethods tag##_methods = {                             \
+        Parameters, Initialize, Update, Finish, Evaluate};                   \
+    const AtNodeMethods* tag = &tag##_methods;
+
+#define node_parameters \
+    static void Parameters(AtList* params, AtNodeEntry* nentry)
+#define node_initialize static void Initialize(AtNode* node)
+#define node_update static void Update(AtNode* node)
+#define node_finish static void Finish(AtNode* node)
+#define shader_evaluate static void Evaluate(AtNode* node, AtShaderGlobals* sg)
+
+// Session
+
+AI_API void AiBegin(AtSessionMode mode = AI_SESSION_BATCH);
+AI_API void AiEnd();
+AI_API const char* AiGetVersion(
+    char* arch, char* major, char* minor, char* fix);
+AI_API AtUniverse* AiUniverse();
+AI_API void AiUniverseDestroy(AtUniverse* universe);
+AI_API bool AiUniverseIsActive();
+AI_API AtNodeIterator* AiUniverseGetNodeIterator(unsigned int node_mask);
+AI_API AtNodeIterator* AiUniverseGetNodeIterator(
+    const AtUniverse* universe, unsigned int node_mask);
+AI_API AtNodeEntryIterator* AiUniverseGetNodeEntryIterator(
+    unsigned int node_mask);
+AI_API AtNode* AiUniverseGetOptions(const AtUniverse* universe = nullptr);
+AI_API void AiLoadPlugins(const char* path);
+AI_API bool AiMetaDataLoadFile(const char* filename);
+
+// Messages
+
+AI_API void AiMsgSetConsoleFlags(int flags);
+AI_API void AiMsgInfo(const char* format, ...);
+AI_API void AiMsgDebug(const char* format, ...);
+AI_API void AiMsgWarning(const char* format, ...);
+AI_API void AiMsgError(const char* format, ...);
+
+// Node entries
+
+AI_API void AiNodeEntryInstall(
+    int type, uint8_t output_type, const char* name, const char* filename,
+    const AtNodeMethods* methods, const char* version);
+AI_API void AiNodeEntryUninstall(const char* name);
+AI_API const AtNodeEntry* AiNodeEntryLookUp(const AtString name);
+inline const AtNodeEntry* AiNodeEntryLookUp(const char* name) {
+    return AiNodeEntryLookUp(AtString(name));
+}
+AI_API const char* AiNodeEntryGetName(const AtNodeEntry* nentry);
+AI_API AtString AiNodeEntryGetNameAtString(const AtNodeEntry* nentry);
+AI_API int AiNodeEntryGetType(const AtNodeEntry* nentry);
+AI_API const char* AiNodeEntryGetTypeName(const AtNodeEntry* nentry);
+AI_API int AiNodeEntryGetOutputType(const AtNodeEntry* nentry);
+AI_API const char* AiNodeEntryGetFilename(const AtNodeEntry* nentry);
+AI_API const char* AiNodeEntryGetVersion(const AtNodeEntry* nentry);
+AI_API int AiNodeEntryGetCount(const AtNodeEntry* nentry);
+AI_API int AiNodeEntryGetNumParams(const AtNodeEntry* nentry);
+AI_API const AtParamEntry* AiNodeEntryGetParameter(
+    const AtNodeEntry* nentry, int i);
+AI_API const AtParamEntry* AiNodeEntryLookUpParameter(
+    const AtNodeEntry* nentry, const AtString param);
+inline const AtParamEntry* AiNodeEntryLookUpParameter(
+    const AtNodeEntry* nentry, const char* param) {
+    return AiNodeEntryLookUpParameter(nentry, AtString(param));
+}
+AI_API AtParamIterator* AiNodeEntryGetParamIterator(const AtNodeEntry* nentry);
+AI_API AtMetaDataIterator* AiNodeEntryGetMetaDataIterator(
+    const AtNodeEntry* nentry, const char* param = nullptr);
+
+AI_API void AiNodeEntryIteratorDestroy(AtNodeEntryIterator* iter);
+AI_API AtNodeEntry* AiNodeEntryIteratorGetNext(AtNodeEntryIterator* iter);
+AI_API bool AiNodeEntryIteratorFinished(const AtNodeEntryIterator* iter);
+
+// Parameter entries
+
+AI_API AtString AiParamGetName(const AtParamEntry* pentry);
+AI_API uint8_t AiParamGetType(const AtParamEntry* pentry);
+AI_API uint8_t AiParamGetSubType(const AtParamEntry* pentry);
+AI_API const AtParamValue* AiParamGetDefault(const AtParamEntry* pentry);
+AI_API AtEnum AiParamGetEnum(const AtParamEntry* pentry);
+AI_API const char* AiParamGetTypeName(uint8_t type);
+AI_API int AiParamGetTypeSize(uint8_t type);
+
+AI_API void AiParamIteratorDestroy(AtParamIterator* iter);
+AI_API const AtParamEntry* AiParamIteratorGetNext(AtParamIterator* iter);
+AI_API bool AiParamIteratorFinished(const AtParamIterator* iter);
+
+AI_API void AiNodeParamByte(
+    AtList* params, int varoffset, const char* pname, uint8_t pdefault);
+AI_API void AiNodeParamInt(
+    AtList* params, int varoffset, const char* pname, int pdefault);
+AI_API void AiNodeParamUInt(
+    AtList* params, int varoffset, const char* pname, unsigned int pdefault);
+AI_API void AiNodeParamBool(
+    AtList* params, int varoffset, const char* pname, bool pdefault);
+AI_API void AiNodeParamFlt(
+    AtList* params, int varoffset, const char* pname, float pdefault);
+AI_API void AiNodeParamRGB(
+    AtList* params, int varoffset, const char* pname, float r, float g,
+    float b);
+AI_API void AiNodeParamRGBA(
+    AtList* params, int varoffset, const char* pname, float r, float g,
+    float b, float a);
+AI_API void AiNodeParamVec(
+    AtList* params, int varoffset, const char* pname, float x, float y,
+    float z);
+AI_API void AiNodeParamVec2(
+    AtList* params, int varoffset, const char* pname, float x, float y);
+AI_API void AiNodeParamStr(
+    AtList* params, int varoffset, const char* pname, const char* pdefault);
+AI_API void AiNodeParamPtr(
+    AtList* params, int varoffset, const char* pname, void* pdefault);
+AI_API void AiNodeParamNode(
+    AtList* params, int varoffset, const char* pname, AtNode* pdefault);
+AI_API void AiNodeParamArray(
+    AtList* params, int varoffset, const char* pname, AtArray* pdefault);
+AI_API void AiNodeParamMtx(
+    AtList* params, int varoffset, const char* pname, AtMatrix matrix);
+AI_API void AiNodeParamEnum(
+    AtList* params, int varoffset, const char* pname, int pdefault,
+    AtEnum enum_type);
+AI_API void AiNodeParamClosure(
+    AtList* params, int varoffset, const char* pname);
+
+#define AiParameterByte(n, c) AiNodeParamByte(params, -1, n, c)
+#define AiParameterInt(n, c) AiNodeParamInt(params, -1, n, c)
+#define AiParameterUInt(n, c) AiNodeParamUInt(params, -1, n, c)
+#define AiParameterBool(n, c) AiNodeParamBool(params, -1, n, c)
+#define AiParameterFlt(n, c) AiNodeParamFlt(params, -1, n, c)
+#define AiParameterRGB(n, r, g, b) AiNodeParamRGB(params, -1, n, r, g, b)
+#define AiParameterRGBA(n, r, g, b, a) \
+    AiNodeParamRGBA(params, -1, n, r, g, b, a)
+#define AiParameterVec(n, x, y, z) AiNodeParamVec(params, -1, n, x, y, z)
+#define AiParameterVec2(n, x, y) AiNodeParamVec2(params, -1, n, x, y)
+#define AiParameterStr(n, c) AiNodeParamStr(params, -1, n, c)
+#define AiParameterPtr(n, c) AiNodeParamPtr(params, -1, n, c)
+#define AiParameterNode(n, c) AiNodeParamNode(params, -1, n, c)
+#define AiParameterArray(n, c) AiNodeParamArray(params, -1, n, c)
+#define AiParameterMtx(n, c) AiNodeParamMtx(params, -1, n, c)
+#define AiParameterEnum(n, c, e) AiNodeParamEnum(params, -1, n, c, e)
+#define AiParameterClosure(n) AiNodeParamClosure(params, -1, n)
+
+// Metadata
+
+AI_API void AiMetaDataSetBool(
+    AtNodeEntry* nentry, const AtString param, const AtString name,
+    bool value);
+AI_API void AiMetaDataSetInt(
+    AtNodeEntry* nentry, const AtString param, const AtString name,
+    int value);
+AI_API void AiMetaDataSetFlt(
+    AtNodeEntry* nentry, const AtString param, const AtString name,
+    float value);
+AI_API void AiMetaDataSetRGB(
+    AtNodeEntry* nentry, const AtString param, const AtString name,
+    const AtRGB& value);
+AI_API void AiMetaDataSetVec(
+    AtNodeEntry* nentry, const AtString param, const AtString name,
+    const AtVector& value);
+AI_API void AiMetaDataSetVec2(
+    AtNodeEntry* nentry, const AtString param, const AtString name,
+    const AtVector2& value);
+AI_API void AiMetaDataSetStr(
+    AtNodeEntry* nentry, const AtString param, const AtString name,
+    const AtString value);
+
+AI_API bool AiMetaDataGetBool(
+    const AtNodeEntry* nentry, const AtString param, const AtString name,
+    bool* value);
+AI_API bool AiMetaDataGetInt(
+    const AtNodeEntry* nentry, const AtString param, const AtString name,
+    int* value);
+AI_API bool AiMetaDataGetFlt(
+    const AtNodeEntry* nentry, const AtString param, const AtString name,
+    float* value);
+AI_API bool AiMetaDataGetRGB(
+    const AtNodeEntry* nentry, const AtString param, const AtString name,
+    AtRGB* value);
+AI_API bool AiMetaDataGetVec(
+    const AtNodeEntry* nentry, const AtString param, const AtString name,
+    AtVector* value);
+AI_API bool AiMetaDataGetVec2(
+    const AtNodeEntry* nentry, const AtString param, const AtString name,
+    AtVector2* value);
+AI_API bool AiMetaDataGetStr(
+    const AtNodeEntry* nentry, const AtString param, const AtString name,
+    AtString* value);
+
+#define AI_MOCK_METADATA_OVERLOADS(Name, SetType, GetType)                  \
+    inline void AiMetaDataSet##Name(                                        \
+        AtNodeEntry* nentry, const char* param, const char* name,           \
+        SetType value) {                                                    \
+        AiMetaDataSet##Name(nentry, AtString(param), AtString(name), value); \
+    }                                                                       \
+    inline bool AiMetaDataGet##Name(                                        \
+        const AtNodeEntry* nentry, const char* param, const char* name,     \
+        GetType* value) {                                                   \
+        return AiMetaDataGet##Name(                                         \
+            nentry, AtString(param), AtString(name), value);                \
+    }
+
+AI_MOCK_METADATA_OVERLOADS(Bool, bool, bool)
+AI_MOCK_METADATA_OVERLOADS(Int, int, int)
+AI_MOCK_METADATA_OVERLOADS(Flt, float, float)
+AI_MOCK_METADATA_OVERLOADS(RGB, const AtRGB&, AtRGB)
+AI_MOCK_METADATA_OVERLOADS(Vec, const AtVector&, AtVector)
+AI_MOCK_METADATA_OVERLOADS(Vec2, const AtVector2&, AtVector2)
+
+inline void AiMetaDataSetStr(
+    AtNodeEntry* nentry, const char* param, const char* name,
+    const char* value) {
+    AiMetaDataSetStr(nentry, AtString(param), AtString(name), AtString(value));
+}
+inline bool AiMetaDataGetStr(
+    const AtNodeEntry* nentry, const char* param, const char* name,
+    AtString* value) {
+    return AiMetaDataGetStr(nentry, AtString(param), AtString(name), value);
+}
+
+#undef AI_MOCK_METADATA_OVERLOADS
+
+AI_API void AiMetaDataIteratorDestroy(AtMetaDataIterator* iter);
+AI_API const AtMetaDataEntry* AiMetaDataIteratorGetNext(
+    AtMetaDataIterator* iter);
+AI_API bool AiMetaDataIteratorFinished(const AtMetaDataIterator* iter);
+
+// Nodes
+
+AI_API AtNode* AiNode(
+    AtUniverse* universe, const AtString nentry_name,
+    const AtString name = AtString(), const AtNode* parent = nullptr);
+inline AtNode* AiNode(
+    const AtString nentry_name, const AtString name = AtString(),
+    const AtNode* parent = nullptr) {
+    return AiNode(nullptr, nentry_name, name, parent);
+}
+inline AtNode* AiNode(
+    AtUniverse* universe, const char* nentry_name, const char* name = "",
+    const AtNode* parent = nullptr) {
+    return AiNode(universe, AtString(nentry_name), AtString(name), parent);
+}
+inline AtNode* AiNode(
+    const char* nentry_name, const char* name = "",
+    const AtNode* parent = nullptr) {
+    return AiNode(
+        static_cast<AtUniverse*>(nullptr), AtString(nentry_name),
+        AtString(name), parent);
+}
+AI_API AtNode* AiNodeLookUpByName(
+    const AtUniverse* universe, const AtString name,
+    const AtNode* parent = nullptr);
+inline AtNode* AiNodeLookUpByName(
+    const AtString name, const AtNode* parent = nullptr) {
+    return AiNodeLookUpByName(nullptr, name, parent);
+}
+inline AtNode* AiNodeLookUpByName(
+    const char* name, const AtNode* parent = nullptr) {
+    return AiNodeLookUpByName(nullptr, AtString(name), parent);
+}
+AI_API bool AiNodeDestroy(AtNode* node);
+AI_API void AiNodeReplace(AtNode* old_node, AtNode* new_node, bool remove);
+AI_API void AiNodeResetParameter(AtNode* node, const char* param);
+AI_API const AtNodeEntry* AiNodeGetNodeEntry(const AtNode* node);
+AI_API const char* AiNodeGetName(const AtNode* node);
+AI_API AtUniverse* AiNodeGetUniverse(const AtNode* node);
+AI_API bool AiNodeIs(const AtNode* node, const AtString str);
+AI_API void* AiNodeGetLocalData(const AtNode* node);
+AI_API void AiNodeSetLocalData(AtNode* node, void* data);
+
+AI_API void AiNodeIteratorDestroy(AtNodeIterator* iter);
+AI_API AtNode* AiNodeIteratorGetNext(AtNodeIterator* iter);
+AI_API bool AiNodeIteratorFinished(const AtNodeIterator* iter);
+
+// Node parameters
+
+AI_API void AiNodeSetByte(AtNode* node, const AtString param, uint8_t val);
+AI_API void AiNodeSetInt(AtNode* node, const AtString param, int val);
+AI_API void AiNodeSetUInt(
+    AtNode* node, const AtString param, unsigned int val);
+AI_API void AiNodeSetBool(AtNode* node, const AtString param, bool val);
+AI_API void AiNodeSetFlt(AtNode* node, const AtString param, float val);
+AI_API void AiNodeSetPtr(AtNode* node, const AtString param, void* val);
+AI_API void AiNodeSetArray(AtNode* node, const AtString param, AtArray* val);
+AI_API void AiNodeSetMatrix(
+    AtNode* node, const AtString param, AtMatrix val);
+AI_API void AiNodeSetStr(AtNode* node, const AtString param, AtString str);
+AI_API void AiNodeSetRGB(
+    AtNode* node, const AtString param, float r, float g, float b);
+AI_API void AiNodeSetRGBA(
+    AtNode* node, const AtString param, float r, float g, float b, float a);
+AI_API void AiNodeSetVec(
+    AtNode* node, const AtString param, float x, float y, float z);
+AI_API void AiNodeSetVec2(
+    AtNode* node, const AtString param, float x, float y);
+
+AI_API uint8_t AiNodeGetByte(const AtNode* node, const AtString param);
+AI_API int AiNodeGetInt(const AtNode* node, const AtString param);
+AI_API unsigned int AiNodeGetUInt(const AtNode* node, const AtString param);
+AI_API bool AiNodeGetBool(const AtNode* node, const AtString param);
+AI_API float AiNodeGetFlt(const AtNode* node, const AtString param);
+AI_API void* AiNodeGetPtr(const AtNode* node, const AtString param);
+AI_API AtArray* AiNodeGetArray(const AtNode* node, const AtString param);
+AI_API AtMatrix AiNodeGetMatrix(const AtNode* node, const AtString param);
+AI_API AtString AiNodeGetStr(const AtNode* node, const AtString param);
+AI_API AtRGB AiNodeGetRGB(const AtNode* node, const AtString param);
+AI_API AtRGBA AiNodeGetRGBA(const AtNode* node, const AtString param);
+AI_API AtVector AiNodeGetVec(const AtNode* node, const AtString param);
+AI_API AtVector2 AiNodeGetVec2(const AtNode* node, const AtString param);
+
+#define AI_MOCK_NODE_OVERLOADS(Name, Type)                                   \
+    inline void AiNodeSet##Name(AtNode* node, const char* param, Type val) { \
+        AiNodeSet##Name(node, AtString(param), val);                         \
+    }
+
+AI_MOCK_NODE_OVERLOADS(Byte, uint8_t)
+AI_MOCK_NODE_OVERLOADS(Int, int)
+AI_MOCK_NODE_OVERLOADS(UInt, unsigned int)
+AI_MOCK_NODE_OVERLOADS(Bool, bool)
+AI_MOCK_NODE_OVERLOADS(Flt, float)
+AI_MOCK_NODE_OVERLOADS(Ptr, void*)
+AI_MOCK_NODE_OVERLOADS(Array, AtArray*)
+AI_MOCK_NODE_OVERLOADS(Matrix, AtMatrix)
+
+#undef AI_MOCK_NODE_OVERLOADS
+
+inline void AiNodeSetStr(AtNode* node, const AtString param, const char* str) {
+    AiNodeSetStr(node, param, AtString(str));
+}
+inline void AiNodeSetStr(AtNode* node, const char* param, const char* str) {
+    AiNodeSetStr(node, AtString(param), AtString(str));
+}
+inline void AiNodeSetRGB(
+    AtNode* node, const char* param, float r, float g, float b) {
+    AiNodeSetRGB(node, AtString(param), r, g, b);
+}
+inline void AiNodeSetRGBA(
+    AtNode* node, const char* param, float r, float g, float b, float a) {
+    AiNodeSetRGBA(node, AtString(param), r, g, b, a);
+}
+inline void AiNodeSetVec(
+    AtNode* node, const char* param, float x, float y, float z) {
+    AiNodeSetVec(node, AtString(param), x, y, z);
+}
+inline void AiNodeSetVec2(AtNode* node, const char* param, float x, float y) {
+    AiNodeSetVec2(node, AtString(param), x, y);
+}
+
+#define AI_MOCK_NODE_GET_OVERLOAD(Name, Type)                         \
+    inline Type AiNodeGet##Name(const AtNode* node, const char* param) { \
+        return AiNodeGet##Name(node, AtString(param));                 \
+    }
+
+AI_MOCK_NODE_GET_OVERLOAD(Byte, uint8_t)
+AI_MOCK_NODE_GET_OVERLOAD(Int, int)
+AI_MOCK_NODE_GET_OVERLOAD(UInt, unsigned int)
+AI_MOCK_NODE_GET_OVERLOAD(Bool, bool)
+AI_MOCK_NODE_GET_OVERLOAD(Flt, float)
+AI_MOCK_NODE_GET_OVERLOAD(Ptr, void*)
+AI_MOCK_NODE_GET_OVERLOAD(Array, AtArray*)
+AI_MOCK_NODE_GET_OVERLOAD(Matrix, AtMatrix)
+AI_MOCK_NODE_GET_OVERLOAD(Str, AtString)
+AI_MOCK_NODE_GET_OVERLOAD(RGB, AtRGB)
+AI_MOCK_NODE_GET_OVERLOAD(RGBA, AtRGBA)
+AI_MOCK_NODE_GET_OVERLOAD(Vec, AtVector)
+AI_MOCK_NODE_GET_OVERLOAD(Vec2, AtVector2)
+
+#undef AI_MOCK_NODE_GET_OVERLOAD
+
+// User parameters
+
+AI_API bool AiNodeDeclare(
+    AtNode* node, const AtString param, const char* declaration);
+inline bool AiNodeDeclare(
+    AtNode* node, const char* param, const char* declaration) {
+    return AiNodeDeclare(node, AtString(param), declaration);
+}
+AI_API const AtUserParamEntry* AiNodeLookUpUserParameter(
+    const AtNode* node, const AtString param);
+inline const AtUserParamEntry* AiNodeLookUpUserParameter(
+    const AtNode* node, const char* param) {
+    return AiNodeLookUpUserParameter(node, AtString(param));
+}
+AI_API AtUserParamIterator* AiNodeGetUserParamIterator(const AtNode* node);
+AI_API const char* AiUserParamGetName(const AtUserParamEntry* upentry);
+AI_API int AiUserParamGetType(const AtUserParamEntry* upentry);
+AI_API int AiUserParamGetArrayType(const AtUserParamEntry* upentry);
+AI_API int AiUserParamGetCategory(const AtUserParamEntry* upentry);
+
+AI_API void AiUserParamIteratorDestroy(AtUserParamIterator* iter);
+AI_API const AtUserParamEntry* AiUserParamIteratorGetNext(
+    AtUserParamIterator* iter);
+AI_API bool AiUserParamIteratorFinished(const AtUserParamIterator* iter);
+
+// Links
+
+AI_API bool AiNodeLink(AtNode* src, const char* input, AtNode* target);
+AI_API bool AiNodeLinkOutput(
+    AtNode* src, const char* output, AtNode* target, const char* input);
+AI_API bool AiNodeUnlink(AtNode* node, const char* input);
+AI_API bool AiNodeIsLinked(const AtNode* node, const char* input);
+AI_API AtNode* AiNodeGetLink(
+    const AtNode* node, const char* input, int* comp = nullptr);
+
+// Arrays
+
+AI_API AtArray* AiArray(
+    uint32_t nelements, uint8_t nkeys, uint8_t type, ...);
+AI_API AtArray* AiArrayAllocate(
+    uint32_t nelements, uint8_t nkeys, uint8_t type);
+AI_API AtArray* AiArrayConvert(
+    uint32_t nelements, uint8_t nkeys, uint8_t type, const void* data);
+AI_API AtArray* AiArrayCopy(const AtArray* array);
+AI_API void AiArrayDestroy(AtArray* array);
+AI_API void AiArrayResize(AtArray* array, uint32_t nelements, uint8_t nkeys);
+AI_API bool AiArraySetKey(AtArray* array, uint8_t key, const void* data);
+AI_API void* AiArrayMap(AtArray* array);
+AI_API void* AiArrayMapKey(AtArray* array, uint8_t key);
+AI_API void AiArrayUnmap(AtArray* array);
+AI_API uint32_t AiArrayGetNumElements(const AtArray* array);
+AI_API uint8_t AiArrayGetNumKeys(const AtArray* array);
+AI_API uint8_t AiArrayGetType(const AtArray* array);
+AI_API size_t AiArrayGetDataSize(const AtArray* array);
+AI_API size_t AiArrayGetKeySize(const AtArray* array);
+
+AI_API bool AiArrayGetBoolFunc(
+    const AtArray* a, uint32_t i, const char* file, int line);
+AI_API uint8_t AiArrayGetByteFunc(
+    const AtArray* a, uint32_t i, const char* file, int line);
+AI_API int AiArrayGetIntFunc(
+    const AtArray* a, uint32_t i, const char* file, int line);
+AI_API uint32_t AiArrayGetUIntFunc(
+    const AtArray* a, uint32_t i, const char* file, int line);
+AI_API float AiArrayGetFltFunc(
+    const AtArray* a, uint32_t i, const char* file, int line);
+AI_API AtRGB AiArrayGetRGBFunc(
+    const AtArray* a, uint32_t i, const char* file, int line);
+AI_API AtRGBA AiArrayGetRGBAFunc(
+    const AtArray* a, uint32_t i, const char* file, int line);
+AI_API AtVector AiArrayGetVecFunc(
+    const AtArray* a, uint32_t i, const char* file, int line);
+AI_API AtVector2 AiArrayGetVec2Func(
+    const AtArray* a, uint32_t i, const char* file, int line);
+AI_API AtString AiArrayGetStrFunc(
+    const AtArray* a, uint32_t i, const char* file, int line);
+AI_API void* AiArrayGetPtrFunc(
+    const AtArray* a, uint32_t i, const char* file, int line);
+AI_API AtArray* AiArrayGetArrayFunc(
+    const AtArray* a, uint32_t i, const char* file, int line);
+AI_API AtMatrix AiArrayGetMtxFunc(
+    const AtArray* a, uint32_t i, const char* file, int line);
+
+AI_API bool AiArraySetBoolFunc(
+    AtArray* a, uint32_t i, bool val, const char* file, int line);
+AI_API bool AiArraySetByteFunc(
+    AtArray* a, uint32_t i, uint8_t val, const char* file, int line);
+AI_API bool AiArraySetIntFunc(
+    AtArray* a, uint32_t i, int val, const char* file, int line);
+AI_API bool AiArraySetUIntFunc(
+    AtArray* a, uint32_t i, uint32_t val, const char* file, int line);
+AI_API bool AiArraySetFltFunc(
+    AtArray* a, uint32_t i, float val, const char* file, int line);
+AI_API bool AiArraySetRGBFunc(
+    AtArray* a, uint32_t i, AtRGB val, const char* file, int line);
+AI_API bool AiArraySetRGBAFunc(
+    AtArray* a, uint32_t i, AtRGBA val, const char* file, int line);
+AI_API bool AiArraySetVecFunc(
+    AtArray* a, uint32_t i, AtVector val, const char* file, int line);
+AI_API bool AiArraySetVec2Func(
+    AtArray* a, uint32_t i, AtVector2 val, const char* file, int line);
+AI_API bool AiArraySetStrFunc(
+    AtArray* a, uint32_t i, AtString val, const char* file, int line);
+AI_API bool AiArraySetPtrFunc(
+    AtArray* a, uint32_t i, void* val, const char* file, int line);
+AI_API bool AiArraySetArrayFunc(
+    AtArray* a, uint32_t i, AtArray* val, const char* file, int line);
+AI_API bool AiArraySetMtxFunc(
+    AtArray* a, uint32_t i, AtMatrix val, const char* file, int line);
+
+#define AiArrayGetBool(a, i) AiArrayGetBoolFunc(a, i, __AI_FILE__, __AI_LINE__)
+#define AiArrayGetByte(a, i) AiArrayGetByteFunc(a, i, __AI_FILE__, __AI_LINE__)
+#define AiArrayGetInt(a, i) AiArrayGetIntFunc(a, i, __AI_FILE__, __AI_LINE__)
+#define AiArrayGetUInt(a, i) AiArrayGetUIntFunc(a, i, __AI_FILE__, __AI_LINE__)
+#define AiArrayGetFlt(a, i) AiArrayGetFltFunc(a, i, __AI_FILE__, __AI_LINE__)
+#define AiArrayGetRGB(a, i) AiArrayGetRGBFunc(a, i, __AI_FILE__, __AI_LINE__)
+#define AiArrayGetRGBA(a, i) AiArrayGetRGBAFunc(a, i, __AI_FILE__, __AI_LINE__)
+#define AiArrayGetVec(a, i) AiArrayGetVecFunc(a, i, __AI_FILE__, __AI_LINE__)
+#define AiArrayGetVec2(a, i) AiArrayGetVec2Func(a, i, __AI_FILE__, __AI_LINE__)
+#define AiArrayGetStr(a, i) AiArrayGetStrFunc(a, i, __AI_FILE__, __AI_LINE__)
+#define AiArrayGetPtr(a, i) AiArrayGetPtrFunc(a, i, __AI_FILE__, __AI_LINE__)
+#define AiArrayGetArray(a, i) \
+    AiArrayGetArrayFunc(a, i, __AI_FILE__, __AI_LINE__)
+#define AiArrayGetMtx(a, i) AiArrayGetMtxFunc(a, i, __AI_FILE__, __AI_LINE__)
+
+#define AiArraySetBool(a, i, v) \
+    AiArraySetBoolFunc(a, i, v, __AI_FILE__, __AI_LINE__)
+#define AiArraySetByte(a, i, v) \
+    AiArraySetByteFunc(a, i, v, __AI_FILE__, __AI_LINE__)
+#define AiArraySetInt(a, i, v) \
+    AiArraySetIntFunc(a, i, v, __AI_FILE__, __AI_LINE__)
+#define AiArraySetUInt(a, i, v) \
+    AiArraySetUIntFunc(a, i, v, __AI_FILE__, __AI_LINE__)
+#define AiArraySetFlt(a, i, v) \
+    AiArraySetFltFunc(a, i, v, __AI_FILE__, __AI_LINE__)
+#define AiArraySetRGB(a, i, v) \
+    AiArraySetRGBFunc(a, i, v, __AI_FILE__, __AI_LINE__)
+#define AiArraySetRGBA(a, i, v) \
+    AiArraySetRGBAFunc(a, i, v, __AI_FILE__, __AI_LINE__)
+#define AiArraySetVec(a, i, v) \
+    AiArraySetVecFunc(a, i, v, __AI_FILE__, __AI_LINE__)
+#define AiArraySetVec2(a, i, v) \
+    AiArraySetVec2Func(a, i, v, __AI_FILE__, __AI_LINE__)
+#define AiArraySetStr(a, i, v) \
+    AiArraySetStrFunc(a, i, v, __AI_FILE__, __AI_LINE__)
+#define AiArraySetPtr(a, i, v) \
+    AiArraySetPtrFunc(a, i, v, __AI_FILE__, __AI_LINE__)
+#define AiArraySetArray(a, i, v) \
+    AiArraySetArrayFunc(a, i, v, __AI_FILE__, __AI_LINE__)
+#define AiArraySetMtx(a, i, v) \
+    AiArraySetMtxFunc(a, i, v, __AI_FILE__, __AI_LINE__)
+
+#endif // ARNOLD_MOCK_AI_H
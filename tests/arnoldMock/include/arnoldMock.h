@@ -0,0 +1,51 @@
+// Copyright 2019 Luma Pictures
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/// @file arnoldMock.h
+///
+/// Functions specific to the mock Arnold library, used by tests and
+/// benchmarks to inspect how the code under test talks to Arnold.
+#ifndef ARNOLD_MOCK_H
+#define ARNOLD_MOCK_H
+
+#include "ai.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace ArnoldMock {
+
+/// Number of calls to an Ai function and the wall time spent inside them.
+struct CallStats {
+    uint64_t count = 0;
+    double seconds = 0.0;
+};
+
+/// Returns the statistics of every Ai function called since the last reset,
+/// keyed by function name.
+AI_API std::map<std::string, CallStats> GetCallStats();
+
+/// Clears the call statistics.
+AI_API void ResetCallStats();
+
+/// Installs stand-ins for the built-in Arnold nodes the exporters rely on,
+/// including a handful of shaders and the polymesh and volume shapes.
+///
+/// AiBegin calls this, it only needs to be called again after an
+/// AiNodeEntryUninstall of a built-in node.
+AI_API void InstallBuiltinNodes();
+
+} // namespace ArnoldMock
+
+#endif // ARNOLD_MOCK_H
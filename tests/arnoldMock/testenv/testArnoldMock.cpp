@@ -0,0 +1,248 @@
+// Copyright 2019 Luma Pictures
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <ai.h>
+#include <arnoldMock.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+struct ArnoldUniverse {
+    ArnoldUniverse() {
+        AiBegin();
+        AiMsgSetConsoleFlags(AI_LOG_NONE);
+        ArnoldMock::ResetCallStats();
+    }
+    ~ArnoldUniverse() { AiEnd(); }
+};
+
+#define SETUP_UNIVERSE() ArnoldUniverse arnoldUniverse
+
+TEST(ArnoldMock, Strings) {
+    const AtString a("something");
+    const AtString b("something");
+    const AtString c("else");
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(a.c_str(), b.c_str());
+    EXPECT_EQ(a.length(), 9);
+    EXPECT_TRUE(AtString().empty());
+    EXPECT_EQ(AtString(""), AtString());
+    EXPECT_EQ(strcmp(a, "something"), 0);
+}
+
+TEST(ArnoldMock, NodeEntries) {
+    SETUP_UNIVERSE();
+    const auto* entry = AiNodeEntryLookUp("standard_surface");
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(AiNodeEntryGetType(entry), AI_NODE_SHADER);
+    EXPECT_EQ(AiNodeEntryGetOutputType(entry), AI_TYPE_CLOSURE);
+    EXPECT_EQ(AiNodeEntryGetNameAtString(entry), AtString("standard_surface"));
+
+    const auto* param = AiNodeEntryLookUpParameter(entry, "base_color");
+    ASSERT_NE(param, nullptr);
+    EXPECT_EQ(AiParamGetType(param), AI_TYPE_RGB);
+    EXPECT_EQ(AiParamGetDefault(param)->RGB(), AtRGB(1.0f, 1.0f, 1.0f));
+
+    auto* iter = AiNodeEntryGetParamIterator(entry);
+    ASSERT_FALSE(AiParamIteratorFinished(iter));
+    EXPECT_EQ(AiParamGetName(AiParamIteratorGetNext(iter)), AtString("name"));
+    auto count = 1;
+    while (!AiParamIteratorFinished(iter)) {
+        AiParamIteratorGetNext(iter);
+        ++count;
+    }
+    AiParamIteratorDestroy(iter);
+    EXPECT_EQ(count, AiNodeEntryGetNumParams(entry));
+
+    const auto* image = AiNodeEntryLookUp("image");
+    const auto* filter = AiNodeEntryLookUpParameter(image, "filter");
+    ASSERT_NE(filter, nullptr);
+    const auto* filterEnum = AiParamGetEnum(filter);
+    ASSERT_NE(filterEnum, nullptr);
+    EXPECT_STREQ(filterEnum[AiParamGetDefault(filter)->INT()], "smart_bicubic");
+}
+
+TEST(ArnoldMock, MetaData) {
+    SETUP_UNIVERSE();
+    const AtNodeMethods methods = {
+        [](AtList* params, AtNodeEntry* nentry) {
+            AiParameterFlt("value", 0.5f);
+            AiMetaDataSetBool(nentry, "", "ndrai_dont_discover", true);
+            AiMetaDataSetStr(nentry, "value", "desc", "Some value.");
+            AiMetaDataSetFlt(nentry, "value", "softmax", 2.0f);
+        },
+        nullptr, nullptr, nullptr, nullptr};
+    AiNodeEntryInstall(
+        AI_NODE_SHADER, AI_TYPE_FLOAT, "custom", "custom.so", &methods,
+        AI_VERSION);
+    const auto* entry = AiNodeEntryLookUp("custom");
+    ASSERT_NE(entry, nullptr);
+    EXPECT_STREQ(AiNodeEntryGetFilename(entry), "custom.so");
+
+    auto dontDiscover = false;
+    EXPECT_TRUE(AiMetaDataGetBool(
+        entry, AtString(), AtString("ndrai_dont_discover"), &dontDiscover));
+    EXPECT_TRUE(dontDiscover);
+    auto softmax = 0.0f;
+    EXPECT_TRUE(AiMetaDataGetFlt(entry, "value", "softmax", &softmax));
+    EXPECT_EQ(softmax, 2.0f);
+    EXPECT_FALSE(AiMetaDataGetInt(entry, "value", "softmax", nullptr));
+
+    auto* iter = AiNodeEntryGetMetaDataIterator(entry, "value");
+    auto count = 0;
+    while (!AiMetaDataIteratorFinished(iter)) {
+        const auto* metadata = AiMetaDataIteratorGetNext(iter);
+        if (metadata->name == AtString("desc")) {
+            EXPECT_EQ(metadata->type, AI_TYPE_STRING);
+            EXPECT_EQ(metadata->value.STR(), AtString("Some value."));
+        }
+        ++count;
+    }
+    AiMetaDataIteratorDestroy(iter);
+    EXPECT_EQ(count, 2);
+}
+
+TEST(ArnoldMock, Nodes) {
+    SETUP_UNIVERSE();
+    auto* node = AiNode("standard_surface", "surface");
+    ASSERT_NE(node, nullptr);
+    EXPECT_STREQ(AiNodeGetName(node), "surface");
+    EXPECT_EQ(AiNodeLookUpByName("surface"), node);
+    EXPECT_TRUE(AiNodeIs(node, AtString("standard_surface")));
+    EXPECT_EQ(AiNodeGetFlt(node, "base"), 0.8f);
+
+    AiNodeSetFlt(node, "base", 0.25f);
+    AiNodeSetRGB(node, "base_color", 0.1f, 0.2f, 0.3f);
+    EXPECT_EQ(AiNodeGetFlt(node, "base"), 0.25f);
+    EXPECT_EQ(AiNodeGetRGB(node, "base_color"), AtRGB(0.1f, 0.2f, 0.3f));
+    AiNodeResetParameter(node, "base");
+    EXPECT_EQ(AiNodeGetFlt(node, "base"), 0.8f);
+
+    AiNodeSetStr(node, "name", "renamed");
+    EXPECT_EQ(AiNodeLookUpByName("surface"), nullptr);
+    EXPECT_EQ(AiNodeLookUpByName("renamed"), node);
+
+    auto* mesh = AiNode("polymesh", "mesh");
+    AiNodeSetStr(mesh, "subdiv_type", "catclark");
+    EXPECT_EQ(AiNodeGetInt(mesh, "subdiv_type"), 1);
+    EXPECT_EQ(AiNodeGetStr(mesh, "subdiv_type"), AtString("catclark"));
+    AiNodeSetPtr(mesh, "shader", node);
+    EXPECT_EQ(AiNodeGetPtr(mesh, "shader"), node);
+
+    auto* iter = AiUniverseGetNodeIterator(AI_NODE_SHAPE);
+    ASSERT_FALSE(AiNodeIteratorFinished(iter));
+    EXPECT_EQ(AiNodeIteratorGetNext(iter), mesh);
+    EXPECT_TRUE(AiNodeIteratorFinished(iter));
+    AiNodeIteratorDestroy(iter);
+
+    EXPECT_TRUE(AiNodeDestroy(mesh));
+    EXPECT_EQ(AiNodeLookUpByName("mesh"), nullptr);
+    EXPECT_EQ(AiNode("does_not_exist"), nullptr);
+}
+
+TEST(ArnoldMock, Links) {
+    SETUP_UNIVERSE();
+    auto* surface = AiNode("standard_surface");
+    auto* noise = AiNode("noise");
+    auto* image = AiNode("image");
+    EXPECT_TRUE(AiNodeLink(noise, "base_color", surface));
+    EXPECT_TRUE(AiNodeLinkOutput(image, "r", surface, "specular"));
+    EXPECT_TRUE(AiNodeLinkOutput(image, "g", surface, "coat_color.r"));
+    EXPECT_FALSE(AiNodeLink(noise, "does_not_exist", surface));
+
+    EXPECT_TRUE(AiNodeIsLinked(surface, "base_color"));
+    EXPECT_TRUE(AiNodeIsLinked(surface, "coat_color"));
+    EXPECT_FALSE(AiNodeIsLinked(surface, "base"));
+    auto comp = -1;
+    EXPECT_EQ(AiNodeGetLink(surface, "specular", &comp), image);
+    EXPECT_EQ(comp, 0);
+    EXPECT_EQ(AiNodeGetLink(surface, "base_color", &comp), noise);
+    EXPECT_EQ(comp, -1);
+
+    EXPECT_TRUE(AiNodeUnlink(surface, "coat_color"));
+    EXPECT_FALSE(AiNodeIsLinked(surface, "coat_color"));
+    AiNodeDestroy(noise);
+    EXPECT_FALSE(AiNodeIsLinked(surface, "base_color"));
+}
+
+TEST(ArnoldMock, Arrays) {
+    SETUP_UNIVERSE();
+    const float values[] = {1.0f, 2.0f, 3.0f, 4.0f};
+    auto* floats = AiArrayConvert(2, 2, AI_TYPE_FLOAT, values);
+    EXPECT_EQ(AiArrayGetNumElements(floats), 2);
+    EXPECT_EQ(AiArrayGetNumKeys(floats), 2);
+    EXPECT_EQ(AiArrayGetKeySize(floats), 2 * sizeof(float));
+    EXPECT_EQ(AiArrayGetFlt(floats, 3), 4.0f);
+    EXPECT_TRUE(AiArraySetFlt(floats, 0, 5.0f));
+    EXPECT_EQ(static_cast<float*>(AiArrayMap(floats))[0], 5.0f);
+    AiArrayUnmap(floats);
+    // Mismatching types and indices out of range only warn.
+    EXPECT_EQ(AiArrayGetInt(floats, 0), 0);
+    EXPECT_EQ(AiArrayGetFlt(floats, 4), 0.0f);
+    AiArrayDestroy(floats);
+
+    auto* strings = AiArray(2, 1, AI_TYPE_STRING, "a", "b");
+    EXPECT_EQ(AiArrayGetStr(strings, 1), AtString("b"));
+    auto* mesh = AiNode("polymesh");
+    AiNodeSetArray(mesh, "vidxs", AiArray(3, 1, AI_TYPE_UINT, 0, 1, 2));
+    EXPECT_EQ(AiArrayGetUInt(AiNodeGetArray(mesh, "vidxs"), 2), 2);
+    EXPECT_EQ(AiArrayGetNumElements(AiNodeGetArray(mesh, "matrix")), 1);
+    AiArrayDestroy(strings);
+}
+
+TEST(ArnoldMock, UserParameters) {
+    SETUP_UNIVERSE();
+    auto* mesh = AiNode("polymesh");
+    EXPECT_TRUE(AiNodeDeclare(mesh, "constantFloat", "constant FLOAT"));
+    EXPECT_TRUE(AiNodeDeclare(mesh, "varyingColor", "varying RGB"));
+    EXPECT_TRUE(AiNodeDeclare(mesh, "indexedVector", "indexed VECTOR"));
+    EXPECT_TRUE(AiNodeDeclare(mesh, "constantArray", "constant ARRAY INT"));
+    EXPECT_FALSE(AiNodeDeclare(mesh, "constantFloat", "constant FLOAT"));
+    EXPECT_FALSE(AiNodeDeclare(mesh, "invalid", "constant SOMETHING"));
+
+    AiNodeSetFlt(mesh, "constantFloat", 2.0f);
+    EXPECT_EQ(AiNodeGetFlt(mesh, "constantFloat"), 2.0f);
+    AiNodeSetArray(mesh, "varyingColor", AiArrayAllocate(4, 1, AI_TYPE_RGB));
+    AiNodeSetArray(
+        mesh, "indexedVectoridxs", AiArray(2, 1, AI_TYPE_UINT, 0, 0));
+
+    const auto* param = AiNodeLookUpUserParameter(mesh, "constantArray");
+    ASSERT_NE(param, nullptr);
+    EXPECT_EQ(AiUserParamGetType(param), AI_TYPE_ARRAY);
+    EXPECT_EQ(AiUserParamGetArrayType(param), AI_TYPE_INT);
+    EXPECT_EQ(AiUserParamGetCategory(param), AI_USERDEF_CONSTANT);
+
+    auto* iter = AiNodeGetUserParamIterator(mesh);
+    auto count = 0;
+    while (!AiUserParamIteratorFinished(iter)) {
+        AiUserParamIteratorGetNext(iter);
+        ++count;
+    }
+    AiUserParamIteratorDestroy(iter);
+    EXPECT_EQ(count, 4);
+}
+
+TEST(ArnoldMock, CallStats) {
+    SETUP_UNIVERSE();
+    auto* node = AiNode("standard_surface");
+    for (auto i = 0; i < 10; ++i) { AiNodeSetFlt(node, "base", 0.5f); }
+    auto stats = ArnoldMock::GetCallStats();
+    EXPECT_EQ(stats["AiNodeSetFlt"].count, 10);
+    EXPECT_EQ(stats["AiNode"].count, 1);
+    EXPECT_GE(stats["AiNodeSetFlt"].seconds, 0.0);
+    ArnoldMock::ResetCallStats();
+    stats = ArnoldMock::GetCallStats();
+    EXPECT_EQ(stats.find("AiNodeSetFlt"), stats.end());
+}
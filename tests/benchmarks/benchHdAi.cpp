@@ -0,0 +1,203 @@
+// Copyright 2019 Luma Pictures
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <pxr/pxr.h>
+#include <pxr/base/gf/matrix4d.h>
+#include <pxr/base/gf/matrix4f.h>
+#include <pxr/base/gf/vec2f.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+#include <pxr/imaging/hd/sceneDelegate.h>
+#include <pxr/imaging/hd/tokens.h>
+
+#include "pxr/imaging/hdAi/nodes/nodes.h"
+#include "pxr/imaging/hdAi/utils.h"
+
+#include <ai.h>
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace {
+
+// From a single prim to a dense point cloud.
+constexpr int64_t minArraySize = 1000;
+constexpr int64_t maxArraySize = 50000000;
+// Keeping the memory use of vector arrays in a similar range.
+constexpr int64_t maxVectorArraySize = 10000000;
+// Instanced scenes rarely go over a few million transforms.
+constexpr int64_t maxMatrixCount = 1000000;
+
+// Returns the same value for every primvar.
+class BenchSceneDelegate : public HdSceneDelegate {
+public:
+    explicit BenchSceneDelegate(VtValue value)
+        : HdSceneDelegate(nullptr, SdfPath::AbsoluteRootPath()),
+          _value(std::move(value)) {}
+
+    VtValue Get(const SdfPath& id, const TfToken& key) override {
+        return _value;
+    }
+
+private:
+    VtValue _value;
+};
+
+void BM_ConvertMatrixToArnold(benchmark::State& state) {
+    std::vector<GfMatrix4d> in(state.range(0), GfMatrix4d(1.0));
+    std::vector<AtMatrix> out(state.range(0));
+    for (auto _ : state) {
+        for (size_t i = 0; i < in.size(); ++i) {
+            out[i] = HdAiConvertMatrix(in[i]);
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ConvertMatrixToArnold)
+    ->RangeMultiplier(10)
+    ->Range(minArraySize, maxMatrixCount);
+
+void BM_ConvertMatrixFromArnold(benchmark::State& state) {
+    std::vector<AtMatrix> in(state.range(0), AiM4Identity());
+    std::vector<GfMatrix4f> out(state.range(0));
+    for (auto _ : state) {
+        for (size_t i = 0; i < in.size(); ++i) {
+            out[i] = HdAiConvertMatrix(in[i]);
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ConvertMatrixFromArnold)
+    ->RangeMultiplier(10)
+    ->Range(minArraySize, maxMatrixCount);
+
+using PrimvarSetter = void (*)(
+    AtNode*, const SdfPath&, HdSceneDelegate*, const HdPrimvarDescriptor&);
+
+// User parameters can't be declared twice, so every iteration creates a new
+// polymesh, which is negligible next to the larger arrays.
+template <typename T>
+void benchPrimvar(
+    benchmark::State& state, PrimvarSetter setter,
+    const HdInterpolation interpolation, const TfToken& role) {
+    BenchSceneDelegate delegate(VtValue(VtArray<T>(state.range(0))));
+    const SdfPath id("/mesh");
+    const HdPrimvarDescriptor desc(TfToken("primvar"), interpolation, role);
+    for (auto _ : state) {
+        auto* node = AiNode("polymesh");
+        setter(node, id, &delegate, desc);
+        AiNodeDestroy(node);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_VertexPrimvarFloat(benchmark::State& state) {
+    benchPrimvar<float>(
+        state, HdAiSetVertexPrimvar, HdInterpolationVertex, TfToken());
+}
+
+BENCHMARK(BM_VertexPrimvarFloat)
+    ->RangeMultiplier(10)
+    ->Range(minArraySize, maxArraySize);
+
+void BM_VertexPrimvarVec3f(benchmark::State& state) {
+    benchPrimvar<GfVec3f>(
+        state, HdAiSetVertexPrimvar, HdInterpolationVertex, TfToken());
+}
+
+BENCHMARK(BM_VertexPrimvarVec3f)
+    ->RangeMultiplier(10)
+    ->Range(minArraySize, maxVectorArraySize);
+
+void BM_UniformPrimvarColor(benchmark::State& state) {
+    benchPrimvar<GfVec3f>(
+        state, HdAiSetUniformPrimvar, HdInterpolationUniform,
+        HdPrimvarRoleTokens->color);
+}
+
+BENCHMARK(BM_UniformPrimvarColor)
+    ->RangeMultiplier(10)
+    ->Range(minArraySize, maxVectorArraySize);
+
+// Includes generating the index array.
+void BM_FaceVaryingPrimvarVec2f(benchmark::State& state) {
+    benchPrimvar<GfVec2f>(
+        state, HdAiSetFaceVaryingPrimvar, HdInterpolationFaceVarying,
+        TfToken());
+}
+
+BENCHMARK(BM_FaceVaryingPrimvarVec2f)
+    ->RangeMultiplier(10)
+    ->Range(minArraySize, maxVectorArraySize);
+
+// Constant arrays of a few elements are the common case.
+void BM_ConstantPrimvar(benchmark::State& state) {
+    BenchSceneDelegate delegate(VtValue(GfVec3f(1.0f)));
+    const SdfPath id("/mesh");
+    const HdPrimvarDescriptor desc(
+        TfToken("primvar"), HdInterpolationConstant,
+        HdPrimvarRoleTokens->color);
+    for (auto _ : state) {
+        auto* node = AiNode("polymesh");
+        HdAiSetConstantPrimvar(node, id, &delegate, desc);
+        AiNodeDestroy(node);
+    }
+}
+
+BENCHMARK(BM_ConstantPrimvar);
+
+// The range is the side of the bucket, from the default bucket size to
+// a whole frame processed at once.
+void BM_QuantizeBucket(benchmark::State& state) {
+    const auto side = static_cast<int>(state.range(0));
+    std::vector<AtRGBA> in(side * side, AtRGBA(0.5f, 0.5f, 0.5f, 1.0f));
+    std::vector<AtRGBA8> out(side * side);
+    for (auto _ : state) {
+        hdAiQuantizeBucket(in.data(), 0, 0, side, side, out.data());
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * side * side);
+}
+
+BENCHMARK(BM_QuantizeBucket)->RangeMultiplier(4)->Range(16, 4096);
+
+void BM_ProjectDepthBucket(benchmark::State& state) {
+    const auto side = static_cast<int>(state.range(0));
+    std::vector<GfVec3f> in(side * side, GfVec3f(1.0f, 2.0f, -3.0f));
+    std::vector<float> out(side * side);
+    GfMatrix4f viewMtx(1.0f);
+    viewMtx.SetTranslate(GfVec3f(0.0f, 0.0f, -10.0f));
+    GfMatrix4f projMtx(1.0f);
+    projMtx[2][3] = -1.0f;
+    for (auto _ : state) {
+        hdAiProjectDepthBucket(
+            in.data(), viewMtx, projMtx, side * side, out.data());
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * side * side);
+}
+
+BENCHMARK(BM_ProjectDepthBucket)->RangeMultiplier(4)->Range(16, 4096);
+
+} // namespace
@@ -0,0 +1,252 @@
+// Copyright 2019 Luma Pictures
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <pxr/pxr.h>
+#include <pxr/base/tf/stringUtils.h>
+#include <pxr/usd/sdf/types.h>
+#include <pxr/usd/usd/stage.h>
+
+#include "pxr/usd/usdAi/aiNodeAPI.h"
+#include "pxr/usd/usdAi/aiShaderExport.h"
+
+#include <ai.h>
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace {
+
+// From a single prim to a dense point cloud.
+constexpr int64_t minArraySize = 1000;
+constexpr int64_t maxArraySize = 50000000;
+// Keeping the memory use of vector arrays in a similar range.
+constexpr int64_t maxVectorArraySize = 10000000;
+constexpr int64_t maxStringArraySize = 100000;
+
+const int paramTypes[] = {
+    AI_TYPE_BYTE,    AI_TYPE_INT,    AI_TYPE_UINT,   AI_TYPE_BOOLEAN,
+    AI_TYPE_FLOAT,   AI_TYPE_RGB,    AI_TYPE_RGBA,   AI_TYPE_VECTOR,
+    AI_TYPE_VECTOR2, AI_TYPE_STRING, AI_TYPE_POINTER, AI_TYPE_NODE,
+    AI_TYPE_ARRAY,   AI_TYPE_MATRIX, AI_TYPE_ENUM,   AI_TYPE_CLOSURE};
+
+template <uint8_t ArnoldType>
+void BM_ExportArray(benchmark::State& state) {
+    const auto* conversion = AiShaderExport::get_array_conversion(ArnoldType);
+    if (conversion == nullptr) {
+        state.SkipWithError("No array conversion for the type.");
+        return;
+    }
+    auto* arr = AiArrayAllocate(state.range(0), 1, ArnoldType);
+    for (auto _ : state) { benchmark::DoNotOptimize(conversion->f(arr)); }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    AiArrayDestroy(arr);
+}
+
+BENCHMARK_TEMPLATE(BM_ExportArray, AI_TYPE_BYTE)
+    ->RangeMultiplier(10)
+    ->Range(minArraySize, maxArraySize);
+BENCHMARK_TEMPLATE(BM_ExportArray, AI_TYPE_UINT)
+    ->RangeMultiplier(10)
+    ->Range(minArraySize, maxArraySize);
+BENCHMARK_TEMPLATE(BM_ExportArray, AI_TYPE_FLOAT)
+    ->RangeMultiplier(10)
+    ->Range(minArraySize, maxArraySize);
+BENCHMARK_TEMPLATE(BM_ExportArray, AI_TYPE_VECTOR2)
+    ->RangeMultiplier(10)
+    ->Range(minArraySize, maxVectorArraySize);
+BENCHMARK_TEMPLATE(BM_ExportArray, AI_TYPE_VECTOR)
+    ->RangeMultiplier(10)
+    ->Range(minArraySize, maxVectorArraySize);
+BENCHMARK_TEMPLATE(BM_ExportArray, AI_TYPE_RGBA)
+    ->RangeMultiplier(10)
+    ->Range(minArraySize, maxVectorArraySize);
+BENCHMARK_TEMPLATE(BM_ExportArray, AI_TYPE_STRING)
+    ->RangeMultiplier(10)
+    ->Range(minArraySize, maxStringArraySize);
+
+void BM_GetParamConversion(benchmark::State& state) {
+    for (auto _ : state) {
+        for (const auto type : paramTypes) {
+            benchmark::DoNotOptimize(
+                AiShaderExport::get_param_conversion(type));
+        }
+    }
+    state.SetItemsProcessed(
+        state.iterations() * sizeof(paramTypes) / sizeof(paramTypes[0]));
+}
+
+BENCHMARK(BM_GetParamConversion);
+
+// Reads every parameter of a standard_surface, like export_arnold_node.
+void BM_ParamConversion(benchmark::State& state) {
+    auto* node = AiNode("standard_surface");
+    const auto* nentry = AiNodeGetNodeEntry(node);
+    std::vector<std::pair<const AtParamEntry*, const char*>> params;
+    auto* iter = AiNodeEntryGetParamIterator(nentry);
+    while (!AiParamIteratorFinished(iter)) {
+        const auto* pentry = AiParamIteratorGetNext(iter);
+        params.emplace_back(pentry, AiParamGetName(pentry).c_str());
+    }
+    AiParamIteratorDestroy(iter);
+    for (auto _ : state) {
+        for (const auto& param : params) {
+            const auto* conversion = AiShaderExport::get_param_conversion(
+                AiParamGetType(param.first));
+            if (conversion != nullptr && conversion->f != nullptr) {
+                benchmark::DoNotOptimize(conversion->f(node, param.second));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * params.size());
+    AiNodeDestroy(node);
+}
+
+BENCHMARK(BM_ParamConversion);
+
+// Reads the defaults of every parameter of a standard_surface, like
+// usdAiShaderInfo does for each installed node entry.
+void BM_DefaultValueConversion(benchmark::State& state) {
+    const auto* nentry = AiNodeEntryLookUp("standard_surface");
+    std::vector<const AtParamEntry*> params;
+    auto* iter = AiNodeEntryGetParamIterator(nentry);
+    while (!AiParamIteratorFinished(iter)) {
+        params.push_back(AiParamIteratorGetNext(iter));
+    }
+    AiParamIteratorDestroy(iter);
+    for (auto _ : state) {
+        for (const auto* pentry : params) {
+            const auto* conversion =
+                AiShaderExport::get_default_value_conversion(
+                    AiParamGetType(pentry));
+            if (conversion != nullptr && conversion->f != nullptr) {
+                benchmark::DoNotOptimize(
+                    conversion->f(*AiParamGetDefault(pentry), pentry));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * params.size());
+}
+
+BENCHMARK(BM_DefaultValueConversion);
+
+void BM_GetParamTypeTokenFromType(benchmark::State& state) {
+    for (auto _ : state) {
+        for (const auto type : paramTypes) {
+            benchmark::DoNotOptimize(
+                UsdAiNodeAPI::GetParamTypeTokenFromType(type));
+        }
+    }
+    state.SetItemsProcessed(
+        state.iterations() * sizeof(paramTypes) / sizeof(paramTypes[0]));
+}
+
+BENCHMARK(BM_GetParamTypeTokenFromType);
+
+void BM_GetParamTypeFromToken(benchmark::State& state) {
+    std::vector<TfToken> tokens;
+    for (const auto type : paramTypes) {
+        tokens.push_back(UsdAiNodeAPI::GetParamTypeTokenFromType(type));
+    }
+    for (auto _ : state) {
+        for (const auto& token : tokens) {
+            benchmark::DoNotOptimize(
+                UsdAiNodeAPI::GetParamTypeFromToken(token));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * tokens.size());
+}
+
+BENCHMARK(BM_GetParamTypeFromToken);
+
+void BM_GetNodeEntryTokenFromType(benchmark::State& state) {
+    const int types[] = {AI_NODE_SHADER, AI_NODE_SHAPE, AI_NODE_LIGHT,
+                         AI_NODE_CAMERA, AI_NODE_DRIVER, AI_NODE_FILTER};
+    for (auto _ : state) {
+        for (const auto type : types) {
+            benchmark::DoNotOptimize(
+                UsdAiNodeAPI::GetNodeEntryTokenFromType(type));
+        }
+    }
+    state.SetItemsProcessed(
+        state.iterations() * sizeof(types) / sizeof(types[0]));
+}
+
+BENCHMARK(BM_GetNodeEntryTokenFromType);
+
+// A shader prim with the given number of parameters, each of them with
+// a few metadata and a user attribute. The metadata is stored either as
+// separate attributes or in the customData of the parameters.
+UsdAiNodeAPI createNodePrim(
+    const UsdStageRefPtr& stage, int64_t numParams,
+    bool compactMetadata = false) {
+    auto prim = stage->DefinePrim(SdfPath("/shader"));
+    auto api = UsdAiNodeAPI::Apply(prim);
+    const char* metadata[] = {"desc", "min", "max", "softmax"};
+    for (auto i = decltype(numParams){0}; i < numParams; ++i) {
+        const auto name = TfStringPrintf("param%lld", (long long)i);
+        auto attr = prim.CreateAttribute(
+            TfToken(name), SdfValueTypeNames->Float, false);
+        for (const auto* meta : metadata) {
+            if (compactMetadata) {
+                api.SetMetadataOnAttribute(attr, TfToken(meta), VtValue(1.0f));
+            } else {
+                api.AddMetadataToAttribute(
+                    attr, TfToken(meta), SdfValueTypeNames->Float,
+                    VtValue(1.0f));
+            }
+        }
+        api.CreateUserAttribute(TfToken(name), SdfValueTypeNames->Float);
+    }
+    return api;
+}
+
+void BM_GetMetadataForAttribute(benchmark::State& state) {
+    auto stage = UsdStage::CreateInMemory("bench.usda");
+    const auto api = createNodePrim(stage, state.range(0));
+    const auto attr = api.GetPrim().GetAttribute(TfToken(
+        TfStringPrintf("param%lld", (long long)(state.range(0) / 2))));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(api.GetMetadataForAttribute(attr));
+    }
+}
+
+BENCHMARK(BM_GetMetadataForAttribute)->RangeMultiplier(10)->Range(10, 1000);
+
+void BM_GetUserAttributes(benchmark::State& state) {
+    auto stage = UsdStage::CreateInMemory("bench.usda");
+    const auto api = createNodePrim(stage, state.range(0));
+    for (auto _ : state) { benchmark::DoNotOptimize(api.GetUserAttributes()); }
+}
+
+BENCHMARK(BM_GetUserAttributes)->RangeMultiplier(10)->Range(10, 1000);
+
+// The second argument selects the compact metadata encoding.
+void BM_GetMetadataValuesForAttribute(benchmark::State& state) {
+    auto stage = UsdStage::CreateInMemory("bench.usda");
+    const auto api =
+        createNodePrim(stage, state.range(0), state.range(1) != 0);
+    const auto attr = api.GetPrim().GetAttribute(TfToken(
+        TfStringPrintf("param%lld", (long long)(state.range(0) / 2))));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(api.GetMetadataValuesForAttribute(attr));
+    }
+}
+
+BENCHMARK(BM_GetMetadataValuesForAttribute)
+    ->RangeMultiplier(10)
+    ->Ranges({{10, 1000}, {0, 1}});
+
+} // namespace
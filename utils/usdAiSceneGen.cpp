@@ -0,0 +1,484 @@
+// Copyright 2019 Luma Pictures
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/tf/staticTokens.h>
+#include <pxr/base/tf/stringUtils.h>
+#include <pxr/base/vt/types.h>
+
+#include <pxr/usd/sdf/attributeSpec.h>
+#include <pxr/usd/sdf/changeBlock.h>
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/sdf/primSpec.h>
+#include <pxr/usd/sdf/relationshipSpec.h>
+#include <pxr/usd/sdf/types.h>
+
+#include <pxr/usd/usdGeom/tokens.h>
+#include <pxr/usd/usdShade/tokens.h>
+
+#include <pxr/usd/usdAi/tokens.h>
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+TF_DEFINE_PRIVATE_TOKENS(_tokens,
+    (Material)
+    (Mesh)
+    (Scope)
+    (Xform)
+    (Volume)
+    (OpenVDBAsset)
+    (DistantLight)
+    (AiShader)
+    (AiAOV)
+    (AiDriver)
+    (AiFilter)
+    (standard_surface)
+    (standard_volume)
+    (user_data_rgb)
+    (density)
+    (RGBA)
+    ((infoId, "info:id"))
+    ((outputsOut, "outputs:out"))
+    ((outputsSurface, "outputs:surface"))
+    ((outputsVolume, "outputs:volume"))
+    ((fieldDensity, "field:density"))
+    ((xformOpTranslate, "xformOp:translate"))
+    ((xformOpOrder, "xformOpOrder"))
+);
+
+namespace {
+
+constexpr auto helpText = R"VOGON(
+usage usdAiSceneGen
+        [-h] [--out FILENAME]
+        [--prims N] [--resolution N]
+        [--instanceRatio RATIO] [--prototypes N]
+        [--materialSharing RATIO]
+        [--primvars N]
+        [--aovs N]
+        [--volumes N --vdb FILENAME]
+        [--seed N]
+
+Generate a synthetic stage for scale testing usdAi and hdAi.
+
+The stage has a grid of meshes under /World, bound to AiShader networks
+under /Looks, and AiAOVs under /Render. The layer is written directly with
+the Sdf API, so generating millions of prims stays fast.
+
+optional arguments:
+ --out              Output file, scene.usdc by default.
+ --prims            Number of meshes and instances, 1000 by default.
+ --resolution       Number of quads along each side of a mesh, 8 by default.
+ --instanceRatio    Ratio of the prims that are instances of a prototype,
+                    0 by default.
+ --prototypes       Number of prototypes shared by the instances, 16 by
+                    default.
+ --materialSharing  0 gives every mesh its own material, 1 binds the same
+                    material to all of them, 0 by default.
+ --primvars         Number of per vertex color primvars on each mesh, read
+                    by the materials, 0 by default.
+ --aovs             Number of AiAOVs, 0 by default.
+ --volumes          Number of volumes referencing the --vdb file, 0 by
+                    default.
+ --vdb              OpenVDB file to reference from the volumes.
+ --seed             Seed for the random values, 0 by default.
+)VOGON";
+
+// Prims are grouped, so no prim has millions of children.
+constexpr int groupSize = 1000;
+
+SdfPrimSpecHandle definePrim(
+    const SdfPrimSpecHandle& parent, const std::string& name,
+    const TfToken& typeName, SdfSpecifier specifier = SdfSpecifierDef) {
+    return SdfPrimSpec::New(parent, name, specifier, typeName);
+}
+
+template <typename T>
+SdfAttributeSpecHandle setAttribute(
+    const SdfPrimSpecHandle& prim, const TfToken& name,
+    const SdfValueTypeName& typeName, const T& value,
+    SdfVariability variability = SdfVariabilityVarying) {
+    auto attr = SdfAttributeSpec::New(prim, name, typeName, variability);
+    if (attr) { attr->SetDefaultValue(VtValue(value)); }
+    return attr;
+}
+
+void addTarget(
+    const SdfPrimSpecHandle& prim, const TfToken& name, const SdfPath& target) {
+    auto rel = SdfRelationshipSpec::New(prim, name);
+    if (rel) { rel->GetTargetPathList().Add(target); }
+}
+
+void connect(const SdfAttributeSpecHandle& attr, const SdfPath& source) {
+    if (attr) { attr->GetConnectionPathList().Add(source); }
+}
+
+void setTranslate(const SdfPrimSpecHandle& prim, const GfVec3d& translate) {
+    setAttribute(
+        prim, _tokens->xformOpTranslate, SdfValueTypeNames->Double3,
+        translate);
+    setAttribute(
+        prim, _tokens->xformOpOrder, SdfValueTypeNames->TokenArray,
+        VtTokenArray{_tokens->xformOpTranslate}, SdfVariabilityUniform);
+}
+
+TfToken getPrimvarName(int index) {
+    return TfToken(TfStringPrintf("primvar_%d", index));
+}
+
+/// Topology and points of a unit grid in the XZ plane, shared by all
+/// meshes.
+struct GridMesh {
+    explicit GridMesh(int resolution) {
+        const auto verticesPerSide = resolution + 1;
+        points.reserve(verticesPerSide * verticesPerSide);
+        for (auto z = 0; z < verticesPerSide; ++z) {
+            for (auto x = 0; x < verticesPerSide; ++x) {
+                points.push_back(GfVec3f(
+                    static_cast<float>(x) / resolution - 0.5f, 0.0f,
+                    static_cast<float>(z) / resolution - 0.5f));
+            }
+        }
+        faceVertexCounts.assign(resolution * resolution, 4);
+        faceVertexIndices.reserve(resolution * resolution * 4);
+        for (auto z = 0; z < resolution; ++z) {
+            for (auto x = 0; x < resolution; ++x) {
+                const auto v = z * verticesPerSide + x;
+                faceVertexIndices.push_back(v);
+                faceVertexIndices.push_back(v + verticesPerSide);
+                faceVertexIndices.push_back(v + verticesPerSide + 1);
+                faceVertexIndices.push_back(v + 1);
+            }
+        }
+        extent = VtVec3fArray{GfVec3f(-0.5f, 0.0f, -0.5f),
+                              GfVec3f(0.5f, 0.0f, 0.5f)};
+    }
+
+    VtVec3fArray points;
+    VtIntArray faceVertexCounts;
+    VtIntArray faceVertexIndices;
+    VtVec3fArray extent;
+};
+
+class SceneGenerator {
+public:
+    SceneGenerator(unsigned int seed, int primvars)
+        : _random(seed), _primvars(primvars) {}
+
+    SdfPath CreateMaterial(const SdfPrimSpecHandle& looks, int index) {
+        auto material = definePrim(
+            looks, TfStringPrintf("material_%d", index), _tokens->Material);
+        auto shader = definePrim(material, "surface", _tokens->AiShader);
+        setAttribute(
+            shader, _tokens->infoId, SdfValueTypeNames->Token,
+            _tokens->standard_surface, SdfVariabilityUniform);
+        auto baseColor = setAttribute(
+            shader, TfToken("inputs:base_color"), SdfValueTypeNames->Color3f,
+            _RandomColor());
+        setAttribute(
+            shader, TfToken("inputs:specular_roughness"),
+            SdfValueTypeNames->Float, _RandomFloat());
+        setAttribute(
+            shader, _tokens->outputsOut, SdfValueTypeNames->Color3f,
+            GfVec3f(0.0f));
+        if (_primvars > 0) {
+            auto reader =
+                definePrim(material, "primvarReader", _tokens->AiShader);
+            setAttribute(
+                reader, _tokens->infoId, SdfValueTypeNames->Token,
+                _tokens->user_data_rgb, SdfVariabilityUniform);
+            setAttribute(
+                reader, TfToken("inputs:attribute"), SdfValueTypeNames->String,
+                getPrimvarName(index % _primvars).GetString());
+            setAttribute(
+                reader, _tokens->outputsOut, SdfValueTypeNames->Color3f,
+                GfVec3f(0.0f));
+            connect(
+                baseColor, reader->GetPath().AppendProperty(
+                               _tokens->outputsOut));
+        }
+        const auto shaderOut =
+            shader->GetPath().AppendProperty(_tokens->outputsOut);
+        connect(
+            setAttribute(
+                material, _tokens->outputsSurface, SdfValueTypeNames->Token,
+                TfToken()),
+            shaderOut);
+        addTarget(material, UsdAiTokens->aiSurface, shader->GetPath());
+        return material->GetPath();
+    }
+
+    SdfPath CreateVolumeMaterial(const SdfPrimSpecHandle& looks) {
+        auto material = definePrim(looks, "volumeMaterial", _tokens->Material);
+        auto shader = definePrim(material, "volume", _tokens->AiShader);
+        setAttribute(
+            shader, _tokens->infoId, SdfValueTypeNames->Token,
+            _tokens->standard_volume, SdfVariabilityUniform);
+        setAttribute(
+            shader, TfToken("inputs:density_channel"),
+            SdfValueTypeNames->String, _tokens->density.GetString());
+        setAttribute(
+            shader, _tokens->outputsOut, SdfValueTypeNames->Color3f,
+            GfVec3f(0.0f));
+        connect(
+            setAttribute(
+                material, _tokens->outputsVolume, SdfValueTypeNames->Token,
+                TfToken()),
+            shader->GetPath().AppendProperty(_tokens->outputsOut));
+        addTarget(material, UsdAiTokens->aiVolume, shader->GetPath());
+        return material->GetPath();
+    }
+
+    void CreateMesh(
+        const SdfPrimSpecHandle& parent, const std::string& name,
+        const GridMesh& grid, const SdfPath& material) {
+        auto mesh = definePrim(parent, name, _tokens->Mesh);
+        setAttribute(
+            mesh, UsdGeomTokens->points, SdfValueTypeNames->Point3fArray,
+            grid.points);
+        setAttribute(
+            mesh, UsdGeomTokens->faceVertexCounts, SdfValueTypeNames->IntArray,
+            grid.faceVertexCounts);
+        setAttribute(
+            mesh, UsdGeomTokens->faceVertexIndices,
+            SdfValueTypeNames->IntArray, grid.faceVertexIndices);
+        setAttribute(
+            mesh, UsdGeomTokens->extent, SdfValueTypeNames->Float3Array,
+            grid.extent);
+        for (auto i = 0; i < _primvars; ++i) {
+            VtVec3fArray values(grid.points.size());
+            for (auto& value : values) { value = _RandomColor(); }
+            auto primvar = setAttribute(
+                mesh, TfToken("primvars:" + getPrimvarName(i).GetString()),
+                SdfValueTypeNames->Color3fArray, values);
+            primvar->SetField(
+                UsdGeomTokens->interpolation, VtValue(UsdGeomTokens->vertex));
+        }
+        addTarget(mesh, UsdShadeTokens->materialBinding, material);
+    }
+
+private:
+    float _RandomFloat() {
+        return std::uniform_real_distribution<float>(0.0f, 1.0f)(_random);
+    }
+
+    GfVec3f _RandomColor() {
+        return GfVec3f(_RandomFloat(), _RandomFloat(), _RandomFloat());
+    }
+
+    std::mt19937 _random;
+    int _primvars;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const auto* startArg = argv;
+    const auto* endArg = argv + argc;
+
+    auto findFlag = [&](const std::string& argName) -> bool {
+        return std::find(startArg, endArg, argName) != endArg;
+    };
+
+    auto getFlagValue = [&](const std::string& argName,
+                            const std::string& defaultValue =
+                                "") -> std::string {
+        const auto* flag = std::find(startArg, endArg, argName);
+        if (flag >= (endArg - 1)) { return defaultValue; }
+        return *(++flag);
+    };
+
+    if (findFlag("-h") || findFlag("--help")) {
+        std::cout << helpText;
+        return 0;
+    }
+
+    const auto outFile = getFlagValue("--out", "scene.usdc");
+    int prims = 1000;
+    int resolution = 8;
+    double instanceRatio = 0.0;
+    int prototypes = 16;
+    double materialSharing = 0.0;
+    int primvars = 0;
+    int aovs = 0;
+    int volumes = 0;
+    unsigned int seed = 0;
+    try {
+        prims = std::max(0, std::stoi(getFlagValue("--prims", "1000")));
+        resolution = std::max(1, std::stoi(getFlagValue("--resolution", "8")));
+        instanceRatio = std::min(
+            1.0,
+            std::max(0.0, std::stod(getFlagValue("--instanceRatio", "0"))));
+        prototypes =
+            std::max(1, std::stoi(getFlagValue("--prototypes", "16")));
+        materialSharing = std::min(
+            1.0,
+            std::max(0.0, std::stod(getFlagValue("--materialSharing", "0"))));
+        primvars = std::max(0, std::stoi(getFlagValue("--primvars", "0")));
+        aovs = std::max(0, std::stoi(getFlagValue("--aovs", "0")));
+        volumes = std::max(0, std::stoi(getFlagValue("--volumes", "0")));
+        seed =
+            static_cast<unsigned int>(std::stoul(getFlagValue("--seed", "0")));
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid argument: " << e.what() << "." << std::endl
+                  << helpText;
+        return 1;
+    }
+    const auto vdb = getFlagValue("--vdb");
+
+    if (volumes > 0 && vdb.empty()) {
+        std::cerr << "--volumes requires a --vdb file." << std::endl;
+        return 1;
+    }
+
+    auto layer = SdfLayer::CreateNew(outFile);
+    if (!layer) {
+        std::cerr << "Can't create " << outFile << "." << std::endl;
+        return 1;
+    }
+
+    const auto instances = static_cast<int>(std::round(prims * instanceRatio));
+    const auto meshes = prims - instances;
+    const auto materials = std::max(
+        1, static_cast<int>(std::round(meshes * (1.0 - materialSharing))));
+    const auto columns = std::max(
+        1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(prims)))));
+    auto getPosition = [&](int index) -> GfVec3d {
+        return GfVec3d(
+            (index % columns) * 1.5 - columns * 0.75, 0.0,
+            (index / columns) * 1.5 - columns * 0.75);
+    };
+
+    SceneGenerator generator(seed, primvars);
+    const GridMesh grid(resolution);
+    {
+        SdfChangeBlock changeBlock;
+        auto root = layer->GetPseudoRoot();
+        layer->SetDefaultPrim(TfToken("World"));
+        layer->SetField(
+            SdfPath::AbsoluteRootPath(), UsdGeomTokens->upAxis,
+            VtValue(UsdGeomTokens->y));
+
+        auto looks = definePrim(root, "Looks", _tokens->Scope);
+        SdfPathVector materialPaths;
+        materialPaths.reserve(materials);
+        for (auto i = 0; i < materials; ++i) {
+            materialPaths.push_back(generator.CreateMaterial(looks, i));
+        }
+
+        // Prototypes are classes, so they are only rendered through the
+        // instances.
+        SdfPathVector prototypePaths;
+        if (instances > 0) {
+            auto prototypeRoot = definePrim(
+                root, "Prototypes", _tokens->Scope, SdfSpecifierClass);
+            for (auto i = 0; i < prototypes; ++i) {
+                auto prototype = definePrim(
+                    prototypeRoot, TfStringPrintf("prototype_%d", i),
+                    _tokens->Xform);
+                generator.CreateMesh(
+                    prototype, "mesh", grid,
+                    materialPaths[i % materialPaths.size()]);
+                prototypePaths.push_back(prototype->GetPath());
+            }
+        }
+
+        auto world = definePrim(root, "World", _tokens->Xform);
+        auto sun = definePrim(world, "sun", _tokens->DistantLight);
+        setAttribute(
+            sun, TfToken("intensity"), SdfValueTypeNames->Float, 1.0f);
+
+        SdfPrimSpecHandle group;
+        for (auto i = 0; i < prims; ++i) {
+            if (i % groupSize == 0) {
+                group = definePrim(
+                    world, TfStringPrintf("group_%d", i / groupSize),
+                    _tokens->Xform);
+            }
+            const auto name = TfStringPrintf("prim_%d", i);
+            if (i < instances) {
+                auto instance = definePrim(group, name, _tokens->Xform);
+                instance->GetReferenceList().Add(SdfReference(
+                    std::string(), prototypePaths[i % prototypePaths.size()]));
+                instance->SetInstanceable(true);
+                setTranslate(instance, getPosition(i));
+            } else {
+                auto xform = definePrim(group, name, _tokens->Xform);
+                setTranslate(xform, getPosition(i));
+                generator.CreateMesh(
+                    xform, "mesh", grid,
+                    materialPaths[(i - instances) % materialPaths.size()]);
+            }
+        }
+
+        if (volumes > 0) {
+            const auto volumeMaterial = generator.CreateVolumeMaterial(looks);
+            auto volumeRoot = definePrim(world, "volumes", _tokens->Xform);
+            for (auto i = 0; i < volumes; ++i) {
+                auto volume = definePrim(
+                    volumeRoot, TfStringPrintf("volume_%d", i),
+                    _tokens->Volume);
+                setTranslate(volume, GfVec3d(i * 2.0, 2.0, 0.0));
+                auto field =
+                    definePrim(volume, "density", _tokens->OpenVDBAsset);
+                setAttribute(
+                    field, TfToken("filePath"), SdfValueTypeNames->Asset,
+                    SdfAssetPath(vdb));
+                setAttribute(
+                    field, TfToken("fieldName"), SdfValueTypeNames->Token,
+                    _tokens->density);
+                addTarget(volume, _tokens->fieldDensity, field->GetPath());
+                addTarget(
+                    volume, UsdShadeTokens->materialBinding, volumeMaterial);
+            }
+        }
+
+        if (aovs > 0) {
+            auto render = definePrim(root, "Render", _tokens->Scope);
+            auto driver = definePrim(render, "driver", _tokens->AiDriver);
+            setAttribute(
+                driver, TfToken("path"), SdfValueTypeNames->String,
+                std::string("render.exr"), SdfVariabilityUniform);
+            auto filter = definePrim(render, "filter", _tokens->AiFilter);
+            setAttribute(
+                filter, TfToken("size"), SdfValueTypeNames->Float, 2.0f,
+                SdfVariabilityUniform);
+            for (auto i = 0; i < aovs; ++i) {
+                auto aov = definePrim(
+                    render, TfStringPrintf("aov_%d", i), _tokens->AiAOV);
+                setAttribute(
+                    aov, TfToken("name"), SdfValueTypeNames->String,
+                    TfStringPrintf("aov_%d", i), SdfVariabilityUniform);
+                setAttribute(
+                    aov, TfToken("dataType"), SdfValueTypeNames->Token,
+                    _tokens->RGBA);
+                addTarget(aov, TfToken("driver"), driver->GetPath());
+                addTarget(aov, TfToken("filter"), filter->GetPath());
+            }
+        }
+    }
+
+    if (!layer->Save()) {
+        std::cerr << "Can't save " << outFile << "." << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -13,23 +13,22 @@
 // limitations under the License.
 #include <ai.h>
 
-#include <pxr/usd/usd/prim.h>
+#include <pxr/base/arch/fileSystem.h>
+#include <pxr/base/tf/fileUtils.h>
+#include <pxr/base/tf/stringUtils.h>
+#include <pxr/base/vt/dictionary.h>
+#include <pxr/usd/sdf/changeBlock.h>
+#include <pxr/usd/sdf/primSpec.h>
 #include <pxr/usd/usd/stage.h>
 
-#include <pxr/usd/usdAi/aiNodeAPI.h>
-#include <pxr/usd/usdAi/aiShader.h>
-#include <pxr/usd/usdAi/aiShaderExport.h>
-#include <pxr/usd/usdAi/tokens.h>
+#include <pxr/usd/usdAi/utils.h>
 
 #include <algorithm>
 #include <iostream>
 #include <string>
-#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
-#include <dirent.h>
-#include <sys/stat.h>
-
 PXR_NAMESPACE_USING_DIRECTIVE
 
 namespace {
@@ -40,6 +39,8 @@ usage usdAiShaderInfo
         [--usd FILENAME]
         [--meta DIR|FILE]
         [--load DIR]
+        [--incremental]
+        [--metadata-attributes]
 
 Print Arnold node information into a USD file or to the standard output.
 
@@ -51,20 +52,38 @@ optional arguments:
  --usd      Output the node information into a USD file.
  --meta     Load metadata file or all the .mtd files in a directory.
  --load     Load the shaders from a directory.
+ --incremental
+            Update the file passed to --usd in place, only describing the
+            node entries of plugins that changed since it was written.
+ --metadata-attributes
+            Store parameter metadata as separate attributes instead of the
+            customData of the parameters, for older readers.
 )VOGON";
 
-enum class StatResult { IS_DIR, IS_FILE, IS_UNSUPPORTED };
+// Stamps of the inputs are stored in the custom layer data, so incremental
+// runs can tell which node entries are out of date.
+const std::string stampsKey("usdAiShaderInfo");
+const std::string environmentKey("environment");
+const std::string pluginsKey("plugins");
 
-StatResult checkPath(const char* p) {
-    struct stat s;
-    if (stat(p, &s) == 0) {
-        if (s.st_mode & S_IFDIR) {
-            return StatResult::IS_DIR;
-        } else if (s.st_mode & S_IFREG) {
-            return StatResult::IS_FILE;
-        }
+double getModificationTime(const char* path) {
+    double mtime = 0.0;
+    ArchGetModificationTime(path, &mtime);
+    return mtime;
+}
+
+// Changes to the Arnold version, the layout of the description or the
+// metadata files affect every node entry, so they invalidate the whole file.
+std::string getEnvironmentStamp(
+    const std::vector<std::string>& metadata, bool compactMetadata) {
+    std::string stamp = AiGetVersion(nullptr, nullptr, nullptr, nullptr);
+    stamp += "\n" + TfStringify(UsdAiShaderDescVersion);
+    stamp += compactMetadata ? "\ncompact" : "\nattributes";
+    for (const auto& file : metadata) {
+        stamp += "\n" + file + ":" +
+                 TfStringify(getModificationTime(file.c_str()));
     }
-    return StatResult::IS_UNSUPPORTED;
+    return stamp;
 }
 
 } // namespace
@@ -105,8 +124,15 @@ int main(int argc, char* argv[]) {
     const std::string outFile = cout ? "" : getFlagValue("--usd", "");
     if (outFile.empty()) { cout = true; }
 
-    auto stage = cout ? UsdStage::CreateInMemory(".usda")
-                      : UsdStage::Open(SdfLayer::CreateNew(outFile));
+    const auto incremental =
+        !cout && findFlag("--incremental") && TfIsFile(outFile);
+    auto layer = incremental ? SdfLayer::FindOrOpen(outFile)
+                             : cout ? SdfLayer::CreateAnonymous(".usda")
+                                    : SdfLayer::CreateNew(outFile);
+    if (!layer) {
+        std::cerr << "Can't open " << outFile << std::endl;
+        return 1;
+    }
 
     AiBegin();
     AiMsgSetConsoleFlags(AI_LOG_NONE);
@@ -117,114 +143,87 @@ int main(int argc, char* argv[]) {
         AiLoadPlugins(plugin.c_str());
     }
 
-    // TODO: check for the file extension.
-    for (const auto& plugin : getFlagValues("--meta")) {
-        const auto result = checkPath(plugin.c_str());
-        if (result == StatResult::IS_DIR) {
-            auto* d = opendir(plugin.c_str());
-            if (d != nullptr) {
-                for (struct dirent* de = nullptr;
-                     (de = readdir(d)) != nullptr;) {
-                    if (strcmp(de->d_name, ".") == 0) { continue; }
-                    if (strcmp(de->d_name, "..") == 0) { continue; }
-                    std::stringstream ss;
-                    ss << plugin << "/" << de->d_name;
-                    if (checkPath(ss.str().c_str()) == StatResult::IS_FILE) {
-                        AiMetaDataLoadFile(ss.str().c_str());
-                    }
-                }
-            }
-        } else if (result == StatResult::IS_FILE) {
-            AiMetaDataLoadFile(plugin.c_str());
-        }
+    std::vector<std::string> metadataFiles;
+    for (const auto& metadata : getFlagValues("--meta")) {
+        const auto files = UsdAiLoadArnoldMetadata(metadata);
+        metadataFiles.insert(metadataFiles.end(), files.begin(), files.end());
     }
 
+    auto customData = layer->GetCustomLayerData();
+    VtDictionary previousStamps;
+    if (incremental) {
+        const auto it = customData.find(stampsKey);
+        if (it != customData.end() && it->second.IsHolding<VtDictionary>()) {
+            previousStamps = it->second.UncheckedGet<VtDictionary>();
+        }
+    }
+    const auto compactMetadata = !findFlag("--metadata-attributes");
+    const auto environmentStamp =
+        getEnvironmentStamp(metadataFiles, compactMetadata);
+    const auto upToDateEnvironment =
+        VtDictionaryGet<std::string>(
+            previousStamps, environmentKey, VtDefault = std::string()) ==
+        environmentStamp;
+    const auto previousPlugins = VtDictionaryGet<VtDictionary>(
+        previousStamps, pluginsKey, VtDefault = VtDictionary());
+
+    // Plugins have to be loaded either way to list their node entries, but
+    // only the entries of plugins with a different modification time are
+    // described again.
+    std::vector<const AtNodeEntry*> nentries;
+    std::unordered_set<std::string> nodeNames;
+    VtDictionary pluginStamps;
     auto* nentryIter = AiUniverseGetNodeEntryIterator(AI_NODE_SHADER);
 
     while (!AiNodeEntryIteratorFinished(nentryIter)) {
         const auto* nentry = AiNodeEntryIteratorGetNext(nentryIter);
-        const auto filename = AiNodeEntryGetFilename(nentry);
         const std::string nodeName = AiNodeEntryGetName(nentry);
-        auto prim = stage->DefinePrim(SdfPath("/" + nodeName));
-        prim.SetMetadata(
-            UsdAiTokens->filename,
-            VtValue(TfToken(filename == nullptr ? "<built-in>" : filename)));
-        UsdAiShader shaderAPI(prim);
-        shaderAPI.CreateIdAttr().Set(TfToken(nodeName));
-
-        const auto nodeType = AiNodeEntryGetType(nentry);
-
-        UsdAiNodeAPI nodeAPI(prim);
-        nodeAPI.CreateNodeEntryTypeAttr().Set(
-            UsdAiNodeAPI::GetNodeEntryTokenFromType(nodeType));
-
-        auto paramIter = AiNodeEntryGetParamIterator(nentry);
-
-        while (!AiParamIteratorFinished(paramIter)) {
-            const auto* pentry = AiParamIteratorGetNext(paramIter);
-            const auto paramType = AiParamGetType(pentry);
-
-            UsdAttribute attr;
-            if (paramType == AI_TYPE_ARRAY) {
-                const auto* defaultValue = AiParamGetDefault(pentry);
-                if (defaultValue == nullptr) { continue; }
-                const auto* array = defaultValue->ARRAY();
-                if (array == nullptr) { continue; }
-                const auto elemType = AiArrayGetType(array);
-                const auto* conversion =
-                    AiShaderExport::get_array_conversion(elemType);
-                if (conversion == nullptr) { continue; }
-                attr = prim.CreateAttribute(
-                    TfToken(AiParamGetName(pentry).c_str()), conversion->type,
-                    false);
-
-                if (conversion->f != nullptr) {
-                    attr.Set(conversion->f(array));
-                }
-                attr.SetMetadata(
-                    UsdAiTokens->elemType,
-                    UsdAiNodeAPI::GetParamTypeTokenFromType(elemType));
-            } else {
-                const auto* conversion =
-                    AiShaderExport::get_default_value_conversion(paramType);
-                if (conversion == nullptr) { continue; }
-                attr = prim.CreateAttribute(
-                    TfToken(AiParamGetName(pentry).c_str()), conversion->type,
-                    false);
-
-                if (conversion->f != nullptr) {
-                    attr.Set(conversion->f(*AiParamGetDefault(pentry), pentry));
-                }
-            }
+        nodeNames.insert(nodeName);
+        const auto* filename = AiNodeEntryGetFilename(nentry);
+        auto upToDate = upToDateEnvironment &&
+                        layer->GetPrimAtPath(SdfPath("/" + nodeName));
+        if (filename != nullptr) {
+            const auto mtime = getModificationTime(filename);
+            pluginStamps[filename] = VtValue(mtime);
+            upToDate = upToDate && VtDictionaryIsHolding<double>(
+                                       previousPlugins, filename) &&
+                       VtDictionaryGet<double>(previousPlugins, filename) ==
+                           mtime;
+        }
+        if (!upToDate) { nentries.push_back(nentry); }
+    }
 
-            attr.SetMetadata(
-                UsdAiTokens->paramType,
-                UsdAiNodeAPI::GetParamTypeTokenFromType(paramType));
+    AiNodeEntryIteratorDestroy(nentryIter);
 
-            auto* metaIter =
-                AiNodeEntryGetMetaDataIterator(nentry, AiParamGetName(pentry));
+    auto stage = UsdStage::Open(layer);
+    UsdAiDescribeArnoldNodeEntries(stage, nentries, compactMetadata);
 
-            while (!AiMetaDataIteratorFinished(metaIter)) {
-                nodeAPI.AddMetadataToAttribute(
-                    attr, AiMetaDataIteratorGetNext(metaIter));
+    if (incremental) {
+        // Removing the descriptions of node entries that are gone.
+        SdfChangeBlock changeBlock;
+        for (const auto& primSpec : layer->GetRootPrims()) {
+            if (nodeNames.find(primSpec->GetName()) == nodeNames.end()) {
+                layer->RemoveRootPrim(primSpec);
             }
-
-            AiMetaDataIteratorDestroy(metaIter);
         }
-
-        AiParamIteratorDestroy(paramIter);
     }
 
-    AiNodeEntryIteratorDestroy(nentryIter);
+    if (!cout) {
+        VtDictionary stamps;
+        stamps[environmentKey] = VtValue(environmentStamp);
+        stamps[pluginsKey] = VtValue(pluginStamps);
+        customData[stampsKey] = VtValue(stamps);
+        layer->SetCustomLayerData(customData);
+    }
 
     AiEnd();
 
     if (cout) {
         std::string out;
-        stage->GetRootLayer()->ExportToString(&out);
+        layer->ExportToString(&out);
         std::cout << out;
     } else {
-        stage->GetRootLayer()->Save();
+        layer->Save();
     }
 
     stage = UsdStageRefPtr();